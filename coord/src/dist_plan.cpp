@@ -269,6 +269,38 @@ static int distributeQuantile(ReducerDistCtx *rdctx, QueryError *status) {
   return REDISMODULE_OK;
 }
 
+/* Distribute QUANTILE_TDIGEST into remote TDIGEST and local TDIGEST_QUANTILE, which merges the
+ * digests of the shards */
+static int distributeQuantileTDigest(ReducerDistCtx *rdctx, QueryError *status) {
+  PLN_Reducer *src = rdctx->srcReducer;
+  if (src->args.argc != 2 && src->args.argc != 3) {
+    QueryError_SetErrorFmt(status, QUERY_EPARSEARGS, "Invalid arguments for reducer %s",
+                           src->name);
+    return REDISMODULE_ERR;
+  }
+  const char *alias = NULL;
+
+  if (src->args.argc == 2) {
+    if (!rdctx->addRemote("TDIGEST", &alias, status, "1", rdctx->srcarg(0))) {
+      return REDISMODULE_ERR;
+    }
+    if (!rdctx->addLocal("TDIGEST_QUANTILE", status, "2", alias, rdctx->srcarg(1), "AS",
+                         src->alias)) {
+      return REDISMODULE_ERR;
+    }
+  } else {
+    // the shards and the coordinator use the same compression
+    if (!rdctx->addRemote("TDIGEST", &alias, status, "2", rdctx->srcarg(0), rdctx->srcarg(2))) {
+      return REDISMODULE_ERR;
+    }
+    if (!rdctx->addLocal("TDIGEST_QUANTILE", status, "3", alias, rdctx->srcarg(1),
+                         rdctx->srcarg(2), "AS", src->alias)) {
+      return REDISMODULE_ERR;
+    }
+  }
+  return REDISMODULE_OK;
+}
+
 /* Distribute STDDEV into remote RANDOM_SAMPLE and local STDDEV */
 static int distributeStdDev(ReducerDistCtx *rdctx, QueryError *status) {
   PLN_Reducer *src = rdctx->srcReducer;
@@ -287,9 +319,18 @@ static int distributeStdDev(ReducerDistCtx *rdctx, QueryError *status) {
 /* Distribute COUNT_DISTINCTISH into HLL and MERGE_HLL */
 static int distributeCountDistinctish(ReducerDistCtx *rdctx, QueryError *status) {
   PLN_Reducer *src = rdctx->srcReducer;
-  CHECK_ARG_COUNT(1);
+  if (src->args.argc != 1 && src->args.argc != 2) {
+    QueryError_SetErrorFmt(status, QUERY_EPARSEARGS, "Invalid arguments for reducer %s",
+                           src->name);
+    return REDISMODULE_ERR;
+  }
   const char *alias;
-  if (!rdctx->addRemote("HLL", &alias, status, "1", rdctx->srcarg(0))) {
+  // The shards build their HLLs with the requested precision, HLL_SUM takes it from the registers
+  if (src->args.argc == 1) {
+    if (!rdctx->addRemote("HLL", &alias, status, "1", rdctx->srcarg(0))) {
+      return REDISMODULE_ERR;
+    }
+  } else if (!rdctx->addRemote("HLL", &alias, status, "2", rdctx->srcarg(0), rdctx->srcarg(1))) {
     return REDISMODULE_ERR;
   }
   if (!rdctx->addLocal("HLL_SUM", status, "1", alias, "AS", src->alias)) {
@@ -354,6 +395,7 @@ static struct {
     {"STDDEV", distributeStdDev},
     {"COUNT_DISTINCTISH", distributeCountDistinctish},
     {"QUANTILE", distributeQuantile},
+    {"QUANTILE_TDIGEST", distributeQuantileTDigest},
 
     {NULL, NULL}  // sentinel value
 
@@ -370,6 +370,49 @@ int TrieMap_FindPrefixes(TrieMap *t, const char *str, tm_len_t len, arrayof(void
   return TrieMapNode_FindPrefixes(t->root, str, len, results);
 }
 
+void *TrieMap_FindLongestPrefix(TrieMap *t, const char *str, tm_len_t len) {
+  TrieMapNode *node = t->root;
+  void *res = TRIEMAP_NOTFOUND;
+
+  tm_len_t offset = 0;
+  while (node && (offset < len || len == 0)) {
+    tm_len_t node_offset = 0;
+    tm_len_t nlen = node->len;
+    while (offset < len && node_offset < nlen && str[offset] == node->str[node_offset]) {
+      offset++;
+      node_offset++;
+    }
+
+    // no match
+    if (node_offset != nlen) {
+      return res;
+    }
+
+    // at the end of both strings
+    if (offset == len) {
+      if (__trieMapNode_isTerminal(node) && !__trieMapNode_isDeleted(node)) {
+        res = node->value;
+      }
+      return res;
+    }
+
+    if (node->value) {
+      res = node->value;
+    }
+
+    // reached end of node's string but not of the search string
+    TrieMapNode *nextChild = NULL;
+    char *childKeys = __trieMapNode_childKey(node, 0);
+    char *ptr = memchr(childKeys, str[offset], node->numChildren);
+    if (ptr != NULL) {
+      nextChild = __trieMapNode_children(node)[ptr - childKeys];
+    }
+    node = nextChild;
+  }
+
+  return res;
+}
+
 /* If a node has a single child after delete, we can merged them. This
  * deletes
  * the node and returns a newly allocated node */
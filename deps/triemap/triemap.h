@@ -86,6 +86,10 @@ void *TrieMap_Find(TrieMap *t, const char *str, tm_len_t len);
  */
 int TrieMap_FindPrefixes(TrieMap *t, const char *str, tm_len_t len, arrayof(void*) *results);
 
+/* Find the value of the longest key which is a prefix of the given string.
+ * Returns TRIEMAP_NOTFOUND if no key is a prefix of it. */
+void *TrieMap_FindLongestPrefix(TrieMap *t, const char *str, tm_len_t len);
+
 /* Mark a node as deleted. It also optimizes the trie by merging nodes if
  * needed. If freeCB is given, it will be used to free the value of the deleted
  * node. If it doesn't, we simply call free() */
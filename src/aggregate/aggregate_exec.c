@@ -592,6 +592,7 @@ error:
 cleanup:
   // No need to unlock spec as it was unlocked by `AREQ_Execute` or will be unlocked by `blockedClientReqCtx_destroy`
   RedisModule_FreeThreadSafeContext(outctx);
+  IndexSpec_RemoveActiveQuery(StrongRef_Get(execution_ref));
   StrongRef_Release(execution_ref);
   blockedClientReqCtx_destroy(BCRctx);
 }
@@ -644,28 +645,32 @@ int prepareExecutionPlan(AREQ *req, QueryError *status) {
   return rc;
 }
 
-static int buildRequest(RedisModuleCtx *ctx, RedisModuleString **argv, int argc, int type,
-                        QueryError *status, AREQ **r) {
-  int rc = REDISMODULE_ERR;
-  const char *indexname = RedisModule_StringPtrLen(argv[1], NULL);
-  RedisSearchCtx *sctx = NULL;
-  RedisModuleCtx *thctx = NULL;
-
+static int compileRequest(RedisModuleCtx *ctx, RedisModuleString **argv, int argc, int type,
+                          QueryError *status, AREQ *r) {
   if (type == COMMAND_SEARCH) {
-    (*r)->reqflags |= QEXEC_F_IS_SEARCH;
+    r->reqflags |= QEXEC_F_IS_SEARCH;
   }
   else if (type == COMMAND_AGGREGATE) {
-    (*r)->reqflags |= QEXEC_F_IS_EXTENDED;
+    r->reqflags |= QEXEC_F_IS_EXTENDED;
   }
 
-  (*r)->reqflags |= QEXEC_FORMAT_DEFAULT;
+  r->reqflags |= QEXEC_FORMAT_DEFAULT;
 
-  if (AREQ_Compile(*r, argv + 2, argc - 2, status) != REDISMODULE_OK) {
+  if (AREQ_Compile(r, argv + 2, argc - 2, status) != REDISMODULE_OK) {
     RS_LOG_ASSERT(QueryError_HasError(status), "Query has error");
-    goto done;
+    return REDISMODULE_ERR;
   }
 
-  (*r)->protocol = is_resp3(ctx) ? 3 : 2;
+  r->protocol = is_resp3(ctx) ? 3 : 2;
+  return REDISMODULE_OK;
+}
+
+// Apply the index named `indexname` to a compiled request. The request is freed on failure
+static int applyRequestContext(RedisModuleCtx *ctx, const char *indexname, QueryError *status,
+                               AREQ **r) {
+  int rc = REDISMODULE_ERR;
+  RedisSearchCtx *sctx = NULL;
+  RedisModuleCtx *thctx = NULL;
 
   // Prepare the query.. this is where the context is applied.
   if ((*r)->reqflags & QEXEC_F_IS_CURSOR) {
@@ -699,6 +704,18 @@ done:
   return rc;
 }
 
+static int buildRequest(RedisModuleCtx *ctx, RedisModuleString **argv, int argc, int type,
+                        QueryError *status, AREQ **r) {
+  const char *indexname = RedisModule_StringPtrLen(argv[1], NULL);
+
+  if (compileRequest(ctx, argv, argc, type, status, *r) != REDISMODULE_OK) {
+    AREQ_Free(*r);
+    *r = NULL;
+    return REDISMODULE_ERR;
+  }
+  return applyRequestContext(ctx, indexname, status, r);
+}
+
 #define NO_PROFILE 0
 #define PROFILE_FULL 1
 #define PROFILE_LIMITED 2
@@ -759,6 +776,8 @@ static int execCommandCommon(RedisModuleCtx *ctx, RedisModuleString **argv, int
     blockedClientReqCtx *BCRctx = blockedClientReqCtx_New(r, blockedClient, spec_ref);
     // Mark the request as thread safe, so that the pipeline will be built in a thread safe manner
     r->reqflags |= QEXEC_F_RUN_IN_BACKGROUND;
+    // Keep the index from being evicted until the worker is done with it
+    IndexSpec_AddActiveQuery(r->sctx->spec);
 
     workersThreadPool_AddWork((redisearch_thpool_proc)AREQ_Execute_Callback, BCRctx);
   } else
@@ -854,6 +873,186 @@ int RSProfileCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
   return REDISMODULE_OK;
 }
 
+/*
+ * FT.MSEARCH {index} {query} VECTORS {param} {count} {blob} ... [FT.SEARCH options]
+ *
+ * Run the same search once for each of the blobs, with the blob bound to the query parameter
+ * `param`. The requests are all parsed before any of them is executed, so that an invalid query
+ * fails as a whole, and they are then executed one after the other in a single command (or a single
+ * job of the worker threads). The reply is an array holding the FT.SEARCH reply of each blob.
+ */
+typedef struct {
+  AREQ **reqs;
+  RedisModuleBlockedClient *blockedClient;
+  WeakRef spec_ref;
+} blockedClientBatchCtx;
+
+static void freeBatchRequests(AREQ **reqs) {
+  for (size_t i = 0; i < array_len(reqs); i++) {
+    if (reqs[i]) {
+      AREQ_Free(reqs[i]);
+    }
+  }
+  array_free(reqs);
+}
+
+// Execute a request of the batch and reply with its results, or with its error. Frees the request
+static void executeBatchRequest(AREQ *req, RedisModuleCtx *ctx) {
+  QueryError status = {0};
+  RedisSearchCtx_LockSpecRead(req->sctx);
+  if (prepareExecutionPlan(req, &status) != REDISMODULE_OK) {
+    AREQ_Free(req);
+    QueryError_ReplyAndClear(ctx, &status);
+    return;
+  }
+  AREQ_Execute(req, ctx);
+}
+
+static void executeBatch(AREQ **reqs, RedisModuleCtx *ctx) {
+  RedisModule_ReplyWithArray(ctx, array_len(reqs));
+  for (size_t i = 0; i < array_len(reqs); i++) {
+    AREQ *req = reqs[i];
+    reqs[i] = NULL;
+    executeBatchRequest(req, ctx);
+  }
+}
+
+#ifdef MT_BUILD
+static void AREQ_ExecuteBatch_Callback(blockedClientBatchCtx *BCBctx) {
+  RedisModuleCtx *outctx = RedisModule_GetThreadSafeContext(BCBctx->blockedClient);
+
+  StrongRef execution_ref = WeakRef_Promote(BCBctx->spec_ref);
+  if (!StrongRef_Get(execution_ref)) {
+    // The index was dropped while the queries were in the job queue.
+    QueryError status = {0};
+    QueryError_SetError(&status, QUERY_ENOINDEX, "The index was dropped before the query could be executed");
+    QueryError_ReplyAndClear(outctx, &status);
+  } else {
+    for (size_t i = 0; i < array_len(BCBctx->reqs); i++) {
+      BCBctx->reqs[i]->sctx->redisCtx = outctx;
+    }
+    executeBatch(BCBctx->reqs, outctx);
+    IndexSpec_RemoveActiveQuery(StrongRef_Get(execution_ref));
+  }
+
+  RedisModule_FreeThreadSafeContext(outctx);
+  StrongRef_Release(execution_ref);
+  freeBatchRequests(BCBctx->reqs);
+  RedisModule_BlockedClientMeasureTimeEnd(BCBctx->blockedClient);
+  RedisModule_UnblockClient(BCBctx->blockedClient, NULL);
+  WeakRef_Release(BCBctx->spec_ref);
+  rm_free(BCBctx);
+}
+#endif // MT_BUILD
+
+// Build the request of a single blob, with the blob bound to `param`
+static AREQ *buildBatchRequest(RedisModuleCtx *ctx, RedisModuleString **argv, int argc,
+                               const char *param, RedisModuleString *blob, QueryError *status) {
+  AREQ *r = AREQ_New();
+  if (compileRequest(ctx, argv, argc, COMMAND_SEARCH, status, r) != REDISMODULE_OK) {
+    AREQ_Free(r);
+    return NULL;
+  }
+  if (r->reqflags & QEXEC_F_IS_CURSOR) {
+    QueryError_SetError(status, QUERY_EGENERIC, "FT.MSEARCH does not support cursor");
+    AREQ_Free(r);
+    return NULL;
+  }
+
+  if (!r->searchopts.params) {
+    r->searchopts.params = Param_DictCreate();
+  }
+  size_t len;
+  const char *value = RedisModule_StringPtrLen(blob, &len);
+  if (Param_DictAdd(r->searchopts.params, param, value, len, status) != DICT_OK) {
+    AREQ_Free(r);
+    return NULL;
+  }
+
+  const char *indexname = RedisModule_StringPtrLen(argv[1], NULL);
+  if (applyRequestContext(ctx, indexname, status, &r) != REDISMODULE_OK) {
+    return NULL;
+  }
+  return r;
+}
+
+int RSMSearchCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+  if (argc < 7) {
+    return RedisModule_WrongArity(ctx);
+  }
+
+  QueryError status = {0};
+  AREQ **reqs = NULL;
+  RedisModuleString **reqArgv = NULL;
+  int reqArgc, rv;
+  ArgsCursor ac = {0}, blobs = {0};
+  ArgsCursor_InitRString(&ac, argv + 3, argc - 3);
+  if (!AC_AdvanceIfMatch(&ac, "VECTORS")) {
+    QERR_MKBADARGS_FMT(&status, "VECTORS is expected after the query");
+    goto error;
+  }
+  const char *param = AC_GetStringNC(&ac, NULL);
+  if ((rv = AC_GetVarArgs(&ac, &blobs)) != AC_OK) {
+    QERR_MKBADARGS_AC(&status, "VECTORS", rv);
+    goto error;
+  } else if (blobs.argc == 0) {
+    QERR_MKBADARGS_FMT(&status, "VECTORS requires at least one vector");
+    goto error;
+  }
+
+  // The arguments of each request: the command, index and query, followed by the search options
+  reqArgc = 3 + AC_NumRemaining(&ac);
+  reqArgv = rm_malloc(sizeof(*reqArgv) * reqArgc);
+  memcpy(reqArgv, argv, 3 * sizeof(*reqArgv));
+  memcpy(reqArgv + 3, argv + 3 + ac.offset, AC_NumRemaining(&ac) * sizeof(*reqArgv));
+
+  reqs = array_new(AREQ *, blobs.argc);
+  while (!AC_IsAtEnd(&blobs)) {
+    RedisModuleString *blob = NULL;
+    AC_GetRString(&blobs, &blob, 0);
+    AREQ *r = buildBatchRequest(ctx, reqArgv, reqArgc, param, blob, &status);
+    if (!r) {
+      break;
+    }
+    reqs = array_append(reqs, r);
+  }
+  rm_free(reqArgv);
+  if (QueryError_HasError(&status)) {
+    goto error;
+  }
+
+  SET_DIALECT(reqs[0]->sctx->spec->used_dialects, reqs[0]->reqConfig.dialectVersion);
+  SET_DIALECT(RSGlobalConfig.used_dialects, reqs[0]->reqConfig.dialectVersion);
+
+#ifdef MT_BUILD
+  if (RunInThread()) {
+    StrongRef spec_ref = IndexSpec_GetStrongRefUnsafe(reqs[0]->sctx->spec);
+    RedisModuleBlockedClient *blockedClient = RedisModule_BlockClient(ctx, NULL, NULL, NULL, 0);
+    RedisModule_BlockedClientMeasureTimeStart(blockedClient);
+    blockedClientBatchCtx *BCBctx = rm_new(blockedClientBatchCtx);
+    BCBctx->reqs = reqs;
+    BCBctx->blockedClient = blockedClient;
+    BCBctx->spec_ref = StrongRef_Demote(spec_ref);
+    for (size_t i = 0; i < array_len(reqs); i++) {
+      reqs[i]->reqflags |= QEXEC_F_RUN_IN_BACKGROUND;
+    }
+    IndexSpec_AddActiveQuery(reqs[0]->sctx->spec);
+    workersThreadPool_AddWork((redisearch_thpool_proc)AREQ_ExecuteBatch_Callback, BCBctx);
+    return REDISMODULE_OK;
+  }
+#endif // MT_BUILD
+
+  executeBatch(reqs, ctx);
+  freeBatchRequests(reqs);
+  return REDISMODULE_OK;
+
+error:
+  if (reqs) {
+    freeBatchRequests(reqs);
+  }
+  return QueryError_ReplyAndClear(ctx, &status);
+}
+
 char *RS_GetExplainOutput(RedisModuleCtx *ctx, RedisModuleString **argv, int argc,
                           QueryError *status) {
   AREQ *r = AREQ_New();
@@ -18,6 +18,7 @@
 #include "config.h"
 #include "util/timeout.h"
 #include "query_optimizer.h"
+#include "query_cache.h"
 #include "resp3.h"
 
 extern RSConfig RSGlobalConfig;
@@ -988,7 +989,7 @@ int AREQ_ApplyContext(AREQ *req, RedisSearchCtx *sctx, QueryError *status) {
   SetSearchCtx(sctx, req);
   QueryAST *ast = &req->ast;
 
-  int rv = QAST_Parse(ast, sctx, opts, req->query, strlen(req->query), req->reqConfig.dialectVersion, status);
+  int rv = QAST_ParseCached(ast, sctx, opts, req->query, strlen(req->query), req->reqConfig.dialectVersion, status);
   if (rv != REDISMODULE_OK) {
     return REDISMODULE_ERR;
   }
@@ -1215,12 +1216,13 @@ static ResultProcessor *getArrangeRP(AREQ *req, AGGPlan *pln, const PLN_BaseStep
         ResultProcessor *rpLoader = RPLoader_New(req, lk, loadKeys, array_len(loadKeys));
         up = pushRP(req, rpLoader, up);
       }
-      rp = RPSorter_NewByFields(limit, sortkeys, nkeys, astp->sortAscMap);
+      rp = RPSorter_NewByFields(limit, sortkeys, nkeys, astp->sortAscMap,
+                                RSGlobalConfig.sortSpillThreshold);
       up = pushRP(req, rp, up);
     } else if (IsSearch(req) && (!IsOptimized(req) || HasScorer(req))) {
       // No sort? then it must be sort by score, which is the default.
       // In optimize mode, add sorter for queries with a scorer.
-      rp = RPSorter_NewByScore(limit);
+      rp = RPSorter_NewByScore(limit, RSGlobalConfig.sortSpillThreshold);
       up = pushRP(req, rp, up);
     }
   }
@@ -1367,6 +1369,85 @@ error:
   return REDISMODULE_ERR;
 }
 
+/**
+ * Returns the SORTBY/LIMIT step that follows the LOAD step `stp`, if the rows reach it before any
+ * other LOAD or GROUPBY. Loading fields which are not needed to sort or filter can then be deferred
+ * until after it, so that only the rows which survive the sort and the limit are loaded.
+ */
+static PLN_ArrangeStep *getLateLoadArrange(AGGPlan *pln, const PLN_BaseStep *stp) {
+  for (const DLLIST_node *nn = stp->llnodePln.next; nn != &pln->steps; nn = nn->next) {
+    PLN_BaseStep *cur = DLLIST_ITEM(nn, PLN_BaseStep, llnodePln);
+    if (cur->type == PLN_T_ARRANGE) {
+      return (PLN_ArrangeStep *)cur;
+    } else if (cur->type == PLN_T_GROUP || cur->type == PLN_T_LOAD) {
+      return NULL;
+    }
+  }
+  return NULL;
+}
+
+// Parse the expressions of the APPLY and FILTER steps between `stp` and `end`, ahead of building them
+static int parseMapFiltersBetween(PLN_BaseStep *stp, PLN_BaseStep *end, QueryError *status) {
+  for (DLLIST_node *nn = stp->llnodePln.next; nn != &end->llnodePln; nn = nn->next) {
+    PLN_BaseStep *cur = DLLIST_ITEM(nn, PLN_BaseStep, llnodePln);
+    if (cur->type != PLN_T_APPLY && cur->type != PLN_T_FILTER) {
+      continue;
+    }
+    PLN_MapFilterStep *mstp = (PLN_MapFilterStep *)cur;
+    if (!mstp->parsedExpr) {
+      mstp->parsedExpr = ExprAST_Parse(mstp->rawExpr, strlen(mstp->rawExpr), status);
+      if (!mstp->parsedExpr) {
+        return REDISMODULE_ERR;
+      }
+    }
+  }
+  return REDISMODULE_OK;
+}
+
+// Whether the field `name` must be loaded before the arrange step `astp`, which follows `stp`
+static bool isNeededBeforeArrange(const PLN_BaseStep *stp, const PLN_ArrangeStep *astp,
+                                  const char *name) {
+  for (size_t ii = 0; ii < array_len(astp->sortKeys); ++ii) {
+    if (!strcmp(astp->sortKeys[ii], name)) {
+      return true;
+    }
+  }
+  for (const DLLIST_node *nn = stp->llnodePln.next; nn != &astp->base.llnodePln; nn = nn->next) {
+    const PLN_BaseStep *cur = DLLIST_ITEM(nn, PLN_BaseStep, llnodePln);
+    if (cur->type != PLN_T_APPLY && cur->type != PLN_T_FILTER) {
+      continue;
+    }
+    // An APPLY into the same name must not be overridden by the loader
+    if ((cur->type == PLN_T_APPLY && !strcmp(cur->alias, name)) ||
+        ExprAST_HasProperty(((const PLN_MapFilterStep *)cur)->parsedExpr, name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// LOAD * can be deferred if nothing reads the row before the arrange step, and the sort keys can
+// be found without it
+static bool canDeferLoadAll(const AREQ *req, const PLN_BaseStep *stp, const PLN_ArrangeStep *astp) {
+  const IndexSpec *spec = req->sctx ? req->sctx->spec : NULL;
+  if (!spec) {
+    return false;
+  }
+  for (const DLLIST_node *nn = stp->llnodePln.next; nn != &astp->base.llnodePln; nn = nn->next) {
+    const PLN_BaseStep *cur = DLLIST_ITEM(nn, PLN_BaseStep, llnodePln);
+    if (cur->type == PLN_T_APPLY || cur->type == PLN_T_FILTER) {
+      return false;
+    }
+  }
+  for (size_t ii = 0; ii < array_len(astp->sortKeys); ++ii) {
+    const char *key = astp->sortKeys[ii];
+    if (!IndexSpec_GetField(spec, key, strlen(key))) {
+      return false;
+    }
+  }
+  return true;
+}
+
 int AREQ_BuildPipeline(AREQ *req, QueryError *status) {
   if (!(req->reqflags & QEXEC_F_BUILDPIPELINE_NO_ROOT)) {
     buildImplicitPipeline(req, status);
@@ -1386,6 +1467,10 @@ int AREQ_BuildPipeline(AREQ *req, QueryError *status) {
   // Whether we've applied a SORTBY yet..
   int hasArrange = 0;
 
+  // Fields of a LOAD which are loaded after the next SORTBY/LIMIT, rather than for every row
+  RLookup *lateLoadLookup = NULL;
+  const RLookupKey **lateLoadKeys = NULL;
+
   for (const DLLIST_node *nn = pln->steps.next; nn != &pln->steps; nn = nn->next) {
     const PLN_BaseStep *stp = DLLIST_ITEM(nn, PLN_BaseStep, llnodePln);
 
@@ -1407,15 +1492,29 @@ int AREQ_BuildPipeline(AREQ *req, QueryError *status) {
         hasArrange = 1;
         rpUpstream = rp;
 
+        if (lateLoadLookup) {
+          rp = RPLoader_New(req, lateLoadLookup, lateLoadKeys, array_len(lateLoadKeys));
+          if (isSpecJson(req->sctx->spec)) {
+            // On JSON, load all gets the serialized value of the doc, and doesn't make the fields available.
+            lateLoadLookup->options &= ~RLOOKUP_OPT_ALL_LOADED;
+          }
+          PUSH_RP();
+          array_free(lateLoadKeys);
+          lateLoadKeys = NULL;
+          lateLoadLookup = NULL;
+        }
         break;
       }
 
       case PLN_T_APPLY:
       case PLN_T_FILTER: {
         PLN_MapFilterStep *mstp = (PLN_MapFilterStep *)stp;
-        mstp->parsedExpr = ExprAST_Parse(mstp->rawExpr, strlen(mstp->rawExpr), status);
+        // The expression may have been parsed already, when deciding which fields to load late
         if (!mstp->parsedExpr) {
-          goto error;
+          mstp->parsedExpr = ExprAST_Parse(mstp->rawExpr, strlen(mstp->rawExpr), status);
+          if (!mstp->parsedExpr) {
+            goto error;
+          }
         }
 
         // Ensure the lookups can actually find what they need
@@ -1478,7 +1577,33 @@ int AREQ_BuildPipeline(AREQ *req, QueryError *status) {
             lstp->keys[lstp->nkeys++] = kk;
           }
         }
-        if (lstp->nkeys || lstp->base.flags & PLN_F_LOAD_ALL) {
+
+        // Keep only the fields which are read before the next SORTBY/LIMIT, and load the rest
+        // after it
+        bool loadAll = lstp->base.flags & PLN_F_LOAD_ALL;
+        PLN_ArrangeStep *astp = getLateLoadArrange(pln, stp);
+        if (astp) {
+          if (parseMapFiltersBetween((PLN_BaseStep *)stp, &astp->base, status) != REDISMODULE_OK) {
+            goto error;
+          }
+          size_t nkeys = 0;
+          for (size_t ii = 0; ii < lstp->nkeys; ++ii) {
+            if (isNeededBeforeArrange(stp, astp, lstp->keys[ii]->name)) {
+              lstp->keys[nkeys++] = lstp->keys[ii];
+            } else {
+              *array_ensure_tail(&lateLoadKeys, const RLookupKey *) = lstp->keys[ii];
+            }
+          }
+          lstp->nkeys = nkeys;
+          if (loadAll && canDeferLoadAll(req, stp, astp)) {
+            loadAll = false;
+            lateLoadLookup = curLookup;
+          } else if (lateLoadKeys) {
+            lateLoadLookup = curLookup;
+          }
+        }
+
+        if (lstp->nkeys || loadAll) {
           rp = RPLoader_New(req, curLookup, lstp->keys, lstp->nkeys);
           if (isSpecJson(req->sctx->spec)) {
             // On JSON, load all gets the serialized value of the doc, and doesn't make the fields available.
@@ -1529,6 +1654,7 @@ int AREQ_BuildPipeline(AREQ *req, QueryError *status) {
 
   return REDISMODULE_OK;
 error:
+  array_free(lateLoadKeys);
   return REDISMODULE_ERR;
 }
 
@@ -0,0 +1,239 @@
+/*
+ * Copyright Redis Ltd. 2016 - present
+ * Licensed under your choice of the Redis Source Available License 2.0 (RSALv2) or
+ * the Server Side Public License v1 (SSPLv1).
+ */
+
+#include "bytecode.h"
+#include "rlookup.h"
+#include "util/arr.h"
+
+#include <math.h>
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+static ExprOpcode opcodeOfOperator(unsigned char op) {
+  switch (op) {
+    case '+': return ExprOp_Add;
+    case '-': return ExprOp_Sub;
+    case '*': return ExprOp_Mul;
+    case '/': return ExprOp_Div;
+    case '%': return ExprOp_Mod;
+    case '^': return ExprOp_Pow;
+  }
+  return ExprOp_Const;
+}
+
+static ExprOpcode opcodeOfCondition(RSCondition cond) {
+  switch (cond) {
+    case RSCondition_Eq: return ExprOp_Eq;
+    case RSCondition_Ne: return ExprOp_Ne;
+    case RSCondition_Lt: return ExprOp_Lt;
+    case RSCondition_Le: return ExprOp_Le;
+    case RSCondition_Gt: return ExprOp_Gt;
+    case RSCondition_Ge: return ExprOp_Ge;
+    case RSCondition_And: return ExprOp_And;
+    case RSCondition_Or: return ExprOp_Or;
+  }
+  return ExprOp_Const;
+}
+
+static void emit(ExprProgram *p, ExprOpcode op, unsigned dst, unsigned a, unsigned b) {
+  ExprInstr instr = {.op = op, .dst = dst, .a = a, .b = b};
+  p->code = array_append(p->code, instr);
+}
+
+// Compile `e` so that its value is left in register `dst`. Registers above `dst` are free, so
+// registers are allocated as a stack and the program needs as many as the depth of the tree.
+static bool compileNode(ExprProgram *p, const RSExpr *e, unsigned dst) {
+  if (dst >= EXPR_PROGRAM_MAX_REGS) {
+    return false;
+  }
+  if (dst + 1 > p->nregs) {
+    p->nregs = dst + 1;
+  }
+
+  switch (e->t) {
+    case RSExpr_Literal: {
+      const RSValue *v = RSValue_Dereference(&e->literal);
+      if (v->t != RSValue_Number) {
+        return false;
+      }
+      emit(p, ExprOp_Const, dst, array_len(p->consts), 0);
+      p->consts = array_append(p->consts, v->numval);
+      return true;
+    }
+    case RSExpr_Property:
+      emit(p, ExprOp_Load, dst, array_len(p->props), 0);
+      p->props = array_append(p->props, &e->property);
+      return true;
+    case RSExpr_Op: {
+      ExprOpcode op = opcodeOfOperator(e->op.op);
+      if (op == ExprOp_Const || !compileNode(p, e->op.left, dst) ||
+          !compileNode(p, e->op.right, dst + 1)) {
+        return false;
+      }
+      emit(p, op, dst, dst, dst + 1);
+      return true;
+    }
+    case RSExpr_Predicate: {
+      ExprOpcode op = opcodeOfCondition(e->pred.cond);
+      if (op == ExprOp_Const || !compileNode(p, e->pred.left, dst) ||
+          !compileNode(p, e->pred.right, dst + 1)) {
+        return false;
+      }
+      emit(p, op, dst, dst, dst + 1);
+      return true;
+    }
+    case RSExpr_Inverted:
+      if (!compileNode(p, e->inverted.child, dst)) {
+        return false;
+      }
+      emit(p, ExprOp_Not, dst, dst, 0);
+      return true;
+    case RSExpr_Function:
+      // functions work on boxed values
+      return false;
+  }
+  return false;
+}
+
+ExprProgram *ExprProgram_Compile(const RSExpr *root) {
+  ExprProgram *p = rm_calloc(1, sizeof(*p));
+  p->code = array_new(ExprInstr, 8);
+  p->consts = array_new(double, 4);
+  p->props = array_new(const RSLookupExpr *, 4);
+  if (!compileNode(p, root, 0)) {
+    ExprProgram_Free(p);
+    return NULL;
+  }
+  return p;
+}
+
+void ExprProgram_Free(ExprProgram *p) {
+  array_free(p->code);
+  array_free(p->consts);
+  array_free(p->props);
+  rm_free(p);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+// Same as comparing two numeric RSValues
+static inline int cmpNumbers(double a, double b) {
+  return a > b ? 1 : (a < b ? -1 : 0);
+}
+
+// Same as the modulo of two numeric RSValues
+static inline double modNumbers(double a, double b) {
+  // workaround for https://gcc.gnu.org/bugzilla/show_bug.cgi?id=30484
+  if (b == -1) {
+    return 0;
+  } else if (b != 0) {
+    return (long long)a % (long long)b;
+  }
+  return NAN;
+}
+
+static void loadProperty(const RSLookupExpr *prop, const RLookupRow **rows, size_t n,
+                         double *dst, bool *fallback) {
+  for (size_t i = 0; i < n; ++i) {
+    const RSValue *v = prop->lookupObj ? RLookup_GetItem(prop->lookupObj, rows[i]) : NULL;
+    if (v) {
+      v = RSValue_Dereference(v);
+    }
+    if (v && v->t == RSValue_Number) {
+      dst[i] = v->numval;
+    } else {
+      dst[i] = 0;
+      fallback[i] = true;
+    }
+  }
+}
+
+#define BINARY_LOOP(expr)                  \
+  for (size_t i = 0; i < n; ++i) {         \
+    double x = a[i], y = b[i];             \
+    d[i] = (expr);                         \
+  }
+
+void ExprProgram_EvalBatch(const ExprProgram *p, const RLookupRow **rows, size_t n,
+                           double *scratch, bool *fallback) {
+  memset(fallback, 0, n * sizeof(*fallback));
+
+  for (size_t k = 0; k < array_len(p->code); ++k) {
+    const ExprInstr *instr = &p->code[k];
+    double *d = scratch + instr->dst * n;
+    const double *a = scratch + instr->a * n;
+    const double *b = scratch + instr->b * n;
+
+    switch (instr->op) {
+      case ExprOp_Const: {
+        double v = p->consts[instr->a];
+        for (size_t i = 0; i < n; ++i) {
+          d[i] = v;
+        }
+        break;
+      }
+      case ExprOp_Load:
+        loadProperty(p->props[instr->a], rows, n, d, fallback);
+        break;
+      case ExprOp_Add:
+        BINARY_LOOP(x + y);
+        break;
+      case ExprOp_Sub:
+        BINARY_LOOP(x - y);
+        break;
+      case ExprOp_Mul:
+        BINARY_LOOP(x * y);
+        break;
+      case ExprOp_Div:
+        BINARY_LOOP(y != 0 ? x / y : NAN);
+        break;
+      case ExprOp_Mod:
+        BINARY_LOOP(modNumbers(x, y));
+        break;
+      case ExprOp_Pow:
+        BINARY_LOOP(pow(x, y));
+        break;
+      case ExprOp_Eq:
+        BINARY_LOOP(cmpNumbers(x, y) == 0);
+        break;
+      case ExprOp_Ne:
+        BINARY_LOOP(cmpNumbers(x, y) != 0);
+        break;
+      case ExprOp_Lt:
+        BINARY_LOOP(cmpNumbers(x, y) < 0);
+        break;
+      case ExprOp_Le:
+        BINARY_LOOP(cmpNumbers(x, y) <= 0);
+        break;
+      case ExprOp_Gt:
+        BINARY_LOOP(cmpNumbers(x, y) > 0);
+        break;
+      case ExprOp_Ge:
+        BINARY_LOOP(cmpNumbers(x, y) >= 0);
+        break;
+      // numeric operators can not fail, so evaluating both sides is the same as short circuiting
+      case ExprOp_And:
+        BINARY_LOOP(x != 0 && y != 0);
+        break;
+      case ExprOp_Or:
+        BINARY_LOOP(x != 0 || y != 0);
+        break;
+      case ExprOp_Not:
+        for (size_t i = 0; i < n; ++i) {
+          d[i] = a[i] == 0;
+        }
+        break;
+    }
+  }
+}
+
+bool ExprProgram_EvalRow(const ExprProgram *p, const RLookupRow *row, double *result) {
+  double scratch[ExprProgram_ScratchSize(p, 1)];
+  bool fallback;
+  ExprProgram_EvalBatch(p, &row, 1, scratch, &fallback);
+  *result = scratch[0];
+  return !fallback;
+}
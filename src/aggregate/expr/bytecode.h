@@ -0,0 +1,95 @@
+/*
+ * Copyright Redis Ltd. 2016 - present
+ * Licensed under your choice of the Redis Source Available License 2.0 (RSALv2) or
+ * the Server Side Public License v1 (SSPLv1).
+ */
+
+#ifndef RS_AGG_EXPR_BYTECODE_H_
+#define RS_AGG_EXPR_BYTECODE_H_
+
+#include "expression.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximal number of registers of a program, deeper expressions are not compiled */
+#define EXPR_PROGRAM_MAX_REGS 64
+
+typedef enum {
+  /* r[dst] = consts[a] */
+  ExprOp_Const,
+  /* r[dst] = numeric value of the property props[a] */
+  ExprOp_Load,
+  /* r[dst] = r[a] <op> r[b] */
+  ExprOp_Add,
+  ExprOp_Sub,
+  ExprOp_Mul,
+  ExprOp_Div,
+  ExprOp_Mod,
+  ExprOp_Pow,
+  ExprOp_Eq,
+  ExprOp_Ne,
+  ExprOp_Lt,
+  ExprOp_Le,
+  ExprOp_Gt,
+  ExprOp_Ge,
+  ExprOp_And,
+  ExprOp_Or,
+  /* r[dst] = !r[a] */
+  ExprOp_Not,
+} ExprOpcode;
+
+typedef struct {
+  uint8_t op;
+  uint8_t dst;
+  uint16_t a;
+  uint16_t b;
+} ExprInstr;
+
+/**
+ * A numeric expression compiled into register based bytecode. The registers hold unboxed doubles,
+ * and each instruction is executed over a batch of rows at once, so a register is a column of the
+ * batch.
+ *
+ * Only expressions made of numeric literals, properties, arithmetic operators and predicates are
+ * compiled. Rows with a property which is missing or is not a number are not evaluated by the
+ * program and are marked as such, these are evaluated by the expression tree instead.
+ */
+typedef struct ExprProgram {
+  ExprInstr *code;
+  double *consts;
+  // the property lookups of the expression tree, their keys are resolved when the tree is
+  const RSLookupExpr **props;
+  uint8_t nregs;
+} ExprProgram;
+
+/**
+ * Compile an expression tree. Returns NULL if the expression is not numeric. The program refers
+ * to the tree, which must outlive it.
+ */
+ExprProgram *ExprProgram_Compile(const RSExpr *root);
+
+void ExprProgram_Free(ExprProgram *p);
+
+/* The number of doubles required by ExprProgram_EvalBatch to evaluate `n` rows */
+static inline size_t ExprProgram_ScratchSize(const ExprProgram *p, size_t n) {
+  return p->nregs * n;
+}
+
+/**
+ * Evaluate the program over `n` rows. `scratch` holds the registers, and once the program is done
+ * its first `n` values are the results of the rows.
+ * `fallback[i]` is set if row `i` could not be evaluated by the program, and must be evaluated by
+ * the expression tree.
+ */
+void ExprProgram_EvalBatch(const ExprProgram *p, const RLookupRow **rows, size_t n,
+                           double *scratch, bool *fallback);
+
+/* Evaluate the program on a single row. Returns false if the row must be evaluated by the tree */
+bool ExprProgram_EvalRow(const ExprProgram *p, const RLookupRow *row, double *result);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -5,6 +5,7 @@
  */
 
 #include "expression.h"
+#include "bytecode.h"
 #include "result_processor.h"
 #include "rlookup.h"
 #include "profile.h"
@@ -294,6 +295,33 @@ int ExprAST_GetLookupKeys(RSExpr *expr, RLookup *lookup, QueryError *err) {
   return EXPR_EVAL_OK;
 }
 
+bool ExprAST_HasProperty(const RSExpr *expr, const char *name) {
+  if (!expr) {
+    return false;
+  }
+  switch (expr->t) {
+    case RSExpr_Property:
+      return !strcmp(expr->property.key, name);
+    case RSExpr_Function:
+      for (size_t ii = 0; ii < expr->func.args->len; ii++) {
+        if (ExprAST_HasProperty(expr->func.args->args[ii], name)) {
+          return true;
+        }
+      }
+      return false;
+    case RSExpr_Op:
+      return ExprAST_HasProperty(expr->op.left, name) || ExprAST_HasProperty(expr->op.right, name);
+    case RSExpr_Predicate:
+      return ExprAST_HasProperty(expr->pred.left, name) ||
+             ExprAST_HasProperty(expr->pred.right, name);
+    case RSExpr_Inverted:
+      return ExprAST_HasProperty(expr->inverted.child, name);
+    case RSExpr_Literal:
+      return false;
+  }
+  return false;
+}
+
 /* Allocate some memory for a function that can be freed automatically when the execution is done */
 void *ExprEval_UnalignedAlloc(ExprEval *ctx, size_t sz) {
   return BlkAlloc_Alloc(&ctx->stralloc, sz, MAX(sz, 1024));
@@ -387,6 +415,29 @@ int EvalCtx_EvalExpr(EvalCtx *r, RSExpr *expr) {
   return EvalCtx_Eval(r);
 }
 
+int EvalCtx_EvalProgram(EvalCtx *r, RSExpr *expr, const ExprProgram *prog) {
+  if (!prog) {
+    return EvalCtx_EvalExpr(r, expr);
+  }
+  if (r->_expr && r->_own_expr) {
+    ExprAST_Free(r->_expr);
+  }
+  r->_expr = expr;
+  r->_own_expr = false;
+  r->ee.root = expr;
+  if (ExprAST_GetLookupKeys(expr, (RLookup *) r->ee.lookup, r->ee.err) != EXPR_EVAL_OK) {
+    return REDISMODULE_ERR;
+  }
+
+  double d;
+  if (!ExprProgram_EvalRow(prog, &r->row, &d)) {
+    return ExprEval_Eval(&r->ee, &r->res);
+  }
+  RSValue_Clear(&r->res);
+  RSValue_SetNumber(&r->res, d);
+  return EXPR_EVAL_OK;
+}
+
 int EvalCtx_EvalExprStr(EvalCtx *r, const char *expr) {
   if (r->_expr && r->_own_expr) {
     ExprAST_Free(r->_expr);
@@ -409,17 +460,23 @@ struct RPEvaluator {
   RSValue *val;
   const RLookupKey *outkey;
   int isFilter;
+
+  // Numeric expressions are compiled, and evaluated over batches of upstream results
+  ExprProgram *program;
+  SearchResult *batch;
+  const RLookupRow **batchRows;
+  double *batchScratch;
+  bool *batchFallback;
+  size_t batchLen;
+  size_t batchPos;
+  // the upstream return code which ended the current batch
+  int batchRC;
 };
 
 #define RESULT_EVAL_ERR RS_RESULT_MAX + 1
+#define RPEVAL_BATCH_SIZE 128
 
-static int rpevalCommon(RPEvaluator *pc, SearchResult *r) {
-  /** Get the upstream result */
-  int rc = pc->base.upstream->Next(pc->base.upstream, r);
-  if (rc != RS_RESULT_OK) {
-    return rc;
-  }
-
+static int rpevalRow(RPEvaluator *pc, SearchResult *r) {
   pc->eval.res = r;
   pc->eval.srcrow = &r->rowdata;
 
@@ -430,13 +487,22 @@ static int rpevalCommon(RPEvaluator *pc, SearchResult *r) {
     pc->val = RS_NewValue(RSValue_Undef);
   }
 
-  rc = ExprEval_Eval(&pc->eval, pc->val);
+  int rc = ExprEval_Eval(&pc->eval, pc->val);
   if (rc != EXPR_EVAL_OK) {
     return RS_RESULT_ERROR;
   }
   return RS_RESULT_OK;
 }
 
+static int rpevalCommon(RPEvaluator *pc, SearchResult *r) {
+  /** Get the upstream result */
+  int rc = pc->base.upstream->Next(pc->base.upstream, r);
+  if (rc != RS_RESULT_OK) {
+    return rc;
+  }
+  return rpevalRow(pc, r);
+}
+
 static int rpevalNext_project(ResultProcessor *rp, SearchResult *r) {
   RPEvaluator *pc = (RPEvaluator *)rp;
   int rc = rpevalCommon(pc, r);
@@ -467,11 +533,157 @@ static int rpevalNext_filter(ResultProcessor *rp, SearchResult *r) {
   return rc;
 }
 
+// Pull a batch of results from upstream and run the program over all of them
+static void rpevalFillBatch(RPEvaluator *pc) {
+  pc->batchLen = pc->batchPos = 0;
+  pc->batchRC = RS_RESULT_OK;
+  while (pc->batchLen < RPEVAL_BATCH_SIZE) {
+    SearchResult *r = &pc->batch[pc->batchLen];
+    pc->batchRC = pc->base.upstream->Next(pc->base.upstream, r);
+    if (pc->batchRC != RS_RESULT_OK) {
+      break;
+    }
+    pc->batchRows[pc->batchLen++] = &r->rowdata;
+  }
+  if (pc->batchLen) {
+    ExprProgram_EvalBatch(pc->program, pc->batchRows, pc->batchLen, pc->batchScratch,
+                          pc->batchFallback);
+  }
+}
+
+// Move the next result of the batch to `r`. Returns false once the batch is consumed
+static bool rpevalPopBatch(RPEvaluator *pc, SearchResult *r, size_t *idx) {
+  if (pc->batchPos == pc->batchLen) {
+    return false;
+  }
+  *idx = pc->batchPos++;
+  // swap, so the row storage of `r` is reused by the next batch
+  SearchResult tmp = *r;
+  *r = pc->batch[*idx];
+  pc->batch[*idx] = tmp;
+  SearchResult_Clear(&pc->batch[*idx]);
+  return true;
+}
+
+// Returns the upstream return code which ended the batch, or fills a new batch
+static int rpevalNextBatch(RPEvaluator *pc) {
+  if (pc->batchRC != RS_RESULT_OK) {
+    int rc = pc->batchRC;
+    pc->batchRC = RS_RESULT_OK;
+    return rc;
+  }
+  rpevalFillBatch(pc);
+  return RS_RESULT_OK;
+}
+
+static int rpevalNext_projectBatch(ResultProcessor *rp, SearchResult *r) {
+  RPEvaluator *pc = (RPEvaluator *)rp;
+  size_t i;
+  while (!rpevalPopBatch(pc, r, &i)) {
+    int rc = rpevalNextBatch(pc);
+    if (rc != RS_RESULT_OK) {
+      return rc;
+    }
+  }
+
+  if (pc->batchFallback[i]) {
+    int rc = rpevalRow(pc, r);
+    if (rc != RS_RESULT_OK) {
+      return rc;
+    }
+    RLookup_WriteOwnKey(pc->outkey, &r->rowdata, pc->val);
+    pc->val = NULL;
+  } else {
+    RLookup_WriteOwnKey(pc->outkey, &r->rowdata, RS_NumVal(pc->batchScratch[i]));
+  }
+  return RS_RESULT_OK;
+}
+
+static int rpevalNext_filterBatch(ResultProcessor *rp, SearchResult *r) {
+  RPEvaluator *pc = (RPEvaluator *)rp;
+  size_t i;
+  while (true) {
+    while (!rpevalPopBatch(pc, r, &i)) {
+      int rc = rpevalNextBatch(pc);
+      if (rc != RS_RESULT_OK) {
+        return rc;
+      }
+    }
+
+    int boolrv;
+    if (pc->batchFallback[i]) {
+      int rc = rpevalRow(pc, r);
+      if (rc != RS_RESULT_OK) {
+        return rc;
+      }
+      boolrv = RSValue_BoolTest(pc->val);
+      RSValue_Clear(pc->val);
+    } else {
+      boolrv = pc->batchScratch[i] != 0;
+    }
+
+    if (boolrv) {
+      return RS_RESULT_OK;
+    }
+    SearchResult_Clear(r);
+  }
+}
+
+// Results are evaluated in batches only if they do not refer to the current result of the index
+// iterator, which is the case once they were accumulated by a sorter or a grouper
+static bool rpevalCanBatch(const ResultProcessor *rp) {
+  for (const ResultProcessor *up = rp->upstream; up; up = up->upstream) {
+    switch (up->type) {
+      case RP_SORTER:
+      case RP_GROUP:
+      case RP_NETWORK:
+        return true;
+      case RP_INDEX:
+      case RP_SCORER:
+      case RP_METRICS:
+        return false;
+      default:
+        break;
+    }
+  }
+  return false;
+}
+
+static int rpevalNext_start(ResultProcessor *rp, SearchResult *r) {
+  RPEvaluator *pc = (RPEvaluator *)rp;
+  if (!rpevalCanBatch(rp)) {
+    ExprProgram_Free(pc->program);
+    pc->program = NULL;
+    rp->Next = pc->isFilter ? rpevalNext_filter : rpevalNext_project;
+    return rp->Next(rp, r);
+  }
+
+  size_t scratch = ExprProgram_ScratchSize(pc->program, RPEVAL_BATCH_SIZE);
+  pc->batch = rm_calloc(RPEVAL_BATCH_SIZE, sizeof(*pc->batch));
+  pc->batchRows = rm_malloc(RPEVAL_BATCH_SIZE * sizeof(*pc->batchRows));
+  pc->batchScratch = rm_malloc(scratch * sizeof(*pc->batchScratch));
+  pc->batchFallback = rm_malloc(RPEVAL_BATCH_SIZE * sizeof(*pc->batchFallback));
+  rp->Next = pc->isFilter ? rpevalNext_filterBatch : rpevalNext_projectBatch;
+  return rp->Next(rp, r);
+}
+
 static void rpevalFree(ResultProcessor *rp) {
   RPEvaluator *ee = (RPEvaluator *)rp;
   if (ee->val) {
     RSValue_Decref(ee->val);
   }
+  if (ee->batch) {
+    for (size_t i = 0; i < RPEVAL_BATCH_SIZE; ++i) {
+      SearchResult_Destroy(&ee->batch[i]);
+    }
+    rm_free(ee->batch);
+    rm_free(ee->batchRows);
+    rm_free(ee->batchScratch);
+    rm_free(ee->batchFallback);
+  }
+  if (ee->program) {
+    ExprProgram_Free(ee->program);
+  }
   BlkAlloc_FreeAll(&ee->eval.stralloc, NULL, NULL, 0);
   rm_free(ee);
 }
@@ -485,6 +697,15 @@ static ResultProcessor *RPEvaluator_NewCommon(const RSExpr *ast, const RLookup *
   rp->eval.root = ast;
   rp->outkey = dstkey;
   BlkAlloc_Init(&rp->eval.stralloc);
+
+  // a single property or literal is not worth compiling
+  if (ast->t != RSExpr_Property && ast->t != RSExpr_Literal) {
+    rp->program = ExprProgram_Compile(ast);
+  }
+  if (rp->program) {
+    // the upstream is known only once the pipeline is built
+    rp->base.Next = rpevalNext_start;
+  }
   return &rp->base;
 }
 
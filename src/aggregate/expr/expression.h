@@ -154,6 +154,13 @@ int EvalCtx_Eval(EvalCtx *r);
 int EvalCtx_EvalExpr(EvalCtx *r, RSExpr *expr);
 int EvalCtx_EvalExprStr(EvalCtx *r, const char *exprstr);
 
+struct ExprProgram;
+/**
+ * Same as EvalCtx_EvalExpr, running `prog` - the compiled form of `expr`, if it is not NULL.
+ * The tree is evaluated if the values of the row are not all numbers.
+ */
+int EvalCtx_EvalProgram(EvalCtx *r, RSExpr *expr, const struct ExprProgram *prog);
+
 /**
  * Scan through the expression and generate any required lookups for the keys.
  * @param root Root iterator for scan start
@@ -162,6 +169,10 @@ int EvalCtx_EvalExprStr(EvalCtx *r, const char *exprstr);
  *  the error.
  */
 int ExprAST_GetLookupKeys(RSExpr *root, RLookup *lookup, QueryError *err);
+
+/* Whether the expression reads the property `name` */
+bool ExprAST_HasProperty(const RSExpr *expr, const char *name);
+
 int ExprEval_Eval(ExprEval *evaluator, RSValue *result);
 
 void ExprAST_Free(RSExpr *expr);
@@ -7,54 +7,64 @@
 #include <redisearch.h>
 #include <result_processor.h>
 #include <util/block_alloc.h>
-#include <util/khash.h>
 #include "reducer.h"
+#include "config.h"
+#include "thpool/thpool.h"
+#include "util/logging.h"
+
+#include <pthread.h>
 
 /**
  * A group represents the allocated context of all reducers in a group, and the
  * selected values of that group.
  *
  * Because one of these is created for every single group (i.e. every single
- * unique key) we want to keep this quite small!
+ * unique key) we want to keep this quite small! Groups are laid out one after the
+ * other in the grouper's allocator, each followed by its per-reducer data.
  */
 typedef struct {
   /** Contains the selected 'out' values used by the reducers output functions */
   RLookupRow rowdata;
-
-  /**
-   * Contains the actual per-reducer data for the group, in an accumulating
-   * fashion (e.g. how many records seen, and so on). This is created by
-   * Reducer::NewInstance()
-   */
-  void *accumdata[0];
 } Group;
 
-#define kh_set(kname, hash, key, val)   \
-  ({                                    \
-    int ret;                            \
-    k = kh_put(kname, hash, key, &ret); \
-    kh_value(hash, k) = val;            \
-    ret;                                \
-  })
-
-static const int khid = 33;
-KHASH_MAP_INIT_INT64(khid, Group *);
+/**
+ * A slot of the groups table. The table is a flat open addressing table, probed
+ * linearly, where an empty slot has no group.
+ */
+typedef struct {
+  uint64_t hash;
+  Group *group;
+} GroupSlot;
 
 #define GROUPER_NREDUCERS(g) (array_len((g)->reducers))
-#define GROUP_BYTESIZE(parent) (sizeof(Group) + (sizeof(void *) * GROUPER_NREDUCERS(parent)))
 #define GROUPS_PER_BLOCK 1024
 #define GROUPER_NSRCKEYS(g) ((g)->nkeys)
+#define GROUPS_TABLE_INITIAL_CAP 64
+// Minimal number of rows aggregated by each thread of a parallel aggregation
+#define GROUPER_MIN_ROWS_PER_THREAD 1024
+// Maximal number of rows kept for a parallel aggregation per thread, before they are aggregated
+#define GROUPER_MAX_PENDING_ROWS_PER_THREAD (16 * GROUPER_MIN_ROWS_PER_THREAD)
 
 typedef struct Grouper {
   // Result processor base, for use in row processing
   ResultProcessor base;
 
-  // Map of group_name => `Group` structure
-  khash_t(khid) * groups;
+  // Table of group_name hash => `Group`. The capacity is a power of 2
+  GroupSlot *table;
+  size_t tableCap;
+  size_t numGroups;
 
   // Backing store for the groups themselves
   BlkAlloc groupsAlloc;
 
+  /**
+   * Size of a group including its per-reducer data, and the offset of the data
+   * of each reducer in the group. The data of a reducer is either its inline
+   * instance, or a pointer to an instance created by Reducer::NewInstance()
+   */
+  size_t groupSize;
+  size_t *instanceOffsets;
+
   /**
    * Keys to group by. Both srckeys and dstkeys are used because different lookups
    * are employed. The srckeys are the lookup keys for the properties as they
@@ -68,10 +78,45 @@ typedef struct Grouper {
   // array of reducers
   Reducer **reducers;
 
-  // Used for maintaining state when yielding groups
-  khiter_t iter;
+  // Used for maintaining state when yielding groups, the next slot of the table
+  size_t iter;
+
+  /**
+   * Rows accumulated for a parallel aggregation. Slices of the rows are aggregated
+   * by partial groupers on the groupby thread pool, and the partial groups are merged
+   * into this grouper once done.
+   */
+  SearchResult *pending;
+
+  // Set on a partial grouper. The reducers are shared with, and owned by, the parent
+  struct Grouper *parent;
+
+  // Serializes Reducer::NewInstance() of the partial groupers, as the reducer allocator is shared
+  pthread_mutex_t instanceLock;
 } Grouper;
 
+Grouper *Grouper_New(const RLookupKey **srckeys, const RLookupKey **dstkeys, size_t nkeys);
+void Grouper_Free(Grouper *g);
+
+static void Grouper_SetupLayout(Grouper *g) {
+  size_t numReducers = GROUPER_NREDUCERS(g);
+  size_t offset = sizeof(Group);
+  g->instanceOffsets = rm_malloc(numReducers * sizeof(*g->instanceOffsets));
+  for (size_t ii = 0; ii < numReducers; ++ii) {
+    size_t instanceSize = g->reducers[ii]->instanceSize;
+    g->instanceOffsets[ii] = offset;
+    offset += instanceSize ? instanceSize : sizeof(void *);
+    // keep the data of every reducer aligned
+    offset = (offset + 7) & ~(size_t)7;
+  }
+  g->groupSize = offset;
+}
+
+static inline void *groupInstance(const Grouper *g, const Group *gr, size_t idx) {
+  char *data = (char *)gr + g->instanceOffsets[idx];
+  return g->reducers[idx]->instanceSize ? data : *(void **)data;
+}
+
 /**
  * Create a new group. groupvals is the key of the group. This will be the
  * number of field arguments passed to GROUPBY, e.g.
@@ -80,26 +125,125 @@ typedef struct Grouper {
  * These will be placed in the output row.
  */
 static Group *createGroup(Grouper *g, const RSValue **groupvals, size_t ngrpvals) {
-  size_t numReducers = array_len(g->reducers);
-  size_t elemSize = GROUP_BYTESIZE(g);
+  if (!g->groupSize) {
+    Grouper_SetupLayout(g);
+  }
+  size_t numReducers = GROUPER_NREDUCERS(g);
+  size_t elemSize = g->groupSize;
   Group *group = BlkAlloc_Alloc(&g->groupsAlloc, elemSize, GROUPS_PER_BLOCK * elemSize);
   memset(group, 0, elemSize);
 
   for (size_t ii = 0; ii < numReducers; ++ii) {
-    group->accumdata[ii] = g->reducers[ii]->NewInstance(g->reducers[ii]);
+    Reducer *rd = g->reducers[ii];
+    char *data = (char *)group + g->instanceOffsets[ii];
+    if (rd->instanceSize) {
+      rd->InitInstance(rd, data);
+    } else if (g->parent) {
+      pthread_mutex_lock(&g->parent->instanceLock);
+      *(void **)data = rd->NewInstance(rd);
+      pthread_mutex_unlock(&g->parent->instanceLock);
+    } else {
+      *(void **)data = rd->NewInstance(rd);
+    }
   }
 
   /** Initialize the row data! */
   for (size_t ii = 0; ii < ngrpvals; ++ii) {
+    // a partial grouper may not reference the shared null value, a missing key is merged as null
+    if (g->parent && groupvals[ii] == RS_NullVal()) {
+      continue;
+    }
     const RLookupKey *dstkey = g->dstkeys[ii];
     RLookup_WriteKey(dstkey, &group->rowdata, (RSValue *)groupvals[ii]);
-    // printf("Write: %s => ", dstkey->name);
-    // RSValue_Print(groupvals[ii]);
-    // printf("\n");
   }
+  g->numGroups++;
   return group;
 }
 
+// Hash a value of the group key. Numbers are mixed directly instead of being hashed byte by byte
+static inline uint64_t hashGroupValue(const RSValue *v, uint64_t hval) {
+  v = RSValue_Dereference(v);
+  if (v->t != RSValue_Number) {
+    return RSValue_Hash(v, hval);
+  }
+  uint64_t h;
+  memcpy(&h, &v->numval, sizeof(h));
+  h ^= hval * 0x9e3779b97f4a7c15ULL;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// Values are equal if they would have the same hash. Numbers are compared bitwise, as they are hashed
+static bool groupValueEquals(const RSValue *a, const RSValue *b) {
+  a = RSValue_Dereference(a);
+  b = RSValue_Dereference(b);
+  if (a == b) {
+    return true;
+  }
+  if (a->t == RSValue_Number || b->t == RSValue_Number) {
+    return a->t == b->t && !memcmp(&a->numval, &b->numval, sizeof(a->numval));
+  }
+  if (RSValue_IsNull(a) || RSValue_IsNull(b)) {
+    return RSValue_IsNull(a) && RSValue_IsNull(b);
+  }
+  return RSValue_Equal(a, b, NULL);
+}
+
+static bool groupKeyEquals(const Grouper *g, const Group *gr, const RSValue **groupvals,
+                           size_t ngrpvals) {
+  for (size_t ii = 0; ii < ngrpvals; ++ii) {
+    const RSValue *v = RLookup_GetItem(g->dstkeys[ii], &gr->rowdata);
+    if (!groupValueEquals(v ? v : RS_NullVal(), groupvals[ii])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void Grouper_GrowTable(Grouper *g) {
+  GroupSlot *old = g->table;
+  size_t oldCap = g->tableCap;
+  g->tableCap = oldCap ? oldCap * 2 : GROUPS_TABLE_INITIAL_CAP;
+  g->table = rm_calloc(g->tableCap, sizeof(*g->table));
+
+  size_t mask = g->tableCap - 1;
+  for (size_t ii = 0; ii < oldCap; ++ii) {
+    if (!old[ii].group) {
+      continue;
+    }
+    size_t pos = old[ii].hash & mask;
+    while (g->table[pos].group) {
+      pos = (pos + 1) & mask;
+    }
+    g->table[pos] = old[ii];
+  }
+  rm_free(old);
+}
+
+// Get or create the group of the key
+static Group *getGroup(Grouper *g, uint64_t hval, const RSValue **groupvals, size_t ngrpvals) {
+  // keep the load factor below 0.75
+  if ((g->numGroups + 1) * 4 > g->tableCap * 3) {
+    Grouper_GrowTable(g);
+  }
+  size_t mask = g->tableCap - 1;
+  for (size_t pos = hval & mask;; pos = (pos + 1) & mask) {
+    GroupSlot *slot = &g->table[pos];
+    if (!slot->group) {
+      slot->hash = hval;
+      slot->group = createGroup(g, groupvals, ngrpvals);
+      return slot->group;
+    }
+    if (slot->hash == hval && groupKeyEquals(g, slot->group, groupvals, ngrpvals)) {
+      return slot->group;
+    }
+  }
+}
+
 static void writeGroupValues(const Grouper *g, const Group *gr, SearchResult *r) {
   for (size_t ii = 0; ii < g->nkeys; ++ii) {
     const RLookupKey *dstkey = g->dstkeys[ii];
@@ -113,13 +257,11 @@ static void writeGroupValues(const Grouper *g, const Group *gr, SearchResult *r)
 static int Grouper_rpYield(ResultProcessor *base, SearchResult *r) {
   Grouper *g = (Grouper *)base;
 
-  while (g->iter != kh_end(g->groups)) {
-    if (!kh_exist(g->groups, g->iter)) {
-      g->iter++;
+  while (g->iter < g->tableCap) {
+    Group *gr = g->table[g->iter++].group;
+    if (!gr) {
       continue;
     }
-
-    Group *gr = kh_value(g->groups, g->iter);
     // no reducers; just a terminal GROUPBY...
 
     if (!GROUPER_NREDUCERS(g)) {
@@ -128,7 +270,7 @@ static int Grouper_rpYield(ResultProcessor *base, SearchResult *r) {
     // else...
     for (size_t ii = 0; ii < GROUPER_NREDUCERS(g); ++ii) {
       Reducer *rd = g->reducers[ii];
-      RSValue *v = rd->Finalize(rd, gr->accumdata[ii]);
+      RSValue *v = rd->Finalize(rd, groupInstance(g, gr, ii));
       if (v) {
         RLookup_WriteOwnKey(rd->dstkey, &r->rowdata, v);
         writeGroupValues(g, gr, r);
@@ -138,7 +280,6 @@ static int Grouper_rpYield(ResultProcessor *base, SearchResult *r) {
         // printf("Finalize() returned bad value!\n");
       }
     }
-    ++g->iter;
     return RS_RESULT_OK;
   }
 
@@ -148,7 +289,7 @@ static int Grouper_rpYield(ResultProcessor *base, SearchResult *r) {
 static void invokeReducers(Grouper *g, Group *gr, RLookupRow *srcrow) {
   size_t nreducers = GROUPER_NREDUCERS(g);
   for (size_t ii = 0; ii < nreducers; ii++) {
-    g->reducers[ii]->Add(g->reducers[ii], gr->accumdata[ii], srcrow);
+    g->reducers[ii]->Add(g->reducers[ii], groupInstance(g, gr, ii), srcrow);
   }
 }
 
@@ -172,16 +313,8 @@ static void extractGroups(Grouper *g, const RSValue **xarr, size_t xpos, size_t
                           uint64_t hval, RLookupRow *res) {
   // end of the line - create/add to group
   if (xpos == xlen) {
-    Group *group = NULL;
-
     // Get or create the group
-    khiter_t k = kh_get(khid, g->groups, hval);  // first have to get ieter
-    if (k == kh_end(g->groups)) {                // k will be equal to kh_end if key not present
-      group = createGroup(g, xarr, xlen);
-      kh_set(khid, g->groups, hval, group);
-    } else {
-      group = kh_value(g->groups, k);
-    }
+    Group *group = getGroup(g, hval, xarr, xlen);
 
     // send the result to the group and its reducers
     invokeReducers(g, group, res);
@@ -192,7 +325,7 @@ static void extractGroups(Grouper *g, const RSValue **xarr, size_t xpos, size_t
   const RSValue *v = RSValue_Dereference(xarr[xpos]);
   // regular value - just move one step -- increment XPOS
   if (v->t != RSValue_Array) {
-    hval = RSValue_Hash(v, hval);
+    hval = hashGroupValue(v, hval);
     extractGroups(g, xarr, xpos + 1, xlen, 0, hval, res);
   } else {
     // Array value. Replace current XPOS with child temporarily
@@ -208,7 +341,7 @@ static void extractGroups(Grouper *g, const RSValue **xarr, size_t xpos, size_t
     if (elem == NULL) {
       elem = RS_NullVal();
     }
-    uint64_t hh = RSValue_Hash(elem, hval);
+    uint64_t hh = hashGroupValue(elem, hval);
 
     xarr[xpos] = elem;
     extractGroups(g, xarr, xpos, xlen, arridx, hh, res);
@@ -222,7 +355,6 @@ static void extractGroups(Grouper *g, const RSValue **xarr, size_t xpos, size_t
 }
 
 static void invokeGroupReducers(Grouper *g, RLookupRow *srcrow) {
-  uint64_t hval = 0;
   size_t nkeys = GROUPER_NSRCKEYS(g);
   const RSValue *groupvals[nkeys];
 
@@ -234,24 +366,258 @@ static void invokeGroupReducers(Grouper *g, RLookupRow *srcrow) {
     }
     groupvals[ii] = v;
   }
+
+  // a single key which is not an array is the group key as is
+  if (nkeys == 1 && RSValue_Dereference(groupvals[0])->t != RSValue_Array) {
+    Group *group = getGroup(g, hashGroupValue(groupvals[0], 0), groupvals, 1);
+    invokeReducers(g, group, srcrow);
+    return;
+  }
   extractGroups(g, groupvals, 0, nkeys, 0, 0, srcrow);
 }
 
+// Rows can be aggregated in parallel only if the states of all the reducers can be merged
+static bool Grouper_CanRunParallel(const Grouper *g) {
+  if (RSGlobalConfig.groupbyThreads < 2) {
+    return false;
+  }
+  for (size_t ii = 0; ii < GROUPER_NREDUCERS(g); ++ii) {
+    if (!g->reducers[ii]->Merge) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static Grouper *Grouper_NewPartial(Grouper *parent) {
+  Grouper *g = Grouper_New(parent->srckeys, parent->dstkeys, parent->nkeys);
+  g->reducers = parent->reducers;
+  g->parent = parent;
+  return g;
+}
+
+/**
+ * Whether a partial grouper may reference `v`, and the array elements it groups by, from its own
+ * thread. The refcounts of values are not atomic, so a value is private to the slice of its row
+ * only if the row holds its only reference: shared values, such as the null value or the literals
+ * of APPLY, are only referenced by the query thread.
+ */
+static bool isPrivateValue(const RSValue *v) {
+  if (!v->allocated || v->refcount != 1) {
+    return false;
+  }
+  const RSValue *target = RSValue_Dereference(v);
+  if (target->t != RSValue_Array) {
+    return true;
+  }
+  // the array behind a reference may be shared by other rows
+  if (target != v) {
+    return false;
+  }
+  for (uint32_t ii = 0; ii < RSValue_ArrayLen(v); ++ii) {
+    const RSValue *elem = RSValue_ArrayItem(v, ii);
+    if (!elem->allocated || elem->refcount != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Whether all the values of the row read by the grouper and its reducers are private to the row
+static bool Grouper_IsPrivateRow(const Grouper *g, const RLookupRow *row) {
+  for (size_t ii = 0; ii < g->nkeys; ++ii) {
+    const RSValue *v = RLookup_GetItem(g->srckeys[ii], row);
+    if (v && !isPrivateValue(v)) {
+      return false;
+    }
+  }
+  for (size_t ii = 0; ii < GROUPER_NREDUCERS(g); ++ii) {
+    const RLookupKey *srckey = g->reducers[ii]->srckey;
+    const RSValue *v = srckey ? RLookup_GetItem(srckey, row) : NULL;
+    if (v && !isPrivateValue(v)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Threads of the parallel aggregations, started by the first one. Their number is set at load time
+static redisearch_threadpool groupbyThreadpool_g = NULL;
+static pthread_mutex_t groupbyThreadpoolLock_g = PTHREAD_MUTEX_INITIALIZER;
+
+static redisearch_threadpool Grouper_GetThreadPool() {
+  pthread_mutex_lock(&groupbyThreadpoolLock_g);
+  if (groupbyThreadpool_g == NULL) {
+    // the query thread aggregates a slice of its own
+    groupbyThreadpool_g = redisearch_thpool_create(RSGlobalConfig.groupbyThreads - 1,
+                                                   DEFAULT_PRIVILEGED_THREADS_NUM);
+    redisearch_thpool_init(groupbyThreadpool_g, LogCallback);
+  }
+  pthread_mutex_unlock(&groupbyThreadpoolLock_g);
+  return groupbyThreadpool_g;
+}
+
+void Grouper_ThreadPoolDestroy() {
+  if (groupbyThreadpool_g != NULL) {
+    redisearch_thpool_destroy(groupbyThreadpool_g);
+    groupbyThreadpool_g = NULL;
+  }
+}
+
+/**
+ * A parallel aggregation of the pending rows. Each slice of the rows is aggregated by a partial
+ * grouper. The slices are claimed both by the jobs queued to the thread pool and by the query
+ * thread, so the query thread never waits for a slice no thread has started. A job may run after
+ * all the slices are done, so the context is released by the query thread and by every job.
+ */
+typedef struct {
+  SearchResult *rows;
+  size_t nrows;
+  size_t sliceSize;
+  Grouper **parts;
+  size_t nslices;
+  // The next slice to claim
+  size_t nextSlice;
+  size_t doneSlices;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  size_t refcount;
+} GrouperParallelCtx;
+
+static void GrouperParallelCtx_Release(GrouperParallelCtx *ctx) {
+  if (__atomic_sub_fetch(&ctx->refcount, 1, __ATOMIC_ACQ_REL)) {
+    return;
+  }
+  pthread_cond_destroy(&ctx->cond);
+  pthread_mutex_destroy(&ctx->lock);
+  rm_free(ctx->parts);
+  rm_free(ctx);
+}
+
+// Aggregate slices of the rows until there are none left to claim
+static void Grouper_AccumSlices(GrouperParallelCtx *ctx) {
+  size_t slice;
+  while ((slice = __atomic_fetch_add(&ctx->nextSlice, 1, __ATOMIC_RELAXED)) < ctx->nslices) {
+    size_t begin = MIN(slice * ctx->sliceSize, ctx->nrows);
+    size_t end = MIN(begin + ctx->sliceSize, ctx->nrows);
+    for (size_t ii = begin; ii < end; ++ii) {
+      invokeGroupReducers(ctx->parts[slice], &ctx->rows[ii].rowdata);
+    }
+    pthread_mutex_lock(&ctx->lock);
+    if (++ctx->doneSlices == ctx->nslices) {
+      pthread_cond_signal(&ctx->cond);
+    }
+    pthread_mutex_unlock(&ctx->lock);
+  }
+}
+
+static void Grouper_AccumSlicesJob(void *arg) {
+  GrouperParallelCtx *ctx = arg;
+  Grouper_AccumSlices(ctx);
+  GrouperParallelCtx_Release(ctx);
+}
+
+// Merge the groups of a partial grouper into their groups in `g`
+static void Grouper_MergePartial(Grouper *g, Grouper *part) {
+  const RSValue *groupvals[g->nkeys];
+  for (size_t ii = 0; ii < part->tableCap; ++ii) {
+    const GroupSlot *slot = &part->table[ii];
+    if (!slot->group) {
+      continue;
+    }
+    for (size_t kk = 0; kk < g->nkeys; ++kk) {
+      const RSValue *v = RLookup_GetItem(g->dstkeys[kk], &slot->group->rowdata);
+      groupvals[kk] = v ? v : RS_NullVal();
+    }
+    Group *gr = getGroup(g, slot->hash, groupvals, g->nkeys);
+    for (size_t rr = 0; rr < GROUPER_NREDUCERS(g); ++rr) {
+      Reducer *rd = g->reducers[rr];
+      rd->Merge(rd, groupInstance(g, gr, rr), groupInstance(part, slot->group, rr));
+    }
+  }
+}
+
+// Aggregate the pending rows, in parallel if there are enough of them, and release them
+static void Grouper_AccumPending(Grouper *g) {
+  size_t nrows = array_len(g->pending);
+  size_t nslices = MIN(RSGlobalConfig.groupbyThreads, nrows / GROUPER_MIN_ROWS_PER_THREAD);
+
+  if (nslices < 2) {
+    for (size_t ii = 0; ii < nrows; ++ii) {
+      invokeGroupReducers(g, &g->pending[ii].rowdata);
+    }
+  } else {
+    GrouperParallelCtx *ctx = rm_calloc(1, sizeof(*ctx));
+    ctx->rows = g->pending;
+    ctx->nrows = nrows;
+    ctx->sliceSize = (nrows + nslices - 1) / nslices;
+    ctx->nslices = nslices;
+    ctx->parts = rm_malloc(nslices * sizeof(*ctx->parts));
+    for (size_t ii = 0; ii < nslices; ++ii) {
+      ctx->parts[ii] = Grouper_NewPartial(g);
+    }
+    pthread_mutex_init(&ctx->lock, NULL);
+    pthread_cond_init(&ctx->cond, NULL);
+    // one reference for the query thread and one for each job
+    ctx->refcount = nslices;
+
+    redisearch_threadpool pool = Grouper_GetThreadPool();
+    for (size_t ii = 1; ii < nslices; ++ii) {
+      if (redisearch_thpool_add_work(pool, Grouper_AccumSlicesJob, ctx, THPOOL_PRIORITY_HIGH)) {
+        GrouperParallelCtx_Release(ctx);
+      }
+    }
+    Grouper_AccumSlices(ctx);
+    pthread_mutex_lock(&ctx->lock);
+    while (ctx->doneSlices < nslices) {
+      pthread_cond_wait(&ctx->cond, &ctx->lock);
+    }
+    pthread_mutex_unlock(&ctx->lock);
+
+    for (size_t ii = 0; ii < nslices; ++ii) {
+      Grouper_MergePartial(g, ctx->parts[ii]);
+      Grouper_Free(ctx->parts[ii]);
+    }
+    GrouperParallelCtx_Release(ctx);
+  }
+
+  for (size_t ii = 0; ii < nrows; ++ii) {
+    SearchResult_Destroy(&g->pending[ii]);
+  }
+  array_clear(g->pending);
+}
+
 static int Grouper_rpAccum(ResultProcessor *base, SearchResult *res) {
   Grouper *g = (Grouper *)base;
   uint32_t chunkLimit = base->parent->resultLimit;
   base->parent->resultLimit = UINT32_MAX; // we want to accumulate all the results
+  bool parallel = Grouper_CanRunParallel(g);
+  size_t maxPending = RSGlobalConfig.groupbyThreads * GROUPER_MAX_PENDING_ROWS_PER_THREAD;
   int rc;
 
   while ((rc = base->upstream->Next(base->upstream, res)) == RS_RESULT_OK) {
-    invokeGroupReducers(g, &res->rowdata);
-    SearchResult_Clear(res);
+    // a row with shared values is aggregated right away, by the query thread
+    if (parallel && Grouper_IsPrivateRow(g, &res->rowdata)) {
+      // keep the row, the index result is only valid until the next one is read
+      res->indexResult = NULL;
+      g->pending = array_ensure_append_1(g->pending, *res);
+      *res = (SearchResult){0};
+      if (array_len(g->pending) >= maxPending) {
+        Grouper_AccumPending(g);
+      }
+    } else {
+      invokeGroupReducers(g, &res->rowdata);
+      SearchResult_Clear(res);
+    }
   }
   base->parent->resultLimit = chunkLimit; // restore the limit
   if (rc == RS_RESULT_EOF) {
+    if (g->pending && array_len(g->pending)) {
+      Grouper_AccumPending(g);
+    }
     base->Next = Grouper_rpYield;
-    base->parent->totalResults = kh_size(g->groups);
-    g->iter = kh_begin(khid);
+    base->parent->totalResults = g->numGroups;
+    g->iter = 0;
     return Grouper_rpYield(base, res);
   } else {
     return rc;
@@ -264,30 +630,34 @@ static void cleanCallback(void *ptr, void *arg) {
   // Call the reducer's FreeInstance
   for (size_t ii = 0; ii < GROUPER_NREDUCERS(parent); ++ii) {
     Reducer *rr = parent->reducers[ii];
-    if (rr->FreeInstance) {
-      rr->FreeInstance(rr, group->accumdata[ii]);
+    if (rr->FreeInstance && !rr->instanceSize) {
+      rr->FreeInstance(rr, groupInstance(parent, group, ii));
     }
   }
+  RLookupRow_Cleanup(&group->rowdata);
 }
 
 static void Grouper_rpFree(ResultProcessor *grrp) {
   Grouper *g = (Grouper *)grrp;
-  for (khiter_t it = kh_begin(g->groups); it != kh_end(g->groups); ++it) {
-    if (!kh_exist(g->groups, it)) {
-      continue;
-    }
-    Group *gr = kh_value(g->groups, it);
-    RLookupRow_Cleanup(&gr->rowdata);
-  }
-  kh_destroy(khid, g->groups);
-  BlkAlloc_FreeAll(&g->groupsAlloc, cleanCallback, g, GROUP_BYTESIZE(g));
+  rm_free(g->table);
+  BlkAlloc_FreeAll(&g->groupsAlloc, cleanCallback, g, g->groupSize);
 
-  for (size_t i = 0; i < GROUPER_NREDUCERS(g); i++) {
-    g->reducers[i]->Free(g->reducers[i]);
+  if (g->pending) {
+    for (size_t i = 0; i < array_len(g->pending); i++) {
+      SearchResult_Destroy(&g->pending[i]);
+    }
+    array_free(g->pending);
   }
-  if (g->reducers) {
-    array_free(g->reducers);
+  if (!g->parent) {
+    for (size_t i = 0; i < GROUPER_NREDUCERS(g); i++) {
+      g->reducers[i]->Free(g->reducers[i]);
+    }
+    if (g->reducers) {
+      array_free(g->reducers);
+    }
   }
+  pthread_mutex_destroy(&g->instanceLock);
+  rm_free(g->instanceOffsets);
   rm_free(g->srckeys);
   rm_free(g->dstkeys);
   rm_free(g);
@@ -300,7 +670,7 @@ void Grouper_Free(Grouper *g) {
 Grouper *Grouper_New(const RLookupKey **srckeys, const RLookupKey **dstkeys, size_t nkeys) {
   Grouper *g = rm_calloc(1, sizeof(*g));
   BlkAlloc_Init(&g->groupsAlloc);
-  g->groups = kh_init(khid);
+  pthread_mutex_init(&g->instanceLock, NULL);
 
   g->srckeys = rm_calloc(nkeys, sizeof(*g->srckeys));
   g->dstkeys = rm_calloc(nkeys, sizeof(*g->dstkeys));
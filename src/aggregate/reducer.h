@@ -30,6 +30,9 @@ typedef enum {
   REDUCER_T_HLL,
   REDUCER_T_HLLSUM,
   REDUCER_T_SAMPLE,
+  REDUCER_T_QUANTILE_TDIGEST,
+  REDUCER_T_TDIGEST,
+  REDUCER_T_TDIGEST_QUANTILE,
 
   /** Not a reducer, but a marker of the end of the list */
   REDUCER_T__END
@@ -63,6 +66,14 @@ typedef struct Reducer {
    */
   void *(*NewInstance)(struct Reducer *r);
 
+  /**
+   * Size of a per-group instance which can be laid out inline in the group by the grouper, or 0
+   * if the instances are only created by NewInstance(). Inline instances are initialized by
+   * InitInstance(), and must not own any resources as FreeInstance() is not called for them.
+   */
+  size_t instanceSize;
+  void (*InitInstance)(struct Reducer *r, void *instance);
+
   /**
    * Passes a result through the reducer. The reducer can then store the
    * results internally until it can be outputted in `dstrow`.
@@ -78,6 +89,14 @@ typedef struct Reducer {
    */
   RSValue *(*Finalize)(struct Reducer *parent, void *instance);
 
+  /**
+   * Merges the instance `src` into `dst`, as if all the results passed to `src`
+   * were passed to `dst` as well. `src` is freed once merged, and is not used
+   * afterwards. Reducers without Merge() can not be used for parallel
+   * aggregation.
+   */
+  void (*Merge)(struct Reducer *parent, void *dst, void *src);
+
   /** Frees the object created by NewInstance() */
   void (*FreeInstance)(struct Reducer *parent, void *instance);
 
@@ -165,6 +184,9 @@ Reducer *RDCRFirstValue_New(const ReducerOptions *);
 Reducer *RDCRRandomSample_New(const ReducerOptions *);
 Reducer *RDCRHLL_New(const ReducerOptions *);
 Reducer *RDCRHLLSum_New(const ReducerOptions *);
+Reducer *RDCRQuantileTDigest_New(const ReducerOptions *);
+Reducer *RDCRTDigest_New(const ReducerOptions *);
+Reducer *RDCRTDigestQuantile_New(const ReducerOptions *);
 
 typedef Reducer *(*ReducerFactory)(const ReducerOptions *);
 ReducerFactory RDCR_GetFactory(const char *name);
@@ -13,9 +13,14 @@ typedef struct {
 
 #define COUNTER_BLOCK_SIZE 32 * sizeof(counterData)
 
+static void counterInitInstance(Reducer *r, void *instance) {
+  counterData *dd = instance;
+  dd->count = 0;
+}
+
 static void *counterNewInstance(Reducer *r) {
   counterData *dd = BlkAlloc_Alloc(&r->alloc, sizeof(counterData), COUNTER_BLOCK_SIZE);
-  dd->count = 0;
+  counterInitInstance(r, dd);
   return dd;
 }
 
@@ -24,6 +29,10 @@ static int counterAdd(Reducer *r, void *ctx, const RLookupRow *srcrow) {
   return 1;
 }
 
+static void counterMerge(Reducer *r, void *dst, void *src) {
+  ((counterData *)dst)->count += ((counterData *)src)->count;
+}
+
 static RSValue *counterFinalize(Reducer *r, void *instance) {
   counterData *dd = instance;
   return RS_NumVal(dd->count);
@@ -37,7 +46,10 @@ Reducer *RDCRCount_New(const ReducerOptions *options) {
   Reducer *r = rm_calloc(1, sizeof(*r));
   r->Add = counterAdd;
   r->Finalize = counterFinalize;
+  r->Merge = counterMerge;
   r->Free = Reducer_GenericFree;
   r->NewInstance = counterNewInstance;
+  r->InitInstance = counterInitInstance;
+  r->instanceSize = sizeof(counterData);
   return r;
 }
@@ -11,7 +11,7 @@
 #include "hll/hll.h"
 #include "rmutil/sds.h"
 
-#define HLL_PRECISION_BITS 8
+#define HLL_DEFAULT_PRECISION_BITS 8
 #define INSTANCE_BLOCK_NUM 1024
 
 static const int khid = 35;
@@ -51,6 +51,21 @@ static int distinctAdd(Reducer *r, void *ctx, const RLookupRow *srcrow) {
   return 1;
 }
 
+static void distinctMerge(Reducer *r, void *dst, void *src) {
+  distinctCounter *dctr = dst;
+  const distinctCounter *sctr = src;
+  for (khiter_t k = kh_begin(sctr->dedup); k != kh_end(sctr->dedup); ++k) {
+    if (!kh_exist(sctr->dedup, k)) {
+      continue;
+    }
+    int ret;
+    kh_put(khid, dctr->dedup, kh_key(sctr->dedup, k), &ret);
+    if (ret) {
+      dctr->count++;
+    }
+  }
+}
+
 static RSValue *distinctFinalize(Reducer *parent, void *ctx) {
   distinctCounter *ctr = ctx;
   return RS_NumVal(ctr->count);
@@ -71,6 +86,7 @@ Reducer *RDCRCountDistinct_New(const ReducerOptions *options) {
   }
   r->Add = distinctAdd;
   r->Finalize = distinctFinalize;
+  r->Merge = distinctMerge;
   r->Free = Reducer_GenericFree;
   r->FreeInstance = distinctFreeInstance;
   r->NewInstance = distinctNewInstance;
@@ -78,6 +94,11 @@ Reducer *RDCRCountDistinct_New(const ReducerOptions *options) {
   return r;
 }
 
+typedef struct {
+  Reducer base;
+  uint8_t bits;
+} HLLReducer;
+
 typedef struct {
   struct HLL hll;
   const RLookupKey *key;
@@ -87,7 +108,7 @@ static void *distinctishNewInstance(Reducer *parent) {
   BlkAlloc *ba = &parent->alloc;
   distinctishCounter *ctr =
       BlkAlloc_Alloc(ba, sizeof(*ctr), 1024 * sizeof(*ctr));  // malloc(sizeof(*ctr));
-  hll_init(&ctr->hll, HLL_PRECISION_BITS);
+  hll_init(&ctr->hll, ((HLLReducer *)parent)->bits);
   ctr->key = parent->srckey;
   return ctr;
 }
@@ -99,12 +120,16 @@ static int distinctishAdd(Reducer *parent, void *instance, const RLookupRow *src
     return 1;
   }
 
-  uint64_t hval = RSValue_Hash(val, 0x5f61767a);
-  uint32_t val32 = (uint32_t)hval ^ (uint32_t)(hval >> 32);
-  hll_add_hash(&ctr->hll, val32);
+  hll_add_hash(&ctr->hll, RSValue_Hash(val, 0x5f61767a));
   return 1;
 }
 
+static void distinctishMerge(Reducer *parent, void *dst, void *src) {
+  distinctishCounter *dctr = dst;
+  const distinctishCounter *sctr = src;
+  hll_merge(&dctr->hll, &sctr->hll);
+}
+
 static RSValue *distinctishFinalize(Reducer *parent, void *instance) {
   distinctishCounter *ctr = instance;
   return RS_NumVal((uint64_t)hll_count(&ctr->hll));
@@ -117,34 +142,64 @@ static void distinctishFreeInstance(Reducer *r, void *p) {
 
 /** Serialized HLL format */
 typedef struct __attribute__((packed)) {
-  uint32_t flags;  // Currently unused
+  uint32_t flags;
   uint8_t bits;
   // uint32_t size -- NOTE - always 1<<bits
 } HLLSerializedHeader;
 
+// The registers were built from 64 bit hashes. Registers of older versions, which used 32 bit
+// hashes, can not be merged with them, and are counted apart by HLL_SUM.
+#define HLL_SERIALIZED_F_HASH64 0x01
+
 static RSValue *hllFinalize(Reducer *parent, void *ctx) {
   distinctishCounter *ctr = ctx;
 
-  // Serialize field map.
-  HLLSerializedHeader hdr = {.flags = 0, .bits = ctr->hll.bits};
+  // Serialize field map. Sparse HLLs are serialized as dense registers as well
+  HLLSerializedHeader hdr = {.flags = HLL_SERIALIZED_F_HASH64, .bits = ctr->hll.bits};
   char *str = rm_malloc(sizeof(hdr) + ctr->hll.size);
   size_t hdrsize = sizeof(hdr);
   memcpy(str, &hdr, hdrsize);
-  memcpy(str + hdrsize, ctr->hll.registers, ctr->hll.size);
+  hll_copy_registers(&ctr->hll, (uint8_t *)str + hdrsize);
   RSValue *ret = RS_StringVal(str, sizeof(hdr) + ctr->hll.size);
   return ret;
 }
 
 static Reducer *newHllCommon(const ReducerOptions *options, int isRaw) {
-  Reducer *r = rm_calloc(1, sizeof(*r));
+  HLLReducer *hr = rm_calloc(1, sizeof(*hr));
+  Reducer *r = &hr->base;
+  hr->bits = HLL_DEFAULT_PRECISION_BITS;
   if (!ReducerOpts_GetKey(options, &r->srckey)) {
     rm_free(r);
     return NULL;
   }
+
+  // Optional precision: the number of bits addressing the 2^bits registers
+  if (!AC_IsAtEnd(options->args)) {
+    unsigned bits;
+    int rv = AC_GetUnsigned(options->args, &bits, 0);
+    if (rv != AC_OK) {
+      QERR_MKBADARGS_AC(options->status, "<precision>", rv);
+      rm_free(r);
+      return NULL;
+    }
+    if (bits < HLL_MIN_BITS || bits > HLL_MAX_BITS) {
+      QERR_MKBADARGS_FMT(options->status, "Precision must be between %d and %d", HLL_MIN_BITS,
+                         HLL_MAX_BITS);
+      rm_free(r);
+      return NULL;
+    }
+    hr->bits = bits;
+  }
+  if (!ReducerOpts_EnsureArgsConsumed(options)) {
+    rm_free(r);
+    return NULL;
+  }
+
   r->Add = distinctishAdd;
   r->Free = Reducer_GenericFree;
   r->FreeInstance = distinctishFreeInstance;
   r->NewInstance = distinctishNewInstance;
+  r->Merge = distinctishMerge;
 
   if (isRaw) {
     r->reducerId = REDUCER_T_HLL;
@@ -164,11 +219,40 @@ Reducer *RDCRHLL_New(const ReducerOptions *options) {
   return newHllCommon(options, 1);
 }
 
+/*
+ * Registers built from 32 bit hashes, by shards of older versions, can not be merged with
+ * registers built from 64 bit hashes, so they are summed up in a separate HLL. The registers only
+ * hold ranks, so both are counted the same way, and the count is the sum of both counts. Values
+ * which were counted by shards of both versions are then counted twice.
+ */
 typedef struct {
   const RLookupKey *srckey;
   struct HLL hll;
+  struct HLL legacy;
 } hllSumCtx;
 
+// Merge the serialized registers into `hll`, which is loaded from them if it is still empty
+static int hllsumMergeRegisters(struct HLL *hll, const char *registers, size_t regsz,
+                                uint8_t bits) {
+  if (!hll->bits) {
+    if (hll_load(hll, registers, regsz) != 0) {
+      *hll = (struct HLL){0};
+      return 0;
+    }
+    return 1;
+  }
+  if (bits != hll->bits) {
+    return 0;
+  }
+  struct HLL tmphll;
+  if (hll_load(&tmphll, registers, regsz) != 0) {
+    return 0;
+  }
+  int rc = hll_merge(hll, &tmphll);
+  hll_destroy(&tmphll);
+  return rc == 0;
+}
+
 static int hllsumAdd(Reducer *r, void *ctx, const RLookupRow *srcrow) {
   hllSumCtx *ctr = ctx;
   const RSValue *val = RLookup_GetItem(ctr->srckey, srcrow);
@@ -192,7 +276,7 @@ static int hllsumAdd(Reducer *r, void *ctx, const RLookupRow *srcrow) {
 
   // Can't be an insane bit value - we don't want to overflow either!
   size_t regsz = len - sizeof(*hdr);
-  if (hdr->bits > 64) {
+  if (hdr->bits < HLL_MIN_BITS || hdr->bits > HLL_MAX_BITS) {
     return 0;
   }
 
@@ -202,33 +286,45 @@ static int hllsumAdd(Reducer *r, void *ctx, const RLookupRow *srcrow) {
     return 0;
   }
 
-  if (ctr->hll.bits) {
-    if (hdr->bits != ctr->hll.bits) {
-      return 0;
-    }
-    // Merge!
-    struct HLL tmphll = {
-        .bits = hdr->bits, .size = 1 << hdr->bits, .registers = (uint8_t *)registers};
-    if (hll_merge(&ctr->hll, &tmphll) != 0) {
-      return 0;
-    }
-  } else {
-    // Not yet initialized - make this our first register and continue.
-    hll_init(&ctr->hll, hdr->bits);
-    memcpy(ctr->hll.registers, registers, regsz);
+  // Ranks of 32 bit hashes don't mix with ranks of 64 bit hashes
+  struct HLL *hll = hdr->flags & HLL_SERIALIZED_F_HASH64 ? &ctr->hll : &ctr->legacy;
+  return hllsumMergeRegisters(hll, registers, regsz, hdr->bits);
+}
+
+static void hllsumMergeHLL(struct HLL *dst, const struct HLL *src) {
+  if (!src->bits) {
+    return;
   }
-  return 1;
+  if (!dst->bits) {
+    hll_init(dst, src->bits);
+  }
+  // HLLs of different precisions are skipped by hllsumAdd() as well
+  hll_merge(dst, src);
+}
+
+static void hllsumMerge(Reducer *r, void *dst, void *src) {
+  hllSumCtx *dctr = dst;
+  const hllSumCtx *sctr = src;
+  hllsumMergeHLL(&dctr->hll, &sctr->hll);
+  hllsumMergeHLL(&dctr->legacy, &sctr->legacy);
 }
 
 static RSValue *hllsumFinalize(Reducer *parent, void *ctx) {
   hllSumCtx *ctr = ctx;
-  return RS_NumVal(ctr->hll.bits ? (uint64_t)hll_count(&ctr->hll) : 0);
+  double count = 0;
+  if (ctr->hll.bits) {
+    count += hll_count(&ctr->hll);
+  }
+  if (ctr->legacy.bits) {
+    count += hll_count(&ctr->legacy);
+  }
+  return RS_NumVal((uint64_t)count);
 }
 
 static void *hllsumNewInstance(Reducer *r) {
   hllSumCtx *ctr = BlkAlloc_Alloc(&r->alloc, sizeof(*ctr), 1024 * sizeof(*ctr));
-  ctr->hll.bits = 0;
-  ctr->hll.registers = NULL;
+  ctr->hll = (struct HLL){0};
+  ctr->legacy = (struct HLL){0};
   ctr->srckey = r->srckey;
   return ctr;
 }
@@ -236,6 +332,7 @@ static void *hllsumNewInstance(Reducer *r) {
 static void hllsumFreeInstance(Reducer *r, void *p) {
   hllSumCtx *ctr = p;
   hll_destroy(&ctr->hll);
+  hll_destroy(&ctr->legacy);
 }
 
 Reducer *RDCRHLLSum_New(const ReducerOptions *options) {
@@ -249,6 +346,7 @@ Reducer *RDCRHLLSum_New(const ReducerOptions *options) {
   r->Finalize = hllsumFinalize;
   r->NewInstance = hllsumNewInstance;
   r->FreeInstance = hllsumFreeInstance;
+  r->Merge = hllsumMerge;
   r->Free = Reducer_GenericFree;
   return r;
 }
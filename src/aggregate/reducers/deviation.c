@@ -15,10 +15,15 @@ typedef struct {
 
 #define BLOCK_SIZE 1024 * sizeof(devCtx)
 
-static void *stddevNewInstance(Reducer *rbase) {
-  devCtx *dctx = BlkAlloc_Alloc(&rbase->alloc, sizeof(*dctx), BLOCK_SIZE);
+static void stddevInitInstance(Reducer *rbase, void *instance) {
+  devCtx *dctx = instance;
   memset(dctx, 0, sizeof(*dctx));
   dctx->srckey = rbase->srckey;
+}
+
+static void *stddevNewInstance(Reducer *rbase) {
+  devCtx *dctx = BlkAlloc_Alloc(&rbase->alloc, sizeof(*dctx), BLOCK_SIZE);
+  stddevInitInstance(rbase, dctx);
   return dctx;
 }
 
@@ -59,6 +64,27 @@ static int stddevAdd(Reducer *r, void *ctx, const RLookupRow *srcrow) {
   return 1;
 }
 
+static void stddevMerge(Reducer *r, void *dst, void *src) {
+  devCtx *da = dst;
+  const devCtx *db = src;
+  if (!db->n) {
+    return;
+  } else if (!da->n) {
+    da->n = db->n;
+    da->oldM = da->newM = db->newM;
+    da->oldS = da->newS = db->newS;
+    return;
+  }
+  // https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Parallel_algorithm
+  size_t n = da->n + db->n;
+  double delta = db->newM - da->newM;
+  double mean = da->newM + delta * db->n / n;
+  double s = da->newS + db->newS + delta * delta * ((double)da->n * db->n / n);
+  da->n = n;
+  da->oldM = da->newM = mean;
+  da->oldS = da->newS = s;
+}
+
 static RSValue *stddevFinalize(Reducer *parent, void *instance) {
   devCtx *dctx = instance;
   double variance = ((dctx->n > 1) ? dctx->newS / (dctx->n - 1) : 0.0);
@@ -74,8 +100,11 @@ Reducer *RDCRStdDev_New(const ReducerOptions *options) {
   }
   r->Add = stddevAdd;
   r->Finalize = stddevFinalize;
+  r->Merge = stddevMerge;
   r->Free = Reducer_GenericFree;
   r->NewInstance = stddevNewInstance;
+  r->InitInstance = stddevInitInstance;
+  r->instanceSize = sizeof(devCtx);
   r->reducerId = REDUCER_T_STDDEV;
   return r;
 }
@@ -21,9 +21,9 @@ typedef struct {
   MinmaxMode mode;
 } MinmaxReducer;
 
-static void *minmaxNewInstance(Reducer *rbase) {
+static void minmaxInitInstance(Reducer *rbase, void *instance) {
   MinmaxReducer *r = (MinmaxReducer *)rbase;
-  minmaxCtx *m = BlkAlloc_Alloc(&rbase->alloc, sizeof(*m), 1024);
+  minmaxCtx *m = instance;
   m->mode = r->mode;
   m->srckey = r->base.srckey;
   m->numMatches = 0;
@@ -34,6 +34,11 @@ static void *minmaxNewInstance(Reducer *rbase) {
   } else {
     m->val = 0;
   }
+}
+
+static void *minmaxNewInstance(Reducer *rbase) {
+  minmaxCtx *m = BlkAlloc_Alloc(&rbase->alloc, sizeof(*m), 1024);
+  minmaxInitInstance(rbase, m);
   return m;
 }
 
@@ -55,6 +60,19 @@ static int minmaxAdd(Reducer *r, void *ctx, const RLookupRow *srcrow) {
   return 1;
 }
 
+static void minmaxMerge(Reducer *r, void *dst, void *src) {
+  minmaxCtx *dm = dst;
+  const minmaxCtx *sm = src;
+  if (!sm->numMatches) {
+    return;
+  }
+  if (!dm->numMatches || (dm->mode == Minmax_Max && sm->val > dm->val) ||
+      (dm->mode == Minmax_Min && sm->val < dm->val)) {
+    dm->val = sm->val;
+  }
+  dm->numMatches += sm->numMatches;
+}
+
 static RSValue *minmaxFinalize(Reducer *parent, void *instance) {
   minmaxCtx *ctx = instance;
   return RS_NumVal(ctx->numMatches ? ctx->val : 0);
@@ -67,8 +85,11 @@ static Reducer *newMinMax(const ReducerOptions *options, MinmaxMode mode) {
     return NULL;
   }
   r->base.NewInstance = minmaxNewInstance;
+  r->base.InitInstance = minmaxInitInstance;
+  r->base.instanceSize = sizeof(minmaxCtx);
   r->base.Add = minmaxAdd;
   r->base.Finalize = minmaxFinalize;
+  r->base.Merge = minmaxMerge;
   r->base.Free = Reducer_GenericFree;
   r->mode = mode;
   return &r->base;
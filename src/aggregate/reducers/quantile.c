@@ -42,6 +42,10 @@ static int quantileAdd(Reducer *rbase, void *ctx, const RLookupRow *row) {
   return 1;
 }
 
+static void quantileMerge(Reducer *r, void *dst, void *src) {
+  QS_Merge(dst, src);
+}
+
 static RSValue *quantileFinalize(Reducer *r, void *ctx) {
   QuantStream *qs = ctx;
   QTLReducer *qt = (QTLReducer *)r;
@@ -90,6 +94,7 @@ Reducer *RDCRQuantile_New(const ReducerOptions *options) {
   r->base.Free = Reducer_GenericFree;
   r->base.FreeInstance = quantileFreeInstance;
   r->base.Finalize = quantileFinalize;
+  r->base.Merge = quantileMerge;
   return &r->base;
 
 error:
@@ -47,6 +47,46 @@ static int sampleAdd(Reducer *rbase, void *ctx, const RLookupRow *srcrow) {
   return 1;
 }
 
+// Pop a random value of the first `n` values of `arr`
+static RSValue *popRandom(RSValue **arr, size_t n) {
+  size_t i = rand() % n;
+  RSValue *v = arr[i];
+  arr[i] = arr[n - 1];
+  return v;
+}
+
+static void sampleMerge(Reducer *rbase, void *dst, void *src) {
+  RSMPLReducer *r = (RSMPLReducer *)rbase;
+  rsmplCtx *dsc = dst;
+  rsmplCtx *ssc = src;
+  size_t dlen = RSVALUE_ARRLEN(dsc->samplesArray), slen = RSVALUE_ARRLEN(ssc->samplesArray);
+  RSValue *dvals[dlen], *svals[slen];
+  memcpy(dvals, dsc->samplesArray->arrval.vals, dlen * sizeof(*dvals));
+  memcpy(svals, ssc->samplesArray->arrval.vals, slen * sizeof(*svals));
+
+  // Each sample stands for the values seen by its instance, so a sample is taken from either
+  // instance in proportion to the number of values it has seen and not yet sampled
+  size_t dseen = dsc->seen, sseen = ssc->seen;
+  size_t len = MIN(r->len, dlen + slen);
+  for (size_t i = 0; i < len; ++i) {
+    RSValue *v;
+    if (dlen && (!slen || rand() % (dseen + sseen) < dseen)) {
+      v = popRandom(dvals, dlen--);
+      dseen--;
+    } else {
+      v = RSValue_IncrRef(popRandom(svals, slen--));
+      sseen--;
+    }
+    RSVALUE_ARRELEM(dsc->samplesArray, i) = v;
+  }
+  // the samples of `dst` which were not taken
+  for (size_t i = 0; i < dlen; ++i) {
+    RSValue_Decref(dvals[i]);
+  }
+  RSVALUE_ARRLEN(dsc->samplesArray) = len;
+  dsc->seen += ssc->seen;
+}
+
 static RSValue *sampleFinalize(Reducer *rbase, void *ctx) {
   rsmplCtx *sc = ctx;
   RSMPLReducer *r = (RSMPLReducer *)rbase;
@@ -87,6 +127,7 @@ Reducer *RDCRRandomSample_New(const ReducerOptions *options) {
   Reducer *rbase = &ret->base;
   rbase->Add = sampleAdd;
   rbase->Finalize = sampleFinalize;
+  rbase->Merge = sampleMerge;
   rbase->Free = Reducer_GenericFree;
   rbase->FreeInstance = sampleFreeInstance;
   rbase->NewInstance = sampleNewInstance;
@@ -19,10 +19,15 @@ typedef struct {
 
 #define BLOCK_SIZE 32 * sizeof(sumCtx)
 
-static void *sumNewInstance(Reducer *r) {
-  sumCtx *ctx = BlkAlloc_Alloc(&r->alloc, sizeof(*ctx), BLOCK_SIZE);
+static void sumInitInstance(Reducer *r, void *instance) {
+  sumCtx *ctx = instance;
   ctx->count = 0;
   ctx->total = 0;
+}
+
+static void *sumNewInstance(Reducer *r) {
+  sumCtx *ctx = BlkAlloc_Alloc(&r->alloc, sizeof(*ctx), BLOCK_SIZE);
+  sumInitInstance(r, ctx);
   return ctx;
 }
 
@@ -42,6 +47,13 @@ static int sumAdd(Reducer *baseparent, void *instance, const RLookupRow *row) {
   return 1;
 }
 
+static void sumMerge(Reducer *baseparent, void *dst, void *src) {
+  sumCtx *dctx = dst;
+  const sumCtx *sctx = src;
+  dctx->count += sctx->count;
+  dctx->total += sctx->total;
+}
+
 static RSValue *sumFinalize(Reducer *baseparent, void *instance) {
   sumCtx *ctr = instance;
   SumReducer *parent = (SumReducer *)baseparent;
@@ -63,8 +75,11 @@ static Reducer *newReducerCommon(const ReducerOptions *options, int isAvg) {
     return NULL;
   }
   r->base.NewInstance = sumNewInstance;
+  r->base.InitInstance = sumInitInstance;
+  r->base.instanceSize = sizeof(sumCtx);
   r->base.Add = sumAdd;
   r->base.Finalize = sumFinalize;
+  r->base.Merge = sumMerge;
   r->base.Free = Reducer_GenericFree;
   r->isAvg = isAvg;
   return &r->base;
@@ -0,0 +1,157 @@
+/*
+ * Copyright Redis Ltd. 2016 - present
+ * Licensed under your choice of the Redis Source Available License 2.0 (RSALv2) or
+ * the Server Side Public License v1 (SSPLv1).
+ */
+
+#include <aggregate/reducer.h>
+#include "util/tdigest.h"
+
+#include <math.h>
+
+typedef struct {
+  Reducer base;
+  double pct;
+  unsigned compression;
+} TDigestReducer;
+
+static void *tdigestNewInstance(Reducer *parent) {
+  TDigestReducer *r = (TDigestReducer *)parent;
+  return TDigest_New(r->compression);
+}
+
+static int tdigestAdd(Reducer *rbase, void *ctx, const RLookupRow *row) {
+  double d;
+  TDigest *td = ctx;
+  RSValue *v = RLookup_GetItem(rbase->srckey, row);
+  if (!v) {
+    return 1;
+  }
+
+  if (v->t != RSValue_Array) {
+    if (RSValue_ToNumber(v, &d)) {
+      TDigest_Add(td, d, 1);
+    }
+  } else {
+    uint32_t sz = RSValue_ArrayLen(v);
+    for (uint32_t i = 0; i < sz; i++) {
+      if (RSValue_ToNumber(RSValue_ArrayItem(v, i), &d)) {
+        TDigest_Add(td, d, 1);
+      }
+    }
+  }
+  return 1;
+}
+
+// Merges a digest serialized by the TDIGEST reducer
+static int tdigestMergeAdd(Reducer *rbase, void *ctx, const RLookupRow *row) {
+  TDigest *td = ctx;
+  const RSValue *v = RLookup_GetItem(rbase->srckey, row);
+  if (v == NULL || !RSValue_IsString(v)) {
+    return 0;
+  }
+
+  size_t len;
+  const char *buf = RSValue_StringPtrLen(v, &len);
+  TDigest *other = TDigest_Deserialize(buf, len);
+  if (!other) {
+    return 0;
+  }
+  TDigest_Merge(td, other);
+  TDigest_Free(other);
+  return 1;
+}
+
+static void tdigestMerge(Reducer *r, void *dst, void *src) {
+  TDigest_Merge(dst, src);
+}
+
+static RSValue *tdigestQuantileFinalize(Reducer *r, void *ctx) {
+  TDigest *td = ctx;
+  TDigestReducer *tr = (TDigestReducer *)r;
+  // same as QUANTILE, an empty group has a 0 quantile
+  return RS_NumVal(TDigest_Count(td) ? TDigest_Quantile(td, tr->pct) : 0);
+}
+
+static RSValue *tdigestSerializeFinalize(Reducer *r, void *ctx) {
+  size_t len;
+  char *buf = TDigest_Serialize(ctx, &len);
+  return RS_StringVal(buf, len);
+}
+
+static void tdigestFreeInstance(Reducer *unused, void *p) {
+  TDigest_Free(p);
+}
+
+static Reducer *newTDigestCommon(const ReducerOptions *options, bool hasQuantile) {
+  TDigestReducer *r = rm_calloc(1, sizeof(*r));
+  r->compression = TDIGEST_DEFAULT_COMPRESSION;
+
+  if (!ReducerOptions_GetKey(options, &r->base.srckey)) {
+    goto error;
+  }
+  int rv;
+  if (hasQuantile) {
+    if ((rv = AC_GetDouble(options->args, &r->pct, 0)) != AC_OK) {
+      QERR_MKBADARGS_AC(options->status, options->name, rv);
+      goto error;
+    }
+    if (!(r->pct >= 0 && r->pct <= 1.0)) {
+      QERR_MKBADARGS_FMT(options->status, "Percentage must be between 0.0 and 1.0");
+      goto error;
+    }
+  }
+
+  if (!AC_IsAtEnd(options->args)) {
+    if ((rv = AC_GetUnsigned(options->args, &r->compression, 0)) != AC_OK) {
+      QERR_MKBADARGS_AC(options->status, "<compression>", rv);
+      goto error;
+    }
+    if (r->compression < TDIGEST_MIN_COMPRESSION || r->compression > TDIGEST_MAX_COMPRESSION) {
+      QERR_MKBADARGS_FMT(options->status, "Invalid compression");
+      goto error;
+    }
+  }
+
+  if (!ReducerOpts_EnsureArgsConsumed(options)) {
+    goto error;
+  }
+
+  r->base.NewInstance = tdigestNewInstance;
+  r->base.Add = tdigestAdd;
+  r->base.Merge = tdigestMerge;
+  r->base.Free = Reducer_GenericFree;
+  r->base.FreeInstance = tdigestFreeInstance;
+  r->base.Finalize = tdigestQuantileFinalize;
+  return &r->base;
+
+error:
+  rm_free(r);
+  return NULL;
+}
+
+Reducer *RDCRQuantileTDigest_New(const ReducerOptions *options) {
+  Reducer *r = newTDigestCommon(options, true);
+  if (r) {
+    r->reducerId = REDUCER_T_QUANTILE_TDIGEST;
+  }
+  return r;
+}
+
+Reducer *RDCRTDigest_New(const ReducerOptions *options) {
+  Reducer *r = newTDigestCommon(options, false);
+  if (r) {
+    r->reducerId = REDUCER_T_TDIGEST;
+    r->Finalize = tdigestSerializeFinalize;
+  }
+  return r;
+}
+
+Reducer *RDCRTDigestQuantile_New(const ReducerOptions *options) {
+  Reducer *r = newTDigestCommon(options, true);
+  if (r) {
+    r->reducerId = REDUCER_T_TDIGEST_QUANTILE;
+    r->Add = tdigestMergeAdd;
+  }
+  return r;
+}
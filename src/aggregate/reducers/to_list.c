@@ -48,6 +48,21 @@ static int tolistAdd(Reducer *rbase, void *ctx, const RLookupRow *srcrow) {
   return 1;
 }
 
+static void tolistMerge(Reducer *rbase, void *dst, void *src) {
+  tolistCtx *dtlc = dst;
+  tolistCtx *stlc = src;
+  TrieMapIterator *it = TrieMap_Iterate(stlc->values, "", 0);
+  char *c;
+  tm_len_t l;
+  void *ptr;
+  while (TrieMapIterator_Next(it, &c, &l, &ptr)) {
+    if (ptr && TrieMap_Find(dtlc->values, c, l) == TRIEMAP_NOTFOUND) {
+      TrieMap_Add(dtlc->values, c, l, RSValue_IncrRef(ptr), NULL);
+    }
+  }
+  TrieMapIterator_Free(it);
+}
+
 static RSValue *tolistFinalize(Reducer *rbase, void *ctx) {
   tolistCtx *tlc = ctx;
   TrieMapIterator *it = TrieMap_Iterate(tlc->values, "", 0);
@@ -84,6 +99,7 @@ Reducer *RDCRToList_New(const ReducerOptions *opts) {
   }
   r->Add = tolistAdd;
   r->Finalize = tolistFinalize;
+  r->Merge = tolistMerge;
   r->Free = Reducer_GenericFree;
   r->FreeInstance = tolistFreeInstance;
   r->NewInstance = tolistNewInstance;
@@ -48,6 +48,7 @@
 #define RS_INDEX_LIST_CMD RS_CMD_READ_PREFIX "._LIST"
 #define RS_INFO_CMD RS_CMD_READ_PREFIX ".INFO"
 #define RS_SEARCH_CMD RS_CMD_READ_PREFIX ".SEARCH"
+#define RS_MSEARCH_CMD RS_CMD_READ_PREFIX ".MSEARCH"
 #define RS_AGGREGATE_CMD RS_CMD_READ_PREFIX ".AGGREGATE"
 #define RS_PROFILE_CMD RS_CMD_READ_PREFIX ".PROFILE"
 #define RS_EXPLAIN_CMD RS_CMD_READ_PREFIX ".EXPLAIN"
@@ -357,6 +357,11 @@ CONFIG_SETTER(setForkGcRetryInterval) {
   RETURN_STATUS(acrc);
 }
 
+CONFIG_SETTER(setForkGcShmSize) {
+  int acrc = AC_GetSize(ac, &config->gcConfigParams.forkGc.forkGcShmSize, 0);
+  RETURN_STATUS(acrc);
+}
+
 CONFIG_SETTER(setMaxResultsToUnsortedMode) {
   int acrc = AC_GetLongLong(ac, &config->iteratorsConfigParams.maxResultsToUnsortedMode, AC_F_GE1);
   RETURN_STATUS(acrc);
@@ -387,6 +392,11 @@ CONFIG_GETTER(getForkGcRetryInterval) {
   return sdscatprintf(ss, "%lu", config->gcConfigParams.forkGc.forkGcRetryInterval);
 }
 
+CONFIG_GETTER(getForkGcShmSize) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%lu", config->gcConfigParams.forkGc.forkGcShmSize);
+}
+
 // FORK_GC_CLEAN_NUMERIC_EMPTY_NODES
 CONFIG_SETTER(setForkGCCleanNumericEmptyNodes) {
   config->gcConfigParams.forkGc.forkGCCleanNumericEmptyNodes = 1;
@@ -606,6 +616,50 @@ CONFIG_GETTER(getBGIndexSleepGap) {
   return sdscatprintf(ss, "%u", config->numBGIndexingIterationsBeforeSleep);
 }
 
+// MAX_RESIDENT_INDEXES
+CONFIG_SETTER(setMaxResidentIndexes) {
+  int acrc = AC_GetSize(ac, &config->maxResidentIndexes, AC_F_GE0);
+  RETURN_STATUS(acrc);
+}
+
+CONFIG_GETTER(getMaxResidentIndexes) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%lu", config->maxResidentIndexes);
+}
+
+// QUERY_CACHE_SIZE
+CONFIG_SETTER(setQueryCacheSize) {
+  int acrc = AC_GetSize(ac, &config->queryCacheSize, AC_F_GE0);
+  RETURN_STATUS(acrc);
+}
+
+CONFIG_GETTER(getQueryCacheSize) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%lu", config->queryCacheSize);
+}
+
+// GROUPBY_THREADS
+CONFIG_SETTER(setGroupbyThreads) {
+  int acrc = AC_GetSize(ac, &config->groupbyThreads, AC_F_GE0);
+  RETURN_STATUS(acrc);
+}
+
+CONFIG_GETTER(getGroupbyThreads) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%lu", config->groupbyThreads);
+}
+
+// SORT_SPILL_THRESHOLD
+CONFIG_SETTER(setSortSpillThreshold) {
+  int acrc = AC_GetSize(ac, &config->sortSpillThreshold, AC_F_GE0);
+  RETURN_STATUS(acrc);
+}
+
+CONFIG_GETTER(getSortSpillThreshold) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%lu", config->sortSpillThreshold);
+}
+
 RSConfig RSGlobalConfig = RS_DEFAULT_CONFIG;
 
 static RSConfigVar *findConfigVar(const RSConfigOptions *config, const char *name) {
@@ -798,12 +852,17 @@ RSConfigOptions RSGlobalConfigOptions = {
          .helpText = "interval (in seconds) in which to retry running the forkgc after failure.",
          .setValue = setForkGcRetryInterval,
          .getValue = getForkGcRetryInterval},
+        {.name = "FORK_GC_SHM_SIZE",
+         .helpText = "size (in bytes) of the shared memory used to transfer data from the fork gc "
+                     "child process, 0 to transfer it over a pipe.",
+         .setValue = setForkGcShmSize,
+         .getValue = getForkGcShmSize},
         {.name = "FORK_GC_CLEAN_NUMERIC_EMPTY_NODES",
-         .helpText = "clean empty nodes from numeric tree",
+         .helpText = "clean empty nodes from numeric tree and merge or re-split its unbalanced leaves",
          .setValue = setForkGCCleanNumericEmptyNodes,
          .getValue = getForkGCCleanNumericEmptyNodes},
         {.name = "_FORK_GC_CLEAN_NUMERIC_EMPTY_NODES",
-         .helpText = "clean empty nodes from numeric tree",
+         .helpText = "clean empty nodes from numeric tree and merge or re-split its unbalanced leaves",
          .setValue = set_ForkGCCleanNumericEmptyNodes,
          .getValue = get_ForkGCCleanNumericEmptyNodes},
         {.name = "_MAX_RESULTS_TO_UNSORTED_MODE",
@@ -880,6 +939,29 @@ RSConfigOptions RSGlobalConfigOptions = {
          .setValue = setBGIndexSleepGap,
          .getValue = getBGIndexSleepGap,
          .flags = RSCONFIGVAR_F_IMMUTABLE},
+        {.name = "MAX_RESIDENT_INDEXES",
+         .helpText = "Maximal number of indexes kept in memory. Least recently used indexes above "
+                     "the limit are evicted and rebuilt from the keyspace on their next use "
+                     "(0 means unlimited)",
+         .setValue = setMaxResidentIndexes,
+         .getValue = getMaxResidentIndexes},
+        {.name = "QUERY_CACHE_SIZE",
+         .helpText = "Maximal number of parsed queries cached per index, reused by queries "
+                     "differing only by their parameters (0 disables the cache)",
+         .setValue = setQueryCacheSize,
+         .getValue = getQueryCacheSize},
+        {.name = "GROUPBY_THREADS",
+         .helpText = "Number of threads aggregating the rows of a GROUPBY step in parallel, "
+                     "used if all of its reducers can be merged (0 disables parallel aggregation)",
+         .setValue = setGroupbyThreads,
+         .getValue = getGroupbyThreads,
+         .flags = RSCONFIGVAR_F_IMMUTABLE},
+        {.name = "SORT_SPILL_THRESHOLD",
+         .helpText = "Maximal number of results a sorter keeps in memory. Sorters returning more "
+                     "results spill sorted runs to temporary files, which are merged when the "
+                     "results are returned (0 disables spilling)",
+         .setValue = setSortSpillThreshold,
+         .getValue = getSortSpillThreshold},
         {.name = NULL}}};
 
 void RSConfigOptions_AddConfigs(RSConfigOptions *src, RSConfigOptions *dst) {
@@ -40,6 +40,8 @@ typedef struct {
   size_t forkGcCleanThreshold;
   size_t forkGcRetryInterval;
   size_t forkGcSleepBeforeExit;
+  // size of the memory shared with the fork gc child. 0 means data is sent over the pipe
+  size_t forkGcShmSize;
   int forkGCCleanNumericEmptyNodes;
 } forkGcConfig;
 
@@ -156,6 +158,18 @@ typedef struct {
   // before we call usleep(1) (sleep for 1 micro-second) and make sure that
   // we allow redis process other commands.
   unsigned int numBGIndexingIterationsBeforeSleep;
+  // The maximal number of indexes whose data is kept in memory. The least recently used indexes
+  // above this limit are evicted and rebuilt from the keyspace when they are used again.
+  // 0 means unlimited (lazy loading is disabled).
+  size_t maxResidentIndexes;
+  // The maximal number of parsed queries cached per index. 0 disables the cache.
+  size_t queryCacheSize;
+  // The number of threads aggregating the rows of a GROUPBY step. 0 or 1 aggregate on the query
+  // thread only.
+  size_t groupbyThreads;
+  // The maximal number of results a sorter keeps in memory before spilling them to a temporary
+  // file. 0 means sorters never spill.
+  size_t sortSpillThreshold;
 } RSConfig;
 
 typedef enum {
@@ -225,6 +239,7 @@ void DialectsGlobalStats_AddToInfo(RedisModuleInfoCtx *ctx);
 #define GC_SCANSIZE 100
 #define DEFAULT_MIN_PHONETIC_TERM_LEN 3
 #define DEFAULT_FORK_GC_RUN_INTERVAL 30
+#define DEFAULT_FORK_GC_SHM_SIZE (16 * 1024 * 1024)
 #define DEFAULT_MAX_RESULTS_TO_UNSORTED_MODE 1000
 #define SEARCH_REQUEST_RESULTS_MAX 1000000
 #define NR_MAX_DEPTH_BALANCE 2
@@ -268,6 +283,7 @@ void DialectsGlobalStats_AddToInfo(RedisModuleInfoCtx *ctx);
     .iteratorsConfigParams.maxResultsToUnsortedMode = DEFAULT_MAX_RESULTS_TO_UNSORTED_MODE,                                                 \
     .gcConfigParams.forkGc.forkGcRetryInterval = 5,                                                                                         \
     .gcConfigParams.forkGc.forkGcCleanThreshold = 100,                                                                                      \
+    .gcConfigParams.forkGc.forkGcShmSize = DEFAULT_FORK_GC_SHM_SIZE,                                                                        \
     .noMemPool = 0,                                                                                                   \
     .filterCommands = 0,                                                                                              \
     .maxSearchResults = SEARCH_REQUEST_RESULTS_MAX,                                                                   \
@@ -284,6 +300,10 @@ void DialectsGlobalStats_AddToInfo(RedisModuleInfoCtx *ctx);
     .multiTextOffsetDelta = 100,                                                                                      \
     .used_dialects = 0,                                                                                               \
     .numBGIndexingIterationsBeforeSleep = 100,                                                                         \
+    .maxResidentIndexes = 0,                                                                                          \
+    .queryCacheSize = 0,                                                                                              \
+    .groupbyThreads = 0,                                                                                              \
+    .sortSpillThreshold = 0,                                                                                          \
   }
 
 #define REDIS_ARRAY_LIMIT 7
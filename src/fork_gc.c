@@ -11,6 +11,7 @@
 #include "redis_index.h"
 #include "numeric_index.h"
 #include "tag_index.h"
+#include "geometry_index.h"
 #include "time_sample.h"
 #include <stdlib.h>
 #include <stdbool.h>
@@ -18,6 +19,9 @@
 #include <sys/wait.h>
 #include <sys/resource.h>
 #include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/param.h>
+#include <fcntl.h>
 #include "rwlock.h"
 #include "util/khash.h"
 #include <float.h>
@@ -53,8 +57,75 @@ static void FGC_updateStats(ForkGC *gc, RedisSearchCtx *sctx, size_t recordsRemo
   gc->stats.totalCollected += bytesCollected;
 }
 
-static void FGC_sendFixed(ForkGC *fgc, const void *buff, size_t len) {
-  RS_LOG_ASSERT(len > 0, "buffer length cannot be 0");
+/**
+ * The shared memory arena starts with this header, followed by the data ring.
+ * The child only moves `written` and the parent only moves `consumed`, so the
+ * positions are plain monotonic counters and the ring needs no locking.
+ */
+typedef struct {
+  // total bytes written to the ring by the child
+  size_t written;
+  // total bytes read from the ring by the parent
+  size_t consumed;
+  // set by the child before it blocks on the release pipe, waiting for room in the ring
+  int childWaiting;
+  // set by the parent once it stopped reading, so a blocked child can exit
+  int parentDone;
+} FGCArenaHeader;
+
+#define FGC_ARENA_HDR_SIZE 64
+#define FGC_ARENA_HDR(a) ((FGCArenaHeader *)(a)->base)
+#define FGC_ARENA_DATA(a) ((char *)(a)->base + FGC_ARENA_HDR_SIZE)
+#define FGC_WAKEUP_BATCH 256
+
+static void FGC_arenaCreate(ForkGC *gc) {
+  ForkGCArena *arena = &gc->arena;
+  size_t size = RSGlobalConfig.gcConfigParams.forkGc.forkGcShmSize;
+  *arena = (ForkGCArena){0};
+  if (size == 0) {
+    return;
+  }
+  if (pipe(arena->releasefd) == -1) {
+    RedisModule_Log(NULL, "warning", "GC fork: failed to create the release pipe, falling back to pipe");
+    return;
+  }
+  // Pages are only committed once touched, so an idle arena costs nothing
+  void *base = mmap(NULL, size + FGC_ARENA_HDR_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED) {
+    RedisModule_Log(NULL, "warning", "GC fork: failed to map shared memory, falling back to pipe");
+    close(arena->releasefd[GC_READERFD]);
+    close(arena->releasefd[GC_WRITERFD]);
+    return;
+  }
+  // The parent never waits for the child on this pipe
+  fcntl(arena->releasefd[GC_WRITERFD], F_SETFL, O_NONBLOCK);
+  arena->base = base;
+  arena->size = size;
+}
+
+static void FGC_arenaDestroy(ForkGC *gc) {
+  ForkGCArena *arena = &gc->arena;
+  if (arena->base) {
+    munmap(arena->base, arena->size + FGC_ARENA_HDR_SIZE);
+    // Each process closes the end it doesn't use after forking
+    if (arena->releasefd[GC_READERFD] != -1) close(arena->releasefd[GC_READERFD]);
+    if (arena->releasefd[GC_WRITERFD] != -1) close(arena->releasefd[GC_WRITERFD]);
+  }
+  *arena = (ForkGCArena){0};
+}
+
+// Keep only the end of the release pipe used by this side of the fork
+static void FGC_arenaAfterFork(ForkGC *gc, bool child) {
+  ForkGCArena *arena = &gc->arena;
+  if (arena->base) {
+    int unused = child ? GC_WRITERFD : GC_READERFD;
+    close(arena->releasefd[unused]);
+    arena->releasefd[unused] = -1;
+  }
+}
+
+static void FGC_pipeWrite(ForkGC *fgc, const void *buff, size_t len) {
   ssize_t size = write(fgc->pipefd[GC_WRITERFD], buff, len);
   if (size != len) {
     perror("broken pipe, exiting GC fork: write() failed");
@@ -64,6 +135,91 @@ static void FGC_sendFixed(ForkGC *fgc, const void *buff, size_t len) {
   }
 }
 
+/**
+ * Wake up the parent if it may be waiting for data published since the last
+ * wakeup. The child end of the pipe is non blocking: a full pipe means the
+ * parent has pending wakeups anyway.
+ */
+static void FGC_flush(ForkGC *fgc) {
+  ForkGCArena *arena = &fgc->arena;
+  if (!arena->base || arena->flushed == arena->pos) {
+    return;
+  }
+  char c = 0;
+  ssize_t size = write(fgc->pipefd[GC_WRITERFD], &c, 1);
+  if (size != 1 && errno != EAGAIN && errno != EINTR) {
+    perror("broken pipe, exiting GC fork: write() failed");
+    RedisModule_Log(NULL, "warning", "GC fork: broken pipe, exiting");
+    exit(1);
+  }
+  arena->flushed = arena->pos;
+}
+
+// Wake up the child if it is blocked on a full ring (parent)
+static void FGC_arenaRelease(ForkGCArena *arena) {
+  FGCArenaHeader *hdr = FGC_ARENA_HDR(arena);
+  if (__atomic_load_n(&hdr->childWaiting, __ATOMIC_SEQ_CST) &&
+      __atomic_exchange_n(&hdr->childWaiting, 0, __ATOMIC_SEQ_CST)) {
+    // A full pipe already holds a wakeup
+    char c = 0;
+    ssize_t ignored = write(arena->releasefd[GC_WRITERFD], &c, 1);
+    (void)ignored;
+  }
+}
+
+// Block until the parent reads from the full ring (child)
+static void FGC_arenaWaitForRoom(ForkGC *fgc) {
+  ForkGCArena *arena = &fgc->arena;
+  FGCArenaHeader *hdr = FGC_ARENA_HDR(arena);
+  // Make sure the parent is awake, and announce the wait before checking the ring again, so that
+  // either we see the room made by the parent, or the parent sees that we wait
+  FGC_flush(fgc);
+  __atomic_store_n(&hdr->childWaiting, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&hdr->consumed, __ATOMIC_SEQ_CST) + arena->size == arena->pos &&
+      !__atomic_load_n(&hdr->parentDone, __ATOMIC_SEQ_CST)) {
+    char c;
+    ssize_t nrecvd = read(arena->releasefd[GC_READERFD], &c, 1);
+    if (nrecvd == 0 || (nrecvd < 0 && errno != EINTR)) {
+      // The parent is gone
+      _exit(1);
+    }
+  }
+  __atomic_store_n(&hdr->childWaiting, 0, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&hdr->parentDone, __ATOMIC_ACQUIRE)) {
+    _exit(1);
+  }
+}
+
+static void FGC_arenaWrite(ForkGC *fgc, const char *buff, size_t len) {
+  ForkGCArena *arena = &fgc->arena;
+  FGCArenaHeader *hdr = FGC_ARENA_HDR(arena);
+  char *data = FGC_ARENA_DATA(arena);
+  while (len) {
+    size_t avail = arena->size - (arena->pos - __atomic_load_n(&hdr->consumed, __ATOMIC_ACQUIRE));
+    if (avail == 0) {
+      // The ring is full, wait for the parent to catch up
+      FGC_arenaWaitForRoom(fgc);
+      continue;
+    }
+    size_t off = arena->pos % arena->size;
+    size_t n = MIN(len, MIN(avail, arena->size - off));
+    memcpy(data + off, buff, n);
+    buff += n;
+    len -= n;
+    arena->pos += n;
+    __atomic_store_n(&hdr->written, arena->pos, __ATOMIC_RELEASE);
+  }
+}
+
+static void FGC_sendFixed(ForkGC *fgc, const void *buff, size_t len) {
+  RS_LOG_ASSERT(len > 0, "buffer length cannot be 0");
+  if (fgc->arena.base) {
+    FGC_arenaWrite(fgc, buff, len);
+  } else {
+    FGC_pipeWrite(fgc, buff, len);
+  }
+}
+
 #define FGC_SEND_VAR(fgc, v) FGC_sendFixed(fgc, &v, sizeof v)
 
 static void FGC_sendBuffer(ForkGC *fgc, const void *buff, size_t len) {
@@ -81,9 +237,50 @@ static int FGC_recvFixed(ForkGC *fgc, void *buf, size_t len);
 static void FGC_sendTerminator(ForkGC *fgc) {
   size_t smax = SIZE_MAX;
   FGC_SEND_VAR(fgc, smax);
+  FGC_flush(fgc);
+}
+
+/**
+ * Copy the next bytes of the ring into `buf`. The received buffers are owned by the index once
+ * applied, and freed with rm_free, while the ring is reused for the next ones, so they are copied
+ * once, straight into their final allocation.
+ */
+static int __attribute__((warn_unused_result))
+FGC_arenaRead(ForkGC *fgc, char *buf, size_t len) {
+  ForkGCArena *arena = &fgc->arena;
+  FGCArenaHeader *hdr = FGC_ARENA_HDR(arena);
+  const char *data = FGC_ARENA_DATA(arena);
+  while (len) {
+    size_t avail = __atomic_load_n(&hdr->written, __ATOMIC_ACQUIRE) - arena->pos;
+    if (avail == 0) {
+      // Nothing published yet, sleep on the pipe until the child wakes us up
+      char wakeups[FGC_WAKEUP_BATCH];
+      ssize_t nrecvd = read(fgc->pipefd[GC_READERFD], wakeups, sizeof wakeups);
+      if (nrecvd == 0 && __atomic_load_n(&hdr->written, __ATOMIC_ACQUIRE) == arena->pos) {
+        // The child exited without sending everything
+        return REDISMODULE_ERR;
+      } else if (nrecvd < 0 && errno != EINTR) {
+        printf("Got error while reading from pipe (%s)", strerror(errno));
+        return REDISMODULE_ERR;
+      }
+      continue;
+    }
+    size_t off = arena->pos % arena->size;
+    size_t n = MIN(len, MIN(avail, arena->size - off));
+    memcpy(buf, data + off, n);
+    buf += n;
+    len -= n;
+    arena->pos += n;
+    __atomic_store_n(&hdr->consumed, arena->pos, __ATOMIC_SEQ_CST);
+    FGC_arenaRelease(arena);
+  }
+  return REDISMODULE_OK;
 }
 
 static int __attribute__((warn_unused_result)) FGC_recvFixed(ForkGC *fgc, void *buf, size_t len) {
+  if (fgc->arena.base) {
+    return FGC_arenaRead(fgc, buf, len);
+  }
   while (len) {
     ssize_t nrecvd = read(fgc->pipefd[GC_READERFD], buf, len);
     if (nrecvd > 0) {
@@ -141,6 +338,10 @@ typedef struct {
   uint64_t ndocsCollected;
   // Number of numeric records removed
   uint64_t nentriesCollected;
+  // Number of blocks removed by merging them into their predecessor
+  uint32_t nblocksMerged;
+  // Number of bytes saved by merging blocks (headers and unused buffer capacity)
+  uint64_t nbytesMerged;
 
   /** Specific information about the _last_ index block */
   size_t lastblkDocsRemoved;
@@ -163,6 +364,59 @@ typedef struct {
   uint32_t _pad;   // Uninitialized reads, otherwise
 } MSG_DeletedBlock;
 
+/** Where a block of the new block list comes from, on the parent side */
+typedef struct {
+  void *ptr;       // Address of the block's buffer in the parent
+  uint32_t oldix;  // Position of the block in the parent's index
+  bool modified;   // Whether the parent needs the new content of the block
+} BlockOrigin;
+
+static int cmpDeletedBlocks(const void *a, const void *b) {
+  const MSG_DeletedBlock *da = a, *db = b;
+  return da->oldix < db->oldix ? -1 : da->oldix > db->oldix;
+}
+
+/**
+ * Coalesce adjacent underfilled blocks of the new block list, as long as the merged block does not
+ * exceed the number of entries the writer puts in a block. The blocks merged into their
+ * predecessor are reported as deleted, and the predecessor as modified.
+ * The last block of the index is never merged, since the parent may still be appending to it.
+ */
+static void FGC_childMergeBlocks(InvertedIndex *idx, IndexBlock *blocklist, BlockOrigin *origins,
+                                 MSG_DeletedBlock **deleted, MSG_IndexInfo *ixmsg) {
+  uint16_t blockCap = InvertedIndex_BlockCapacity(idx->flags);
+  uint32_t lastix = idx->size - 1;
+  size_t n = array_len(blocklist);
+  size_t out = 0;
+  for (size_t i = 0; i < n; ++i) {
+    IndexBlock *src = blocklist + i;
+    if (out > 0 && origins[i].oldix != lastix) {
+      IndexBlock *dst = blocklist + out - 1;
+      size_t capBefore = dst->buf.cap + src->buf.cap;
+      if (dst->numEntries + src->numEntries <= blockCap &&
+          IndexBlock_Merge(dst, src, idx->flags)) {
+        if (origins[i].modified) {
+          // The repaired buffer only lives in the child
+          indexBlock_Free(src);
+        }
+        origins[out - 1].modified = true;
+        MSG_DeletedBlock *delmsg = array_ensure_tail(deleted, MSG_DeletedBlock);
+        *delmsg = (MSG_DeletedBlock){.ptr = origins[i].ptr, .oldix = origins[i].oldix};
+        ixmsg->nblocksMerged++;
+        ixmsg->nbytesMerged += capBefore + sizeof(IndexBlock) - dst->buf.cap;
+        continue;
+      }
+    }
+    blocklist[out] = *src;
+    origins[out] = origins[i];
+    out++;
+  }
+  array_trimm(blocklist, out, ARR_CAP_NOSHRINK);
+  array_trimm(origins, out, ARR_CAP_NOSHRINK);
+  // checkLastBlock() in the parent relies on the blocks being ordered by their old position
+  qsort(*deleted, array_len(*deleted), sizeof(**deleted), cmpDeletedBlocks);
+}
+
 /**
  * headerCallback and hdrarg are invoked before the inverted index is sent, only
  * iff the inverted index was repaired.
@@ -172,9 +426,10 @@ typedef struct {
 static bool FGC_childRepairInvidx(ForkGC *gc, RedisSearchCtx *sctx, InvertedIndex *idx,
                                   void (*headerCallback)(ForkGC *, void *), void *hdrarg,
                                   IndexRepairParams *params) {
-  MSG_RepairedBlock *fixed = array_new(MSG_RepairedBlock, 10);
+  MSG_RepairedBlock *fixed = NULL;
   MSG_DeletedBlock *deleted = array_new(MSG_DeletedBlock, 10);
   IndexBlock *blocklist = array_new(IndexBlock, idx->size);
+  BlockOrigin *origins = array_new(BlockOrigin, idx->size);
   MSG_IndexInfo ixmsg = {.nblocksOrig = idx->size};
   IndexRepairParams params_s = {0};
   bool rv = false;
@@ -188,17 +443,19 @@ static bool FGC_childRepairInvidx(ForkGC *gc, RedisSearchCtx *sctx, InvertedInde
     params->bytesAfterFix = 0;
     params->entriesCollected = 0;
     IndexBlock *blk = idx->blocks + i;
+    // Capture the pointer address before the block is cleared; otherwise
+    // the pointer might be freed!
+    void *bufptr = blk->buf.data;
+    BlockOrigin origin = {.ptr = bufptr, .oldix = i, .modified = false};
     if (blk->lastId - blk->firstId > UINT32_MAX) {
       // Skip over blocks which have a wide variation. In the future we might
       // want to split a block into two (or more) on high-delta boundaries.
       // todo: is it ok??
       blocklist = array_append(blocklist, *blk);
+      origins = array_append(origins, origin);
       continue;
     }
 
-    // Capture the pointer address before the block is cleared; otherwise
-    // the pointer might be freed!
-    void *bufptr = blk->buf.data;
     int nrepaired = IndexBlock_Repair(blk, &sctx->spec->docs, idx->flags, params);
     // We couldn't repair the block - return 0
     if (nrepaired == -1) {
@@ -206,6 +463,7 @@ static bool FGC_childRepairInvidx(ForkGC *gc, RedisSearchCtx *sctx, InvertedInde
     } else if (nrepaired == 0) {
       // unmodified block
       blocklist = array_append(blocklist, *blk);
+      origins = array_append(origins, origin);
       continue;
     }
 
@@ -215,11 +473,8 @@ static bool FGC_childRepairInvidx(ForkGC *gc, RedisSearchCtx *sctx, InvertedInde
       *delmsg = (MSG_DeletedBlock){.ptr = bufptr, .oldix = i};
     } else {
       blocklist = array_append(blocklist, *blk);
-      MSG_RepairedBlock *fixmsg = array_ensure_tail(&fixed, MSG_RepairedBlock);
-      fixmsg->newix = array_len(blocklist) - 1;
-      fixmsg->oldix = i;
-      fixmsg->blk = *blk;
-      ixmsg.nblocksRepaired++;
+      origin.modified = true;
+      origins = array_append(origins, origin);
     }
 
     ixmsg.nbytesCollected += (params->bytesBeforFix - params->bytesAfterFix);
@@ -233,6 +488,17 @@ static bool FGC_childRepairInvidx(ForkGC *gc, RedisSearchCtx *sctx, InvertedInde
     }
   }
 
+  FGC_childMergeBlocks(idx, blocklist, origins, &deleted, &ixmsg);
+
+  fixed = array_new(MSG_RepairedBlock, 10);
+  for (size_t i = 0; i < array_len(blocklist); ++i) {
+    if (origins[i].modified) {
+      MSG_RepairedBlock *fixmsg = array_ensure_tail(&fixed, MSG_RepairedBlock);
+      *fixmsg = (MSG_RepairedBlock){.blk = blocklist[i], .oldix = origins[i].oldix, .newix = i};
+    }
+  }
+  ixmsg.nblocksRepaired = array_len(fixed);
+
   if (array_len(fixed) == 0 && array_len(deleted) == 0) {
     // No blocks were removed or repaired
     goto done;
@@ -261,6 +527,7 @@ static bool FGC_childRepairInvidx(ForkGC *gc, RedisSearchCtx *sctx, InvertedInde
 done:
   array_free(fixed);
   array_free(blocklist);
+  array_free(origins);
   array_free(deleted);
   return rv;
 }
@@ -284,6 +551,7 @@ static void FGC_childCollectTerms(ForkGC *gc, RedisSearchCtx *sctx) {
     if (idx) {
       struct iovec iov = {.iov_base = (void *)term, termLen};
       FGC_childRepairInvidx(gc, sctx, idx, sendHeaderString, &iov, NULL);
+      FGC_flush(gc);
     }
     if (idxKey) {
       RedisModule_CloseKey(idxKey);
@@ -301,6 +569,8 @@ KHASH_MAP_INIT_INT64(cardvals, size_t)
 typedef struct {
   int collectIdx;
   khash_t(cardvals) * cardVals;
+  // Number of entries left in the range after the repair
+  size_t numRemaining;
 } numCbCtx;
 
 typedef union {
@@ -310,6 +580,7 @@ typedef union {
 
 static void countRemain(const RSIndexResult *r, const IndexBlock *blk, void *arg) {
   numCbCtx *ctx = arg;
+  ctx->numRemaining++;
 
   // check cardinality every 10 elements
   if (--ctx->collectIdx != 0) {
@@ -343,13 +614,17 @@ typedef struct {
   int sentFieldName;
 } tagNumHeader;
 
-static void sendNumericTagHeader(ForkGC *fgc, void *arg) {
-  tagNumHeader *info = arg;
+static void sendNumericTagFieldHeader(ForkGC *fgc, tagNumHeader *info) {
   if (!info->sentFieldName) {
     info->sentFieldName = 1;
     FGC_sendBuffer(fgc, info->field, strlen(info->field));
     FGC_sendFixed(fgc, &info->uniqueId, sizeof info->uniqueId);
   }
+}
+
+static void sendNumericTagHeader(ForkGC *fgc, void *arg) {
+  tagNumHeader *info = arg;
+  sendNumericTagFieldHeader(fgc, info);
   FGC_SEND_VAR(fgc, info->curPtr);
   if (info->type == RSFLDTYPE_TAG) {
     FGC_sendBuffer(fgc, info->tagValue, info->tagLen);
@@ -404,6 +679,114 @@ static void sendKht(ForkGC *gc, const khash_t(cardvals) * kh) {
   RS_LOG_ASSERT(nsent == n, "Not all hashes has been sent");
 }
 
+typedef enum {
+  NUMERIC_REBALANCE_MERGE,  // collapse the two leaves under the node into one
+  NUMERIC_REBALANCE_SPLIT,  // split the leaf at the given value
+} NumericRebalanceOp;
+
+/** A change to the shape of a numeric tree, planned by the child and applied by the parent */
+typedef struct {
+  NumericRangeNode *node;
+  double split;
+  uint32_t op;
+  uint32_t _pad;
+} MSG_NumericRebalance;
+
+/** What the child learned about a leaf while repairing it */
+typedef struct {
+  const NumericRangeNode *node;
+  size_t numEntries;  // entries left after the repair
+  double median;      // sampled median of the remaining values
+  bool hasMedian;     // whether the median splits the leaf into two non-empty leaves
+  bool repaired;      // whether the leaf lost entries in this run
+} NumLeafStats;
+
+static int cmpCardinalityValues(const void *a, const void *b) {
+  const CardinalityValue *ca = a, *cb = b;
+  return ca->value < cb->value ? -1 : ca->value > cb->value;
+}
+
+static int cmpLeafStats(const void *a, const void *b) {
+  const NumLeafStats *la = a, *lb = b;
+  return la->node < lb->node ? -1 : la->node > lb->node;
+}
+
+/**
+ * Find the median of the values sampled by countRemain. The median is moved up to the next
+ * distinct value if it is the smallest one, so splitting at it leaves values on both sides.
+ */
+static bool sampledMedian(const khash_t(cardvals) * kh, double *median) {
+  if (!kh || kh_size(kh) < 2) {
+    return false;
+  }
+
+  CardinalityValue *vals = array_new(CardinalityValue, kh_size(kh));
+  size_t total = 0;
+  for (khiter_t it = kh_begin(kh); it != kh_end(kh); ++it) {
+    if (!kh_exist(kh, it)) {
+      continue;
+    }
+    numUnion u = {kh_key(kh, it)};
+    CardinalityValue cv = {.value = u.d48, .appearances = kh_val(kh, it)};
+    vals = array_append(vals, cv);
+    total += cv.appearances;
+  }
+  qsort(vals, array_len(vals), sizeof(*vals), cmpCardinalityValues);
+
+  size_t ix = 0, seen = 0;
+  for (; ix < array_len(vals) - 1; ++ix) {
+    seen += vals[ix].appearances;
+    if (seen * 2 >= total) {
+      break;
+    }
+  }
+  *median = vals[ix == 0 ? 1 : ix].value;
+  array_free(vals);
+  return true;
+}
+
+/**
+ * Walk the tree and plan the changes the parent should apply to keep its leaves evenly sized:
+ * sibling leaves that shrank below NR_MINRANGE_SIZE entries together are merged back, and leaves
+ * holding more than NR_MAXRANGE_SIZE entries are re-split at their median.
+ * NumericRangeNode_Add only splits a large leaf when an entry is added to it and its sampled
+ * cardinality is above 1. A skewed leaf whose samples all hold the same value, or a large half
+ * of a split which receives no more entries, is only split here.
+ */
+static void planNumericRebalance(const NumericRangeNode *n, const NumLeafStats *stats,
+                                 arrayof(MSG_NumericRebalance) *plan) {
+  NumLeafStats key = {.node = n};
+  if (NumericRangeNode_IsLeaf(n)) {
+    const NumLeafStats *st =
+        bsearch(&key, stats, array_len(stats), sizeof(*stats), cmpLeafStats);
+    if (st && st->hasMedian && st->numEntries > NR_MAXRANGE_SIZE) {
+      MSG_NumericRebalance *msg = array_ensure_tail(plan, MSG_NumericRebalance);
+      *msg = (MSG_NumericRebalance){.node = (NumericRangeNode *)n,
+                                    .split = st->median,
+                                    .op = NUMERIC_REBALANCE_SPLIT};
+    }
+    return;
+  }
+
+  if (NumericRangeNode_IsLeaf(n->left) && NumericRangeNode_IsLeaf(n->right)) {
+    key.node = n->left;
+    const NumLeafStats *l = bsearch(&key, stats, array_len(stats), sizeof(*stats), cmpLeafStats);
+    key.node = n->right;
+    const NumLeafStats *r = bsearch(&key, stats, array_len(stats), sizeof(*stats), cmpLeafStats);
+    // Only merge leaves that lost entries, so a tree which is still growing keeps its splits
+    if (l && r && (l->repaired || r->repaired) &&
+        l->numEntries + r->numEntries < NR_MINRANGE_SIZE) {
+      MSG_NumericRebalance *msg = array_ensure_tail(plan, MSG_NumericRebalance);
+      *msg = (MSG_NumericRebalance){.node = (NumericRangeNode *)n,
+                                    .op = NUMERIC_REBALANCE_MERGE};
+      return;
+    }
+  }
+
+  planNumericRebalance(n->left, stats, plan);
+  planNumericRebalance(n->right, stats, plan);
+}
+
 static void FGC_childCollectNumeric(ForkGC *gc, RedisSearchCtx *sctx) {
   RedisModuleKey *idxKey = NULL;
   arrayof(FieldSpec*) numericFields = getFieldsByType(sctx->spec, INDEXFLD_T_NUMERIC | INDEXFLD_T_GEO);
@@ -418,6 +801,8 @@ static void FGC_childCollectNumeric(ForkGC *gc, RedisSearchCtx *sctx) {
     tagNumHeader header = {.type = RSFLDTYPE_NUMERIC,
                            .field = numericFields[i]->name,
                            .uniqueId = rt->uniqueId};
+    arrayof(NumLeafStats) leaves = array_new(NumLeafStats, rt->numRanges);
+    arrayof(MSG_NumericRebalance) plan = array_new(MSG_NumericRebalance, 1);
 
     while ((currNode = NumericRangeTreeIterator_Next(gcIterator))) {
       if (!currNode->range) {
@@ -431,19 +816,40 @@ static void FGC_childCollectNumeric(ForkGC *gc, RedisSearchCtx *sctx) {
 
       if (repaired) {
         sendKht(gc, nctx.cardVals);
+        FGC_flush(gc);
+      }
+      if (NumericRangeNode_IsLeaf(currNode)) {
+        NumLeafStats *st = array_ensure_tail(&leaves, NumLeafStats);
+        *st = (NumLeafStats){.node = currNode,
+                             .numEntries = nctx.numRemaining,
+                             .repaired = repaired};
+        st->hasMedian = sampledMedian(nctx.cardVals, &st->median);
       }
       if (nctx.cardVals) {
         kh_destroy(cardvals, nctx.cardVals);
       }
     }
 
+    if (gc->cleanNumericEmptyNodes) {
+      qsort(leaves, array_len(leaves), sizeof(*leaves), cmpLeafStats);
+      planNumericRebalance(rt->root, leaves, &plan);
+      if (array_len(plan)) {
+        sendNumericTagFieldHeader(gc, &header);
+      }
+    }
+
     if (header.sentFieldName) {
       // If we've repaired at least one entry, send the terminator;
       // note that "terminator" just means a zero address and not the
       // "no more strings" terminator in FGC_sendTerminator
       void *pdummy = NULL;
       FGC_SEND_VAR(gc, pdummy);
+      // followed by the changes to the shape of the tree, if any
+      FGC_sendBuffer(gc, plan, array_len(plan) * sizeof(*plan));
+      FGC_flush(gc);
     }
+    array_free(leaves);
+    array_free(plan);
 
     if (idxKey) {
       RedisModule_CloseKey(idxKey);
@@ -482,12 +888,14 @@ static void FGC_childCollectTags(ForkGC *gc, RedisSearchCtx *sctx) {
         header.tagLen = len;
         // send repaired data
         FGC_childRepairInvidx(gc, sctx, value, sendNumericTagHeader, &header, NULL);
+        FGC_flush(gc);
       }
 
       // we are done with the current field
       if (header.sentFieldName) {
         void *pdummy = NULL;
         FGC_SEND_VAR(gc, pdummy);
+        FGC_flush(gc);
       }
 
       if (idxKey) {
@@ -708,6 +1116,8 @@ static void FGC_applyInvertedIndex(ForkGC *gc, InvIdxBuffers *idxData, MSG_Index
 
   idx->numDocs -= info->ndocsCollected;
   idx->gcMarker++;
+  gc->stats.gcBlocksMerged += info->nblocksMerged;
+  gc->stats.gcBytesMerged += info->nbytesMerged;
 }
 
 static FGCError FGC_parentHandleTerms(ForkGC *gc) {
@@ -877,6 +1287,63 @@ static void applyNumIdx(ForkGC *gc, RedisSearchCtx *sctx, NumGcInfo *ninfo) {
   resetCardinality(ninfo, currNode);
 }
 
+static FGCError applyNumRebalance(ForkGC *gc, const char *fieldName, uint64_t rtUniqueId,
+                                  const MSG_NumericRebalance *plan, size_t nplan) {
+  StrongRef spec_ref = WeakRef_Promote(gc->index);
+  IndexSpec *sp = StrongRef_Get(spec_ref);
+  if (!sp) {
+    return FGC_SPEC_DELETED;
+  }
+  RedisSearchCtx sctx = SEARCH_CTX_STATIC(gc->ctx, sp);
+  RedisModuleKey *idxKey = NULL;
+  FGCError status = FGC_COLLECTED;
+
+  RedisSearchCtx_LockSpecWrite(&sctx);
+
+  RedisModuleString *keyName = IndexSpec_GetFormattedKeyByName(sp, fieldName, INDEXFLD_T_NUMERIC);
+  NumericRangeTree *rt = OpenNumericIndex(&sctx, keyName, &idxKey);
+  if (!rt || rt->uniqueId != rtUniqueId) {
+    status = FGC_PARENT_ERROR;
+    goto done;
+  }
+
+  // The tree may have changed since the fork; each operation checks that the node still has
+  // the shape it had in the child and is skipped otherwise
+  NRN_AddRv rv = {0};
+  for (size_t i = 0; i < nplan; ++i) {
+    switch (plan[i].op) {
+      case NUMERIC_REBALANCE_MERGE:
+        NumericRangeNode_MergeLeaves(plan[i].node, &rv);
+        break;
+      case NUMERIC_REBALANCE_SPLIT:
+        NumericRangeNode_SplitAt(plan[i].node, plan[i].split, &rv);
+        break;
+    }
+  }
+
+  if (rv.changed) {
+    NumericRangeNode_UpdateDepth(rt->root, &rv);
+    rt->numRanges += rv.numRanges;
+    if (rv.emptyLeaves < 0 && (size_t)-rv.emptyLeaves > rt->emptyLeaves) {
+      rt->emptyLeaves = 0;
+    } else {
+      rt->emptyLeaves += rv.emptyLeaves;
+    }
+    // ranges were freed, running iterators must not touch them anymore
+    rt->revisionId++;
+    sp->stats.invertedSize += rv.sz;
+    sp->stats.numRecords += rv.numRecords;
+  }
+
+done:
+  if (idxKey) {
+    RedisModule_CloseKey(idxKey);
+  }
+  RedisSearchCtx_UnlockSpec(&sctx);
+  StrongRef_Release(spec_ref);
+  return status;
+}
+
 static FGCError FGC_parentHandleNumeric(ForkGC *gc) {
   size_t fieldNameLen;
   char *fieldName = NULL;
@@ -944,6 +1411,18 @@ static FGCError FGC_parentHandleNumeric(ForkGC *gc) {
     }
   }
 
+  if (status == FGC_COLLECTED) {
+    // all the nodes were received, the rebalance plan of the tree follows
+    MSG_NumericRebalance *plan = NULL;
+    size_t planLen = 0;
+    if (FGC_recvBuffer(gc, (void **)&plan, &planLen) != REDISMODULE_OK) {
+      status = FGC_CHILD_ERROR;
+    } else if (plan) {
+      status = applyNumRebalance(gc, fieldName, rtUniqueId, plan, planLen / sizeof(*plan));
+      rm_free(plan);
+    }
+  }
+
   rm_free(fieldName);
 
   if (rt && rt->emptyLeaves >= rt->numRanges / 2) {
@@ -1098,10 +1577,15 @@ static int periodicCb(RedisModuleCtx *ctx, void *privdata) {
   ForkGC *gc = privdata;
 
   StrongRef early_check = WeakRef_Promote(gc->index);
-  if (!StrongRef_Get(early_check)) {
+  IndexSpec *sp = StrongRef_Get(early_check);
+  if (!sp) {
     // Index was deleted
     return 0;
   }
+  if (sp->flags & Index_HasGeometry) {
+    // Geometry indexes are updated in place, pack them again once they changed enough
+    GeometryIndex_Repack(ctx, sp, false);
+  }
   StrongRef_Release(early_check);
 
   if (gc->deletedDocsFromLastRun < RSGlobalConfig.gcConfigParams.forkGc.forkGcCleanThreshold) {
@@ -1125,6 +1609,8 @@ static int periodicCb(RedisModuleCtx *ctx, void *privdata) {
   if (rc == -1) {
     return 1;
   }
+  // The shared memory must exist before forking, so the child inherits the mapping
+  FGC_arenaCreate(gc);
 
   // We need to acquire the GIL to use the fork api
   RedisModule_ThreadSafeContextLock(ctx);
@@ -1140,6 +1626,7 @@ static int periodicCb(RedisModuleCtx *ctx, void *privdata) {
 
     close(gc->pipefd[GC_READERFD]);
     close(gc->pipefd[GC_WRITERFD]);
+    FGC_arenaDestroy(gc);
 
     return 1;
   }
@@ -1155,6 +1642,11 @@ static int periodicCb(RedisModuleCtx *ctx, void *privdata) {
     setpriority(PRIO_PROCESS, getpid(), 19);
     // fork process
     close(gc->pipefd[GC_READERFD]);
+    FGC_arenaAfterFork(gc, true);
+    if (gc->arena.base) {
+      // The pipe only carries wakeups, never block on it
+      fcntl(gc->pipefd[GC_WRITERFD], F_SETFL, O_NONBLOCK);
+    }
 #ifdef __linux__
     if (!FGC_haveRedisFork()) {
       // set the parrent death signal to SIGTERM
@@ -1174,6 +1666,7 @@ static int periodicCb(RedisModuleCtx *ctx, void *privdata) {
   } else {
     // main process
     close(gc->pipefd[GC_WRITERFD]);
+    FGC_arenaAfterFork(gc, false);
     while (gc->pauseState == FGC_PAUSED_PARENT) {
       gc->execState = FGC_STATE_WAIT_APPLY;
       // spin
@@ -1185,6 +1678,11 @@ static int periodicCb(RedisModuleCtx *ctx, void *privdata) {
     if (FGC_parentHandleFromChild(gc) == FGC_SPEC_DELETED) {
       gcrv = 0;
     }
+    if (gc->arena.base) {
+      // Release a child that may be waiting for room in the ring
+      __atomic_store_n(&FGC_ARENA_HDR(&gc->arena)->parentDone, 1, __ATOMIC_SEQ_CST);
+      FGC_arenaRelease(&gc->arena);
+    }
     close(gc->pipefd[GC_READERFD]);
     if (FGC_haveRedisFork()) {
       // We need to acquire the GIL to use the fork api
@@ -1203,6 +1701,7 @@ static int periodicCb(RedisModuleCtx *ctx, void *privdata) {
         printf("an error acquire when waiting for fork to terminate, pid:%d", cpid);
       }
     }
+    FGC_arenaDestroy(gc);
 #ifdef MT_BUILD
     VecSim_CallTieredIndexesGC(gc->tieredIndexes, gc->index);
 #endif
@@ -1274,6 +1773,8 @@ static void statsCb(RedisModule_Reply *reply, void *gcCtx) {
   REPLY_KVNUM("last_run_time_ms", (double)gc->stats.lastRunTimeMs);
   REPLY_KVNUM("gc_numeric_trees_missed", (double)gc->stats.gcNumericNodesMissed);
   REPLY_KVNUM("gc_blocks_denied", (double)gc->stats.gcBlocksDenied);
+  REPLY_KVNUM("gc_blocks_merged", (double)gc->stats.gcBlocksMerged);
+  REPLY_KVNUM("gc_bytes_merged", (double)gc->stats.gcBytesMerged);
 }
 
 #ifdef FTINFO_FOR_INFO_MODULES
@@ -1287,6 +1788,8 @@ static void statsForInfoCb(RedisModuleInfoCtx *ctx, void *gcCtx) {
   RedisModule_InfoAddFieldDouble(ctx, "last_run_time_ms", (double)gc->stats.lastRunTimeMs);
   RedisModule_InfoAddFieldDouble(ctx, "gc_numeric_trees_missed", (double)gc->stats.gcNumericNodesMissed);
   RedisModule_InfoAddFieldDouble(ctx, "gc_blocks_denied", (double)gc->stats.gcBlocksDenied);
+  RedisModule_InfoAddFieldDouble(ctx, "gc_blocks_merged", (double)gc->stats.gcBlocksMerged);
+  RedisModule_InfoAddFieldDouble(ctx, "gc_bytes_merged", (double)gc->stats.gcBytesMerged);
   RedisModule_InfoEndDictField(ctx);
 }
 #endif
@@ -27,8 +27,26 @@ typedef struct {
 
   uint64_t gcNumericNodesMissed;
   uint64_t gcBlocksDenied;
+  // number of blocks removed by merging underfilled blocks, and the memory it saved
+  uint64_t gcBlocksMerged;
+  uint64_t gcBytesMerged;
 } ForkGCStats;
 
+/* Shared memory ring used to move the repaired index data from the child to the parent.
+ * When it is available the pipe is only used to wake up the parent. */
+typedef struct {
+  // anonymous shared mapping created before forking, NULL when the pipe is used for data
+  void *base;
+  // capacity of the data ring, in bytes
+  size_t size;
+  // local write position (child) or read position (parent)
+  size_t pos;
+  // write position at which the child last woke up the parent
+  size_t flushed;
+  // pipe used by the parent to wake up the child once it made room in the full ring
+  int releasefd[2];
+} ForkGCArena;
+
 /* Internal definition of the garbage collector context (each index has one) */
 typedef struct ForkGC {
 
@@ -41,6 +59,7 @@ typedef struct ForkGC {
   ForkGCStats stats;
 
   int pipefd[2];
+  ForkGCArena arena;
   volatile uint32_t pauseState;
   volatile uint32_t execState;
 
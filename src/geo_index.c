@@ -63,7 +63,7 @@ int GeoFilter_Parse(GeoFilter *gf, ArgsCursor *ac, QueryError *status) {
 void GeoFilter_Free(GeoFilter *gf) {
   if (gf->property) rm_free((char *)gf->property);
   if (gf->numericFilters) {
-    for (int i = 0; i < GEO_RANGE_COUNT; ++i) {
+    for (int i = 0; i < GEO_MAX_RANGES; ++i) {
       if (gf->numericFilters[i])
         NumericFilter_Free(gf->numericFilters[i]);
     }
@@ -72,45 +72,6 @@ void GeoFilter_Free(GeoFilter *gf) {
   rm_free(gf);
 }
 
-static t_docId *geoRangeLoad(const GeoIndex *gi, const GeoFilter *gf, size_t *num) {
-  *num = 0;
-  t_docId *docIds = NULL;
-  RedisModuleString *s = IndexSpec_GetFormattedKey(gi->ctx->spec, gi->sp, INDEXFLD_T_GEO);
-  RS_LOG_ASSERT(s, "failed to retrive key");
-  /*GEORADIUS key longitude latitude radius m|km|ft|mi */
-  RedisModuleCtx *ctx = gi->ctx->redisCtx;
-  RedisModuleString *slon = RedisModule_CreateStringPrintf(ctx, "%f", gf->lon);
-  RedisModuleString *slat = RedisModule_CreateStringPrintf(ctx, "%f", gf->lat);
-  RedisModuleString *srad = RedisModule_CreateStringPrintf(ctx, "%f", gf->radius);
-  const char *unitstr = GeoDistance_ToString(gf->unitType);
-  RedisModuleCallReply *rep =
-      RedisModule_Call(ctx, "GEORADIUS", "ssssc", s, slon, slat, srad, unitstr);
-  if (rep == NULL || RedisModule_CallReplyType(rep) != REDISMODULE_REPLY_ARRAY) {
-    goto done;
-  }
-
-  size_t sz = RedisModule_CallReplyLength(rep);
-  docIds = rm_calloc(sz, sizeof(t_docId));
-  for (size_t i = 0; i < sz; i++) {
-    const char *s = RedisModule_CallReplyStringPtr(RedisModule_CallReplyArrayElement(rep, i), NULL);
-    if (!s) continue;
-
-    docIds[i] = (t_docId)atol(s);
-  }
-
-  *num = sz;
-
-done:
-  RedisModule_FreeString(ctx, slon);
-  RedisModule_FreeString(ctx, slat);
-  RedisModule_FreeString(ctx, srad);
-  if (rep) {
-    RedisModule_FreeCallReply(rep);
-  }
-
-  return docIds;
-}
-
 IndexIterator *NewGeoRangeIterator(RedisSearchCtx *ctx, const GeoFilter *gf, IteratorsConfig *config) {
   // check input parameters are valid
   if (gf->radius <= 0 ||
@@ -119,23 +80,24 @@ IndexIterator *NewGeoRangeIterator(RedisSearchCtx *ctx, const GeoFilter *gf, Ite
     return NULL;
   }
 
-  GeoHashRange ranges[GEO_RANGE_COUNT] = {{0}};
+  GeoCoverRange ranges[GEO_MAX_RANGES] = {{{0}}};
   double radius_meter = gf->radius * extractUnitFactor(gf->unitType);
-  calcRanges(gf->lon, gf->lat, radius_meter, ranges);
+  size_t rangesCount = calcCoverRanges(gf->lon, gf->lat, radius_meter, ranges);
 
-  IndexIterator **iters = rm_calloc(GEO_RANGE_COUNT, sizeof(*iters));
-  ((GeoFilter *)gf)->numericFilters = rm_calloc(GEO_RANGE_COUNT, sizeof(*gf->numericFilters));
+  IndexIterator **iters = rm_calloc(GEO_MAX_RANGES, sizeof(*iters));
+  ((GeoFilter *)gf)->numericFilters = rm_calloc(GEO_MAX_RANGES, sizeof(*gf->numericFilters));
   size_t itersCount = 0;
-  for (size_t ii = 0; ii < GEO_RANGE_COUNT; ++ii) {
-    if (ranges[ii].min != ranges[ii].max) {
-      NumericFilter *filt = gf->numericFilters[ii] =
-              NewNumericFilter(ranges[ii].min, ranges[ii].max, 1, 1, true);
-      filt->fieldName = rm_strdup(gf->property);
-      filt->geoFilter = gf;
-      struct indexIterator *numIter = NewNumericFilterIterator(ctx, filt, NULL, INDEXFLD_T_GEO, config);
-      if (numIter != NULL) {
-        iters[itersCount++] = numIter;
-      }
+  for (size_t ii = 0; ii < rangesCount; ++ii) {
+    // Ranges which are within the radius only need their scores to be in range
+    bool inside = ranges[ii].inside;
+    NumericFilter *filt = gf->numericFilters[ii] =
+            NewNumericFilter(ranges[ii].range.min, ranges[ii].range.max, 1, !inside, true);
+    filt->fieldName = rm_strdup(gf->property);
+    filt->geoFilter = gf;
+    filt->geoInside = inside;
+    struct indexIterator *numIter = NewNumericFilterIterator(ctx, filt, NULL, INDEXFLD_T_GEO, config);
+    if (numIter != NULL) {
+      iters[itersCount++] = numIter;
     }
   }
 
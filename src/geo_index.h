@@ -17,13 +17,6 @@
 #include "numeric_index.h"
 #include "query_node.h"
 
-typedef struct geoIndex {
-  RedisSearchCtx *ctx;
-  const FieldSpec *sp;
-} GeoIndex;
-
-#define GEOINDEX_KEY_FMT "geo:%s/%s"
-
 typedef enum {  // Placeholder for bad/invalid unit
   GEO_DISTANCE_INVALID = -1,
 #define X_GEO_DISTANCE(X) \
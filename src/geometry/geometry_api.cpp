@@ -54,6 +54,19 @@ namespace {
   int Index_##variant##_Remove(GeometryIndex *idx, t_docId id) {                            \
     return std::get<rtree_ptr<variant>>(idx->index)->remove(id);                            \
   }                                                                                         \
+  void *Index_##variant##_RepackBegin(GeometryIndex *idx, bool force) {                     \
+    return std::get<rtree_ptr<variant>>(idx->index)->repack_begin(force);                   \
+  }                                                                                         \
+  void Index_##variant##_RepackBuild(void *repack) {                                        \
+    RTree<variant>::repack_build(static_cast<RTree<variant>::repack_state *>(repack));      \
+  }                                                                                         \
+  void Index_##variant##_RepackCommit(GeometryIndex *idx, void *repack) {                   \
+    std::get<rtree_ptr<variant>>(idx->index)                                                \
+        ->repack_commit(static_cast<RTree<variant>::repack_state *>(repack));               \
+  }                                                                                         \
+  void Index_##variant##_RepackFree(void *repack) {                                         \
+    RTree<variant>::repack_free(static_cast<RTree<variant>::repack_state *>(repack));       \
+  }                                                                                         \
   auto Index_##variant##_Query(const GeometryIndex *idx, QueryType query_type,              \
                                GEOMETRY_FORMAT format, const char *str, std::size_t len,    \
                                RedisModuleString **err_msg)                                 \
@@ -77,6 +90,10 @@ namespace {
       .freeIndex = Index_##variant##_Free,                                                  \
       .addGeomStr = Index_##variant##_Insert,                                               \
       .delGeom = Index_##variant##_Remove,                                                  \
+      .repackBegin = Index_##variant##_RepackBegin,                                         \
+      .repackBuild = Index_##variant##_RepackBuild,                                         \
+      .repackCommit = Index_##variant##_RepackCommit,                                       \
+      .repackFree = Index_##variant##_RepackFree,                                           \
       .query = Index_##variant##_Query,                                                     \
       .dump = Index_##variant##_Dump,                                                       \
       .report = Index_##variant##_Report,                                                   \
@@ -24,6 +24,16 @@ struct GeometryApi {
   int (*addGeomStr)(GeometryIndex *index, GEOMETRY_FORMAT format, const char *str, size_t len,
                     t_docId docId, RedisModuleString **err_msg);
   int (*delGeom)(GeometryIndex *index, t_docId docId);
+  // Packing rebuilds the index by bulk loading its docs. Take a snapshot of the docs, with the
+  // index locked for read, if it changed enough since it was last packed or if `force` is set.
+  // Returns NULL if there is nothing to pack
+  void *(*repackBegin)(GeometryIndex *index, bool force);
+  // Build the packed index from the snapshot, without locks
+  void (*repackBuild)(void *repack);
+  // Swap the packed index in, with the index locked for write
+  void (*repackCommit)(GeometryIndex *index, void *repack);
+  // Free the snapshot and the replaced index, without locks
+  void (*repackFree)(void *repack);
   IndexIterator *(*query)(const GeometryIndex *index, QueryType queryType, GEOMETRY_FORMAT format,
                           const char *str, size_t len, RedisModuleString **err_msg);
   void (*dump)(const GeometryIndex *index, RedisModuleCtx *ctx);
@@ -6,9 +6,10 @@
 
 #include "rtree.hpp"
 
+#include <cmath>      // std::floor, std::ceil, std::sqrt
 #include <string>     // std::string, std::char_traits
 #include <sstream>    // std::stringstream
-#include <algorithm>  // ranges::for_each, views::transform
+#include <algorithm>  // ranges::for_each, views::transform, std::clamp
 #include <exception>  // std::exception
 
 namespace RediSearch {
@@ -120,11 +121,152 @@ constexpr auto filter_results = [](auto&& geom1, auto&& geom2) -> bool {
 };
 }  // anonymous namespace
 
+/* The cells of a grid over the MBR of a flat polygon are classified once per query geometry: the
+ * cells which an edge may cross are on the boundary, and each of the other cells is entirely inside
+ * or entirely outside of the polygon. A candidate whose MBR only overlaps cells of one kind is
+ * decided without testing its geometry. */
+template <typename cs>
+struct RTree<cs>::prepared_query {
+  enum class cell : std::uint8_t { UNKNOWN, BOUNDARY, INSIDE, OUTSIDE };
+  using cells_type = std::vector<cell, Allocator::Allocator<cell>>;
+
+  geom_type geom;
+  rect_type mbr;
+  std::size_t side;  // number of cells along each axis, 0 if the geometry has no grid
+  double cell_width;
+  double cell_height;
+  cells_type cells;
+
+  explicit prepared_query(geom_type&& g)
+      : geom{std::move(g)},
+        mbr{std::visit(make_mbr<cs>, geom)},
+        side{0},
+        cell_width{0},
+        cell_height{0},
+        cells{} {
+    // Edges of the geographic coordinate system are not straight in degrees, only index flat ones
+    if constexpr (std::is_same_v<cs, Cartesian>) {
+      if (auto const* poly = std::get_if<poly_type>(&geom)) {
+        build_grid(*poly);
+      }
+    }
+  }
+
+  // The kind of all the cells which the rect overlaps, BOUNDARY if they are not all of one kind
+  [[nodiscard]] auto classify(rect_type const& rect) const -> cell {
+    auto const& min = mbr.min_corner();
+    auto const& max = mbr.max_corner();
+    auto const& lo = rect.min_corner();
+    auto const& hi = rect.max_corner();
+    if (side == 0 || bg::get<0>(lo) < bg::get<0>(min) || bg::get<1>(lo) < bg::get<1>(min) ||
+        bg::get<0>(hi) > bg::get<0>(max) || bg::get<1>(hi) > bg::get<1>(max)) {
+      return cell::BOUNDARY;
+    }
+    auto const [x0, x1] = cell_range(bg::get<0>(lo), bg::get<0>(hi), bg::get<0>(min), cell_width);
+    auto const [y0, y1] = cell_range(bg::get<1>(lo), bg::get<1>(hi), bg::get<1>(min), cell_height);
+    auto const kind = cells[y0 * side + x0];
+    for (auto y = y0; y <= y1; ++y) {
+      for (auto x = x0; x <= x1; ++x) {
+        if (cells[y * side + x] != kind) {
+          return cell::BOUNDARY;
+        }
+      }
+    }
+    return kind;
+  }
+
+ private:
+  // The cells between two coordinates, including the neighbor cell of a coordinate on a border
+  [[nodiscard]] auto cell_range(double lo, double hi, double origin, double size) const
+      -> std::pair<std::size_t, std::size_t> {
+    constexpr auto EPSILON = 1e-9;
+    auto const last = static_cast<double>(side - 1);
+    auto const first_cell = std::clamp(std::floor((lo - origin) / size - EPSILON), 0.0, last);
+    auto const last_cell = std::clamp(std::floor((hi - origin) / size + EPSILON), 0.0, last);
+    return {static_cast<std::size_t>(first_cell), static_cast<std::size_t>(last_cell)};
+  }
+
+  void build_grid(poly_type const& poly) {
+    constexpr auto MIN_SIDE = 8ul;
+    constexpr auto MAX_SIDE = 256ul;
+    auto const x_origin = bg::get<0>(mbr.min_corner());
+    auto const y_origin = bg::get<1>(mbr.min_corner());
+    auto const width = bg::get<0>(mbr.max_corner()) - x_origin;
+    auto const height = bg::get<1>(mbr.max_corner()) - y_origin;
+    if (!(width > 0 && height > 0)) {
+      return;
+    }
+
+    auto edges = poly.outer().size();
+    for (auto const& hole : poly.inners()) {
+      edges += hole.size();
+    }
+    side = std::clamp(static_cast<std::size_t>(2 * std::ceil(std::sqrt(edges))), MIN_SIDE, MAX_SIDE);
+    cell_width = width / side;
+    cell_height = height / side;
+    cells.assign(side * side, cell::UNKNOWN);
+
+    auto const mark_ring = [&](auto const& ring) -> void {
+      for (std::size_t i = 1; i < ring.size(); ++i) {
+        auto const& a = ring[i - 1];
+        auto const& b = ring[i];
+        auto const [x0, x1] = cell_range(std::min(bg::get<0>(a), bg::get<0>(b)),
+                                         std::max(bg::get<0>(a), bg::get<0>(b)), x_origin, cell_width);
+        auto const [y0, y1] = cell_range(std::min(bg::get<1>(a), bg::get<1>(b)),
+                                         std::max(bg::get<1>(a), bg::get<1>(b)), y_origin, cell_height);
+        for (auto y = y0; y <= y1; ++y) {
+          for (auto x = x0; x <= x1; ++x) {
+            cells[y * side + x] = cell::BOUNDARY;
+          }
+        }
+      }
+    };
+    mark_ring(poly.outer());
+    for (auto const& hole : poly.inners()) {
+      mark_ring(hole);
+    }
+
+    // No edge separates neighbor cells which are not on the boundary, so a connected group of
+    // them is classified by testing the center of one of its cells
+    auto stack = std::vector<std::size_t, Allocator::Allocator<std::size_t>>{};
+    for (std::size_t start = 0; start < cells.size(); ++start) {
+      if (cells[start] != cell::UNKNOWN) {
+        continue;
+      }
+      auto const center = point_type{x_origin + (start % side + 0.5) * cell_width,
+                                     y_origin + (start / side + 0.5) * cell_height};
+      auto const kind = bg::within(center, poly) ? cell::INSIDE : cell::OUTSIDE;
+      cells[start] = kind;
+      stack.push_back(start);
+      while (!stack.empty()) {
+        auto const i = stack.back();
+        stack.pop_back();
+        auto const visit = [&](std::size_t j) -> void {
+          if (cells[j] == cell::UNKNOWN) {
+            cells[j] = kind;
+            stack.push_back(j);
+          }
+        };
+        if (i % side > 0) visit(i - 1);
+        if (i % side < side - 1) visit(i + 1);
+        if (i >= side) visit(i - side);
+        if (i + side < cells.size()) visit(i + side);
+      }
+    }
+  }
+};
+
 template <typename cs>
 RTree<cs>::RTree()
     : allocated_{sizeof *this},
-      rtree_{{}, {}, {}, doc_alloc{allocated_}},
-      docLookup_{0, lookup_alloc{allocated_}} {
+      nodesAllocated_{0},
+      rtree_{{}, {}, {}, doc_alloc{nodesAllocated_}},
+      docLookup_{0, lookup_alloc{allocated_}},
+      changes_{0},
+      repacking_{nullptr},
+      repackLog_{},
+      preparedCache_{},
+      preparedNext_{0} {
 }
 
 template <typename cs>
@@ -141,9 +283,14 @@ auto RTree<cs>::lookup(doc_type const& doc) const -> boost::optional<geom_type c
 
 template <typename cs>
 void RTree<cs>::insert(geom_type const& geom, t_docId id) {
+  auto doc = make_doc<cs>(geom, id);
   docLookup_.insert(lookup_type{id, geom});
-  rtree_.insert(make_doc<cs>(geom, id));
+  rtree_.insert(doc);
   allocated_ += std::visit(geometry_reporter<cs>, geom);
+  ++changes_;
+  if (repacking_.load(std::memory_order_relaxed)) {
+    repackLog_.emplace_back(doc, true);
+  }
 }
 
 template <typename cs>
@@ -162,14 +309,101 @@ int RTree<cs>::insertWKT(std::string_view wkt, t_docId id, RedisModuleString** e
 template <typename cs>
 bool RTree<cs>::remove(t_docId id) {
   if (auto geom = lookup(id); geom.has_value()) {
+    auto doc = make_doc<cs>(*geom, id);
     allocated_ -= std::visit(geometry_reporter<cs>, *geom);
-    rtree_.remove(make_doc<cs>(*geom, id));
+    rtree_.remove(doc);
     docLookup_.erase(id);
+    ++changes_;
+    if (repacking_.load(std::memory_order_relaxed)) {
+      repackLog_.emplace_back(doc, false);
+    }
     return true;
   }
   return false;
 }
 
+template <typename cs>
+struct RTree<cs>::repack_state {
+  std::vector<doc_type, Allocator::Allocator<doc_type>> docs;
+  std::size_t allocated;  // the memory of the nodes of `packed`
+  // The packed tree, and the replaced one once it is swapped in
+  std::optional<rtree_type> packed;
+
+  void* operator new(std::size_t) noexcept {
+    using alloc_type = RediSearch::Allocator::Allocator<repack_state>;
+    return static_cast<void*>(alloc_type::allocate(1));
+  }
+  void operator delete(void* p) noexcept {
+    using alloc_type = RediSearch::Allocator::Allocator<repack_state>;
+    alloc_type::deallocate(static_cast<repack_state*>(p), 1);
+  }
+};
+
+/* Packing rebuilds the tree by bulk loading all of its docs. The packing algorithm sorts and tiles
+ * the docs so that the nodes are full and overlap far less than the ones built by single inserts.
+ * Unless forced, the tree is only packed once the inserts and removals since it was last packed
+ * amount to a good part of its size.
+ * The docs are copied with the tree locked for read, and the packed tree is built from the copy
+ * without any lock. The inserts and removals made meanwhile are logged, and replayed on the packed
+ * tree as it is swapped in with the tree locked for write. A tree is packed by one caller at a
+ * time, the others get no state. */
+template <typename cs>
+auto RTree<cs>::repack_begin(bool force) -> repack_state* {
+  constexpr auto MIN_CHANGES = 1024ul;
+  constexpr auto CHANGES_RATIO = 4ul;
+  if (changes_ == 0 ||
+      (!force && changes_ < std::max(MIN_CHANGES, rtree_.size() / CHANGES_RATIO))) {
+    return nullptr;
+  }
+  auto state = new repack_state{{}, 0, std::nullopt};
+  auto expected = static_cast<repack_state*>(nullptr);
+  if (!state || !repacking_.compare_exchange_strong(expected, state)) {
+    delete state;
+    return nullptr;
+  }
+  state->docs.assign(rtree_.begin(), rtree_.end());
+  repackLog_.clear();
+  return state;
+}
+
+template <typename cs>
+void RTree<cs>::repack_build(repack_state* state) {
+  auto const& docs = state->docs;
+  state->packed.emplace(docs.begin(), docs.end(), typename rtree_type::parameters_type{},
+                        typename rtree_type::indexable_getter{}, typename rtree_type::value_equal{},
+                        doc_alloc{state->allocated});
+  state->docs.clear();
+  state->docs.shrink_to_fit();
+}
+
+template <typename cs>
+void RTree<cs>::repack_commit(repack_state* state) {
+  if (repacking_.load() != state) {
+    return;
+  }
+  auto& packed = *state->packed;
+  for (auto const& change : repackLog_) {
+    if (change.second) {
+      packed.insert(change.first);
+    } else {
+      packed.remove(change.first);
+    }
+  }
+  // The allocators are not swapped along with the nodes, so neither are the trackers they update
+  rtree_.swap(packed);
+  std::swap(nodesAllocated_, state->allocated);
+  changes_ = repackLog_.size();
+  repackLog_.clear();
+  repackLog_.shrink_to_fit();
+  repacking_.store(nullptr);
+}
+
+// Free the snapshot and the replaced tree, or the packed one if it was not swapped in
+template <typename cs>
+void RTree<cs>::repack_free(repack_state* state) noexcept {
+  delete state;
+}
+
 template <typename cs>
 void RTree<cs>::dump(RedisModuleCtx* ctx) const {
   std::size_t lenTop = 0;
@@ -221,7 +455,7 @@ void RTree<cs>::dump(RedisModuleCtx* ctx) const {
 
 template <typename cs>
 std::size_t RTree<cs>::report() const noexcept {
-  return allocated_;
+  return allocated_ + nodesAllocated_;
 }
 
 template <typename cs>
@@ -234,43 +468,73 @@ auto RTree<cs>::apply_predicate(Predicate&& p, Filter&& f) const -> query_result
 }
 
 template <typename cs>
-auto RTree<cs>::contains(doc_type const& query_doc, geom_type const& query_geom) const
-    -> query_results {
-  return apply_predicate(bgi::contains(get_rect<cs>(query_doc)), [&](auto const& doc) -> bool {
+auto RTree<cs>::contains(prepared_query const& query) const -> query_results {
+  return apply_predicate(bgi::contains(query.mbr), [&](auto const& doc) -> bool {
     auto geom = lookup(doc);
-    return geom.has_value() && std::visit(filter_results<cs>, query_geom, *geom);
+    return geom.has_value() && std::visit(filter_results<cs>, query.geom, *geom);
   });
 }
 
 template <typename cs>
-auto RTree<cs>::within(doc_type const& query_doc, geom_type const& query_geom) const
-    -> query_results {
-  return apply_predicate(bgi::within(get_rect<cs>(query_doc)), [&](auto const& doc) -> bool {
-    auto geom = lookup(doc);
-    return geom.has_value() && std::visit(filter_results<cs>, *geom, query_geom);
+auto RTree<cs>::within(prepared_query const& query) const -> query_results {
+  using cell = typename prepared_query::cell;
+  return apply_predicate(bgi::within(query.mbr), [&](auto const& doc) -> bool {
+    switch (query.classify(get_rect<cs>(doc))) {
+      case cell::INSIDE:
+        return false;
+      case cell::OUTSIDE:
+        return true;
+      default: {
+        auto geom = lookup(doc);
+        return geom.has_value() && std::visit(filter_results<cs>, *geom, query.geom);
+      }
+    }
   });
 }
 
 template <typename cs>
-auto RTree<cs>::generate_predicate(doc_type const& query_doc, QueryType query_type,
-                                   geom_type const& query_geom) const -> query_results {
+auto RTree<cs>::generate_predicate(prepared_query const& query, QueryType query_type) const
+    -> query_results {
   switch (query_type) {
     case QueryType::CONTAINS:
-      return contains(query_doc, query_geom);
+      return contains(query);
     case QueryType::WITHIN:
-      return within(query_doc, query_geom);
+      return within(query);
     default:
       throw std::runtime_error{"unknown query"};
   }
 }
 
+/* Parse and index the query geometry, or reuse the one of a recent query with the same WKT */
+template <typename cs>
+auto RTree<cs>::prepare(std::string_view wkt) const -> prepared_ptr {
+  auto const hash = std::hash<std::string_view>{}(wkt);
+  {
+    auto lock = std::lock_guard{preparedLock_};
+    for (auto const& entry : preparedCache_) {
+      if (entry.prepared && entry.hash == hash && std::string_view{entry.wkt} == wkt) {
+        return entry.prepared;
+      }
+    }
+  }
+
+  // Queries may run concurrently, don't hold the lock while preparing
+  auto prepared = prepared_ptr{std::allocate_shared<prepared_query>(
+      Allocator::Allocator<prepared_query>{}, from_wkt<cs>(wkt))};
+  auto lock = std::lock_guard{preparedLock_};
+  auto& entry = preparedCache_[preparedNext_++ % PREPARED_CACHE_SIZE];
+  entry.hash = hash;
+  entry.wkt.assign(wkt.begin(), wkt.end());
+  entry.prepared = prepared;
+  return prepared;
+}
+
 template <typename cs>
 auto RTree<cs>::query(std::string_view wkt, QueryType query_type, RedisModuleString** err_msg) const
     -> IndexIterator* {
   try {
-    auto query_geom = from_wkt<cs>(wkt);
-    return generate_query_iterator<cs>(
-        generate_predicate(make_doc<cs>(query_geom), query_type, query_geom), allocated_);
+    auto prepared = prepare(wkt);
+    return generate_query_iterator<cs>(generate_predicate(*prepared, query_type), allocated_);
   } catch (const std::exception& e) {
     if (err_msg) {
       *err_msg = RedisModule_CreateString(nullptr, e.what(), strlen(e.what()));
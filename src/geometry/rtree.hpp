@@ -12,8 +12,14 @@
 #include "query_iterator.hpp"
 #include "geometry_types.h"
 
+#include <array>                                   // std::array
+#include <atomic>                                  // std::atomic
+#include <mutex>                                   // std::mutex
+#include <memory>                                  // std::shared_ptr
+#include <string>                                  // std::basic_string
 #include <vector>                                  // std::vector
 #include <variant>                                 // std::variant
+#include <optional>                                // std::optional
 #include <utility>                                 // std::pair
 #include <functional>                              // std::hash, std::equal_to
 #include <string_view>                             // std::string_view
@@ -54,16 +60,48 @@ class RTree {
 
   using query_results = std::vector<doc_type, Allocator::TrackingAllocator<doc_type>>;
 
+  // A query geometry, parsed and indexed once to test all the candidates of the queries using it
+  struct prepared_query;
+  using prepared_ptr = std::shared_ptr<prepared_query const>;
+
+  // A packed tree being built aside from a snapshot of the docs
+  struct repack_state;
+
  private:
+  struct prepared_entry {
+    std::size_t hash;
+    std::basic_string<char, std::char_traits<char>, Allocator::Allocator<char>> wkt;
+    prepared_ptr prepared;
+  };
+  static constexpr std::size_t PREPARED_CACHE_SIZE = 8;
+
+  using repack_log = std::vector<std::pair<doc_type, bool>,
+                                 Allocator::Allocator<std::pair<doc_type, bool>>>;
+
   mutable std::size_t allocated_;
+  std::size_t nodesAllocated_;  // the memory of the nodes of rtree_, swapped along with them
   rtree_type rtree_;
   LUT_type docLookup_;
+  std::size_t changes_;  // inserts and removals since the tree was last packed
+
+  // The repack in progress, and the inserts (true) and removals (false) made since its snapshot
+  std::atomic<repack_state*> repacking_;
+  repack_log repackLog_;
+
+  // The query geometries of the latest queries, replaced in turn
+  mutable std::mutex preparedLock_;
+  mutable std::array<prepared_entry, PREPARED_CACHE_SIZE> preparedCache_;
+  mutable std::size_t preparedNext_;
 
  public:
   explicit RTree();
 
   int insertWKT(std::string_view wkt, t_docId id, RedisModuleString** err_msg);
   bool remove(t_docId id);
+  [[nodiscard]] auto repack_begin(bool force) -> repack_state*;
+  static void repack_build(repack_state* state);
+  void repack_commit(repack_state* state);
+  static void repack_free(repack_state* state) noexcept;
   [[nodiscard]] auto query(std::string_view wkt, QueryType query_type,
                            RedisModuleString** err_msg) const -> IndexIterator*;
 
@@ -77,15 +115,14 @@ class RTree {
   [[nodiscard]] auto lookup(t_docId id) const -> boost::optional<geom_type const&>;
   [[nodiscard]] auto lookup(doc_type const& doc) const -> boost::optional<geom_type const&>;
   void insert(geom_type const& geom, t_docId id);
+  [[nodiscard]] auto prepare(std::string_view wkt) const -> prepared_ptr;
 
   template <typename Predicate, typename Filter>
   [[nodiscard]] auto apply_predicate(Predicate&& p, Filter&& f) const -> query_results;
-  [[nodiscard]] auto contains(doc_type const& query_doc, geom_type const& query_geom) const
-      -> query_results;
-  [[nodiscard]] auto within(doc_type const& query_doc, geom_type const& query_geom) const
+  [[nodiscard]] auto contains(prepared_query const& query) const -> query_results;
+  [[nodiscard]] auto within(prepared_query const& query) const -> query_results;
+  [[nodiscard]] auto generate_predicate(prepared_query const& query, QueryType query_type) const
       -> query_results;
-  [[nodiscard]] auto generate_predicate(doc_type const& query_doc, QueryType query_type,
-                                        geom_type const& query_geom) const -> query_results;
 };
 
 }  // namespace GeoShape
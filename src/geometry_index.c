@@ -8,10 +8,13 @@
 #include "geometry/geometry_api.h"
 #include "rmalloc.h"
 #include "field_spec.h"
+#include "util/arr.h"
 
 void GeometryQuery_Free(GeometryQuery *geomq) {
   if (geomq->str) {
     rm_free((void *)geomq->str);
+  }
+  if (geomq->attr) {
     rm_free((void *)geomq->attr);
   }
   rm_free(geomq);
@@ -85,4 +88,62 @@ void GeometryIndex_RemoveId(RedisModuleCtx *ctx, IndexSpec *spec, t_docId id) {
       }
     }
   }
-}
\ No newline at end of file
+}
+
+// A geometry index being packed
+typedef struct {
+  int fieldIndex;
+  GeometryIndex *idx;
+  const GeometryApi *api;
+  void *repack;
+} GeometryRepack;
+
+static GeometryIndex *openFieldGeometryIndex(IndexSpec *spec, int fieldIndex) {
+  if (!spec->keysDict || fieldIndex >= spec->numFields) {
+    return NULL;
+  }
+  const FieldSpec *fs = spec->fields + fieldIndex;
+  if (!(fs->types & INDEXFLD_T_GEOMETRY)) {
+    return NULL;
+  }
+  RedisModuleString *keyName = IndexSpec_GetFormattedKey(spec, fs, INDEXFLD_T_GEOMETRY);
+  return keyName ? openGeometryKeysDict(spec, keyName, 0, fs) : NULL;
+}
+
+void GeometryIndex_Repack(RedisModuleCtx *ctx, IndexSpec *spec, bool force) {
+  RedisSearchCtx sctx = SEARCH_CTX_STATIC(ctx, spec);
+  GeometryRepack *repacks = array_new(GeometryRepack, 1);
+
+  RedisSearchCtx_LockSpecRead(&sctx);
+  for (int i = 0; i < spec->numFields; ++i) {
+    GeometryIndex *idx = openFieldGeometryIndex(spec, i);
+    const GeometryApi *api = idx ? GeometryApi_Get(idx) : NULL;
+    void *repack = api ? api->repackBegin(idx, force) : NULL;
+    if (repack) {
+      GeometryRepack r = {.fieldIndex = i, .idx = idx, .api = api, .repack = repack};
+      repacks = array_append(repacks, r);
+    }
+  }
+  RedisSearchCtx_UnlockSpec(&sctx);
+
+  // Queries and updates go on with the current indexes while the packed ones are built
+  for (size_t i = 0; i < array_len(repacks); ++i) {
+    repacks[i].api->repackBuild(repacks[i].repack);
+  }
+
+  if (array_len(repacks)) {
+    RedisSearchCtx_LockSpecWrite(&sctx);
+    for (size_t i = 0; i < array_len(repacks); ++i) {
+      // the index may have been dropped meanwhile
+      if (openFieldGeometryIndex(spec, repacks[i].fieldIndex) == repacks[i].idx) {
+        repacks[i].api->repackCommit(repacks[i].idx, repacks[i].repack);
+      }
+    }
+    RedisSearchCtx_UnlockSpec(&sctx);
+  }
+
+  for (size_t i = 0; i < array_len(repacks); ++i) {
+    repacks[i].api->repackFree(repacks[i].repack);
+  }
+  array_free(repacks);
+}
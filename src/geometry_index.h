@@ -27,3 +27,8 @@ RedisModuleString *fmtRedisGeometryIndexKey(RedisSearchCtx *ctx, const char *fie
 
 // Remove indexed data for the given document ID
 void GeometryIndex_RemoveId(RedisModuleCtx *ctx, IndexSpec *spec, t_docId id);
+
+// Rebuild the geometry indexes of the spec which changed enough since they were last packed, or
+// all the changed ones if `force` is set. The packed indexes are built from a snapshot taken with
+// the spec locked for read, and swapped in with it locked for write. The spec should not be locked
+void GeometryIndex_Repack(RedisModuleCtx *ctx, IndexSpec *spec, bool force);
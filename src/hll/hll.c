@@ -11,118 +11,237 @@
 
 #include <stdio.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "util/fnv.h"
 #include "hll.h"
 
 #include "rmalloc.h"
 
-static __inline uint8_t _hll_rank(uint32_t hash, uint8_t bits) {
-  uint8_t i;
+// The largest possible rank, reached when all the non-index bits of the hash are 0
+#define HLL_MAX_RANK(bits) (64 - (bits) + 1)
 
-  for (i = 1; i <= 32 - bits; i++) {
-    if (hash & 1) break;
+// A sparse HLL is converted once its entries take as much memory as the registers
+#define HLL_SPARSE_MAX(hll) ((hll)->size / sizeof(uint32_t))
 
-    hash >>= 1;
-  }
+#define HLL_SPARSE_INDEX(e) ((e) >> 8)
+#define HLL_SPARSE_RANK(e) ((uint8_t)((e)&0xff))
+
+// The murmur3 finalizer, spreads the entropy of the hash over all of its bits
+static __inline uint64_t _hll_mix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
 
-  return i;
+static __inline uint8_t _hll_rank(uint64_t hash, uint8_t bits) {
+  // The guard bit bounds the rank when all the remaining bits are 0
+  uint64_t w = (hash << bits) | ((uint64_t)1 << (bits - 1));
+  return __builtin_clzll(w) + 1;
 }
 
 int hll_init(struct HLL *hll, uint8_t bits) {
-  if (bits < 4 || bits > 20) {
+  if (bits < HLL_MIN_BITS || bits > HLL_MAX_BITS) {
     errno = ERANGE;
     return -1;
   }
 
   hll->bits = bits;
   hll->size = (size_t)1 << bits;
-  hll->registers = rm_calloc(hll->size, 1);
+  hll->registers = NULL;
+  hll->sparse = NULL;
+  hll->sparse_len = 0;
+  hll->sparse_cap = 0;
 
   return 0;
 }
 
 void hll_destroy(struct HLL *hll) {
   rm_free(hll->registers);
+  rm_free(hll->sparse);
 
   hll->registers = NULL;
+  hll->sparse = NULL;
+  hll->sparse_len = hll->sparse_cap = 0;
+}
+
+static void _hll_densify(struct HLL *hll) {
+  if (hll->registers) return;
+
+  hll->registers = rm_calloc(hll->size, 1);
+  for (uint32_t i = 0; i < hll->sparse_len; i++) {
+    uint32_t e = hll->sparse[i];
+    hll->registers[HLL_SPARSE_INDEX(e)] = HLL_SPARSE_RANK(e);
+  }
+  rm_free(hll->sparse);
+  hll->sparse = NULL;
+  hll->sparse_len = hll->sparse_cap = 0;
 }
 
-static __inline void _hll_add_hash(struct HLL *hll, uint32_t hash) {
-  uint32_t index = hash >> (32 - hll->bits);
-  uint8_t rank = _hll_rank(hash, hll->bits);
+static void _hll_set(struct HLL *hll, uint32_t index, uint8_t rank) {
+  if (hll->registers) {
+    if (rank > hll->registers[index]) hll->registers[index] = rank;
+    return;
+  }
+
+  uint32_t lo = 0, hi = hll->sparse_len;
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) / 2;
+    if (HLL_SPARSE_INDEX(hll->sparse[mid]) < index) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
 
-  if (rank > hll->registers[index]) {
+  if (lo < hll->sparse_len && HLL_SPARSE_INDEX(hll->sparse[lo]) == index) {
+    if (rank > HLL_SPARSE_RANK(hll->sparse[lo])) hll->sparse[lo] = (index << 8) | rank;
+    return;
+  }
+
+  if (hll->sparse_len == HLL_SPARSE_MAX(hll)) {
+    _hll_densify(hll);
     hll->registers[index] = rank;
+    return;
   }
+
+  if (hll->sparse_len == hll->sparse_cap) {
+    hll->sparse_cap = hll->sparse_cap ? hll->sparse_cap * 2 : 4;
+    if (hll->sparse_cap > HLL_SPARSE_MAX(hll)) hll->sparse_cap = HLL_SPARSE_MAX(hll);
+    hll->sparse = rm_realloc(hll->sparse, hll->sparse_cap * sizeof(*hll->sparse));
+  }
+  memmove(hll->sparse + lo + 1, hll->sparse + lo, (hll->sparse_len - lo) * sizeof(*hll->sparse));
+  hll->sparse[lo] = (index << 8) | rank;
+  hll->sparse_len++;
+}
+
+static __inline void _hll_add_hash(struct HLL *hll, uint64_t hash) {
+  hash = _hll_mix(hash);
+  _hll_set(hll, (uint32_t)(hash >> (64 - hll->bits)), _hll_rank(hash, hll->bits));
 }
 
-void hll_add_hash(struct HLL *hll, uint32_t h) {
+void hll_add_hash(struct HLL *hll, uint64_t h) {
   _hll_add_hash(hll, h);
 }
 
 void hll_add(struct HLL *hll, const void *buf, size_t size) {
-  uint32_t hash = rs_fnv_32a_buf((void *)buf, (uint32_t)size, 0x5f61767a);
+  uint64_t hash = fnv_64a_buf(buf, size, 0x5f61767a);
 
   _hll_add_hash(hll, hash);
 }
 
-double hll_count(const struct HLL *hll) {
-  double alpha_mm;
-  uint32_t i;
-
-  switch (hll->bits) {
-    case 4:
-      alpha_mm = 0.673;
-      break;
-    case 5:
-      alpha_mm = 0.697;
-      break;
-    case 6:
-      alpha_mm = 0.709;
-      break;
-    default:
-      alpha_mm = 0.7213 / (1.0 + 1.079 / (double)hll->size);
-      break;
-  }
+static double _hll_sigma(double x) {
+  if (x == 1.0) return INFINITY;
+
+  double y = 1.0, z = x, zprev;
+  do {
+    x *= x;
+    zprev = z;
+    z += x * y;
+    y += y;
+  } while (z != zprev);
+  return z;
+}
 
-  alpha_mm *= ((double)hll->size * (double)hll->size);
+static double _hll_tau(double x) {
+  if (x == 0.0 || x == 1.0) return 0.0;
+
+  double y = 1.0, z = 1.0 - x, zprev;
+  do {
+    x = sqrt(x);
+    zprev = z;
+    y *= 0.5;
+    z -= (1.0 - x) * (1.0 - x) * y;
+  } while (z != zprev);
+  return z / 3.0;
+}
 
-  double sum = 0;
-  for (i = 0; i < hll->size; i++) {
-    sum += 1.0 / (1 << hll->registers[i]);
+/*
+ * Ertl's improved estimator ("New cardinality estimation algorithms for HyperLogLog sketches"),
+ * which corrects the bias of the raw estimate over the whole range of cardinalities from the
+ * histogram of the register values, without switching to linear counting or empirical tables.
+ */
+double hll_count(const struct HLL *hll) {
+  const uint32_t q = 64 - hll->bits;
+  uint32_t hist[HLL_MAX_RANK(HLL_MIN_BITS) + 1] = {0};
+  double m = (double)hll->size;
+
+  if (hll->registers) {
+    for (size_t i = 0; i < hll->size; i++) hist[hll->registers[i]]++;
+  } else {
+    hist[0] = hll->size - hll->sparse_len;
+    for (uint32_t i = 0; i < hll->sparse_len; i++) hist[HLL_SPARSE_RANK(hll->sparse[i])]++;
   }
 
-  double estimate = alpha_mm / sum;
-
-  if (estimate <= 5.0 / 2.0 * (double)hll->size) {
-    int zeros = 0;
-
-    for (i = 0; i < hll->size; i++) zeros += (hll->registers[i] == 0);
+  double z = m * _hll_tau(1.0 - hist[q + 1] / m);
+  for (uint32_t k = q; k >= 1; k--) {
+    z += hist[k];
+    z *= 0.5;
+  }
+  z += m * _hll_sigma(hist[0] / m);
 
-    if (zeros) estimate = (double)hll->size * log((double)hll->size / zeros);
+  return m * m / (2.0 * M_LN2) / z;
+}
 
-  } else if (estimate > (1.0 / 30.0) * 4294967296.0) {
-    estimate = -4294967296.0 * log(1.0 - (estimate / 4294967296.0));
+// dst[i] = max(dst[i], src[i])
+static void _hll_max_registers(uint8_t *dst, const uint8_t *src, size_t size) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= size; i += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(dst + i));
+    __m128i b = _mm_loadu_si128((const __m128i *)(src + i));
+    _mm_storeu_si128((__m128i *)(dst + i), _mm_max_epu8(a, b));
+  }
+#elif defined(__ARM_NEON)
+  for (; i + 16 <= size; i += 16) {
+    vst1q_u8(dst + i, vmaxq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+  }
+#endif
+  for (; i < size; i++) {
+    if (src[i] > dst[i]) dst[i] = src[i];
   }
-
-  return estimate;
 }
 
 int hll_merge(struct HLL *dst, const struct HLL *src) {
-  uint32_t i;
-
   if (dst->bits != src->bits) {
     errno = EINVAL;
     return -1;
   }
 
-  for (i = 0; i < dst->size; i++) {
-    if (src->registers[i] > dst->registers[i]) dst->registers[i] = src->registers[i];
+  if (!src->registers) {
+    for (uint32_t i = 0; i < src->sparse_len; i++) {
+      uint32_t e = src->sparse[i];
+      _hll_set(dst, HLL_SPARSE_INDEX(e), HLL_SPARSE_RANK(e));
+    }
+    return 0;
   }
 
+  _hll_densify(dst);
+  _hll_max_registers(dst->registers, src->registers, dst->size);
+
   return 0;
 }
 
+void hll_copy_registers(const struct HLL *hll, uint8_t *dst) {
+  if (hll->registers) {
+    memcpy(dst, hll->registers, hll->size);
+    return;
+  }
+
+  memset(dst, 0, hll->size);
+  for (uint32_t i = 0; i < hll->sparse_len; i++) {
+    uint32_t e = hll->sparse[i];
+    dst[HLL_SPARSE_INDEX(e)] = HLL_SPARSE_RANK(e);
+  }
+}
+
 int hll_load(struct HLL *hll, const void *registers, size_t size) {
   uint8_t bits = 0;
   size_t s = size;
@@ -142,11 +261,23 @@ int hll_load(struct HLL *hll, const void *registers, size_t size) {
 
   if (hll_init(hll, bits) == -1) return -1;
 
+  const uint8_t *regs = registers;
+  for (size_t i = 0; i < size; i++) {
+    if (regs[i] > HLL_MAX_RANK(bits)) {
+      errno = EINVAL;
+      return -1;
+    }
+  }
+
+  hll->registers = rm_malloc(size);
   memcpy(hll->registers, registers, size);
 
   return 0;
 }
 
 extern uint32_t _hll_hash(const struct HLL *hll) {
+  if (!hll->registers) {
+    return rs_fnv_32a_buf(hll->sparse, hll->sparse_len * sizeof(*hll->sparse), 0);
+  }
   return rs_fnv_32a_buf(hll->registers, (uint32_t)hll->size, 0);
 }
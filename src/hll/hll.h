@@ -10,11 +10,26 @@
 #include <sys/types.h>
 #include <stdint.h>
 
+#define HLL_MIN_BITS 4
+#define HLL_MAX_BITS 20
+
+/**
+ * A HyperLogLog over 64 bit hashes.
+ *
+ * A new HLL starts out sparse, keeping a sorted list of its non-zero registers, and is converted
+ * to the dense register array once the list would take up as much memory as the array. This keeps
+ * small sets cheap, no matter the precision.
+ */
 struct HLL {
   uint8_t bits;
 
   size_t size;
-  uint8_t *registers;
+  uint8_t *registers;  // NULL while sparse
+
+  // Sparse registers, encoded as (index << 8 | rank) and sorted by index
+  uint32_t *sparse;
+  uint32_t sparse_len;
+  uint32_t sparse_cap;
 };
 
 extern int hll_init(struct HLL *hll, uint8_t bits);
@@ -22,9 +37,14 @@ extern int hll_load(struct HLL *hll, const void *registers, size_t size);
 extern void hll_destroy(struct HLL *hll);
 extern int hll_merge(struct HLL *dst, const struct HLL *src);
 extern void hll_add(struct HLL *hll, const void *buf, size_t size);
-void hll_add_hash(struct HLL *hll, uint32_t h);
+
+/* Add an element by its 64 bit hash. The hash is remixed, so weak hashes such as FNV are fine */
+void hll_add_hash(struct HLL *hll, uint64_t h);
 extern double hll_count(const struct HLL *hll);
 
+/* Write the dense registers of the HLL, sparse or not, into `dst` which holds `hll->size` bytes */
+void hll_copy_registers(const struct HLL *hll, uint8_t *dst);
+
 extern uint32_t _hll_hash(const struct HLL *hll);
 
 #endif /* AVZ_HLL_H */
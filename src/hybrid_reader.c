@@ -11,6 +11,9 @@
 
 #define VECTOR_RESULT(p) (p->type == RSResultType_Metric ? p : p->agg.children[0])
 
+// Number of child ids whose distances are computed together in ad-hoc BF mode
+#define HYBRID_ADHOC_BF_BATCH_SIZE 128
+
 static void prepareResults(HybridIterator *hr); // forward declaration
 
 static int cmpVecSimResByScore(const void *p1, const void *p2, const void *udata) {
@@ -24,17 +27,16 @@ static int cmpVecSimResByScore(const void *p1, const void *p2, const void *udata
   return e1->docId < e2->docId;
 }
 
-// To use in the future, if we will need to sort results by id.
-// static int cmpVecSimResById(const void *p1, const void *p2, const void *udata) {
-//   const RSIndexResult *e1 = p1, *e2 = p2;
+static int cmpVecSimResById(const void *p1, const void *p2) {
+  const RSIndexResult *e1 = *(const RSIndexResult **)p1, *e2 = *(const RSIndexResult **)p2;
 
-//   if (e1->docId > e2->docId) {
-//     return 1;
-//   } else if (e1->docId < e2->docId) {
-//     return -1;
-//   }
-//   return 0;
-// }
+  if (e1->docId > e2->docId) {
+    return 1;
+  } else if (e1->docId < e2->docId) {
+    return -1;
+  }
+  return 0;
+}
 
 // Simulate the logic of "SkipTo", but it is limited to the results in a specific batch.
 static int HR_SkipToInBatch(void *ctx, t_docId docId, RSIndexResult **hit) {
@@ -158,12 +160,68 @@ static void alternatingIterate(HybridIterator *hr, VecSimQueryResult_Iterator *v
   IndexResult_Free(cur_vec_res);
 }
 
-void computeDistances(HybridIterator *hr) {
+// Insert a candidate which only holds the vector distance into the heap, if it is one of the top k.
+static void insertCandidate(HybridIterator *hr, t_docId id, double score) {
+  RSIndexResult *candidate;
+  if (hr->topResults->count < hr->query.k) {
+    candidate = NewMetricResult();
+  } else if (score < ((RSIndexResult *)mmh_peek_max(hr->topResults))->num.value) {
+    candidate = mmh_pop_max(hr->topResults);
+  } else {
+    return;
+  }
+  candidate->docId = id;
+  candidate->num.value = score;
+  mmh_insert(hr->topResults, candidate);
+}
+
+/*
+ * Replace the candidates in the heap by full results. The child is skipped to each of the
+ * candidates in id order, so that its result is attached to it as if it was found while
+ * intersecting with the child.
+ */
+static void attachChildResults(HybridIterator *hr) {
+  size_t n_candidates = hr->topResults->count;
+  RSIndexResult **candidates = rm_malloc(sizeof(*candidates) * (n_candidates ? n_candidates : 1));
+  for (size_t i = 0; i < n_candidates; i++) {
+    candidates[i] = mmh_pop_min(hr->topResults);
+  }
+  qsort(candidates, n_candidates, sizeof(*candidates), cmpVecSimResById);
+
   double upper_bound = INFINITY;
   RSIndexResult *cur_res = hr->base.current;
   RSIndexResult *cur_child_res;  // This will use the memory of hr->child->current.
-  RSIndexResult *cur_vec_res = NewMetricResult();
+  hr->child->Rewind(hr->child->ctx);
+  for (size_t i = 0; i < n_candidates; i++) {
+    RSIndexResult *cur_vec_res = candidates[i];
+    if (hr->child->SkipTo(hr->child->ctx, cur_vec_res->docId, &cur_child_res) == INDEXREAD_OK) {
+      // If the heap takes the vector result, cur_vec_res is set to a new result to free.
+      insertResultToHeap(hr, cur_res, cur_child_res, &cur_vec_res, &upper_bound);
+    }
+    IndexResult_Free(cur_vec_res);
+  }
+  rm_free(candidates);
+}
+
+// Check the timeout once per batch of ids. TimedOut_WithCtx only checks it every 100 calls.
+static bool batchTimedOut(HybridIterator *hr) {
+  if (RS_IsMock || hr->timeoutCtx.counter == REDISEARCH_UNINITIALIZED) {
+    return false;
+  }
+  return TimedOut(&hr->timeoutCtx.timeout) == TIMED_OUT;
+}
+
+/*
+ * Ad-hoc BF mode: the child ids are read in batches, and the distances of a batch are computed
+ * together. The top k candidates only hold their distance until all the child was read, and are
+ * then attached to their child results, so that the (possibly large) child results are not copied
+ * for every document which is better than the current top k.
+ */
+void computeDistances(HybridIterator *hr) {
+  RSIndexResult *cur_child_res;  // This will use the memory of hr->child->current.
   void *qvector = hr->query.vector;
+  t_docId ids[HYBRID_ADHOC_BF_BATCH_SIZE];
+  double metrics[HYBRID_ADHOC_BF_BATCH_SIZE];
 
   if (hr->indexMetric == VecSimMetric_Cosine) {
     qvector = rm_malloc(hr->dimension * VecSimType_sizeof(hr->vecType));
@@ -171,27 +229,107 @@ void computeDistances(HybridIterator *hr) {
     VecSim_Normalize(qvector, hr->dimension, hr->vecType);
   }
 
-  while (hr->child->Read(hr->child->ctx, &cur_child_res) != INDEXREAD_EOF) {
-    if(TimedOut_WithCtx(&hr->timeoutCtx)) {
+  size_t n_ids;
+  do {
+    n_ids = 0;
+    while (n_ids < HYBRID_ADHOC_BF_BATCH_SIZE &&
+           hr->child->Read(hr->child->ctx, &cur_child_res) != INDEXREAD_EOF) {
+      ids[n_ids++] = cur_child_res->docId;
+    }
+    if (batchTimedOut(hr)) {
       hr->list.code = VecSim_QueryResult_TimedOut;
       break;
     }
-    double metric = VecSimIndex_GetDistanceFrom(hr->index, cur_child_res->docId, qvector);
-    // If this id is not in the vector index (since it was deleted), metric will return as NaN.
-    if (isnan(metric)) {
-      continue;
+    for (size_t i = 0; i < n_ids; i++) {
+      metrics[i] = VecSimIndex_GetDistanceFrom(hr->index, ids[i], qvector);
     }
-    if (hr->topResults->count < hr->query.k || metric < upper_bound) {
-      // Populate the vector result.
-      cur_vec_res->docId = cur_child_res->docId;
-      cur_vec_res->num.value = metric;
-      insertResultToHeap(hr, cur_res, cur_child_res, &cur_vec_res, &upper_bound);
+    for (size_t i = 0; i < n_ids; i++) {
+      // If this id is not in the vector index (since it was deleted), metric will return as NaN.
+      if (!isnan(metrics[i])) {
+        insertCandidate(hr, ids[i], metrics[i]);
+      }
     }
-  }
+  } while (n_ids == HYBRID_ADHOC_BF_BATCH_SIZE);
+
   if (qvector != hr->query.vector) {
     rm_free(qvector);
   }
-  IndexResult_Free(cur_vec_res);
+  attachChildResults(hr);
+}
+
+static int cmpDocIds(const void *p1, const void *p2) {
+  t_docId id1 = *(const t_docId *)p1, id2 = *(const t_docId *)p2;
+  return id1 < id2 ? -1 : id1 > id2;
+}
+
+static bool filterHasId(t_docId *ids, t_docId id) {
+  return bsearch(&id, ids, array_len(ids), sizeof(*ids), cmpDocIds) != NULL;
+}
+
+// Collect the ids of the child results, in increasing order. Returns NULL on timeout.
+static t_docId *materializeChild(HybridIterator *hr) {
+  RSIndexResult *cur_child_res;
+  t_docId *ids = array_new(t_docId, MIN(hr->child->NumEstimated(hr->child->ctx), VecSimIndex_IndexSize(hr->index)));
+  while (hr->child->Read(hr->child->ctx, &cur_child_res) != INDEXREAD_EOF) {
+    if (TimedOut_WithCtx(&hr->timeoutCtx)) {
+      array_free(ids);
+      return NULL;
+    }
+    ids = array_append(ids, cur_child_res->docId);
+  }
+  return ids;
+}
+
+/*
+ * Filtered batches mode: the child is read once into a sorted array of ids, and the vector results
+ * of every batch are checked against it, rather than intersected with the child again. The
+ * candidates collected this way only hold the vector distance, so the child is then skipped to
+ * each of the final candidates, to build the result as in the other hybrid modes.
+ */
+static void filteredBatches(HybridIterator *hr) {
+  t_docId *ids = materializeChild(hr);
+  if (!ids) {
+    hr->list.code = VecSim_QueryResult_TimedOut;
+    return;
+  }
+  if (array_len(ids) == 0) {
+    array_free(ids);
+    return;
+  }
+
+  VecSimQueryParams batchParams = hr->runtimeParams;
+  batchParams.searchMode = VECSIM_HYBRID_BATCHES;
+  VecSimBatchIterator *batch_it = VecSimBatchIterator_New(hr->index, hr->query.vector, &batchParams);
+  size_t vec_index_size = VecSimIndex_IndexSize(hr->index);
+  size_t filter_size = MIN(array_len(ids), vec_index_size);
+  while (hr->topResults->count < hr->query.k && VecSimBatchIterator_HasNext(batch_it)) {
+    hr->numIterations++;
+    size_t n_res_left = hr->query.k - hr->topResults->count;
+    size_t batch_size = hr->runtimeParams.batchSize;
+    if (batch_size == 0) {
+      batch_size = n_res_left * ((float)vec_index_size / filter_size) + 1;
+    }
+    VecSimQueryResult_List list = VecSimBatchIterator_Next(batch_it, batch_size, BY_SCORE);
+    if (list.code == VecSim_QueryResult_TimedOut) {
+      hr->list.code = VecSim_QueryResult_TimedOut;
+      VecSimQueryResult_Free(list);
+      break;
+    }
+    VecSimQueryResult_Iterator *iter = VecSimQueryResult_List_GetIterator(list);
+    while (VecSimQueryResult_IteratorHasNext(iter)) {
+      VecSimQueryResult *res = VecSimQueryResult_IteratorNext(iter);
+      t_docId id = VecSimQueryResult_GetId(res);
+      if (filterHasId(ids, id)) {
+        insertCandidate(hr, id, VecSimQueryResult_GetScore(res));
+      }
+    }
+    VecSimQueryResult_IteratorFree(iter);
+    VecSimQueryResult_Free(list);
+  }
+  VecSimBatchIterator_Free(batch_it);
+  array_free(ids);
+
+  attachChildResults(hr);
 }
 
 // Review the estimated child results num, and returns true if hybrid policy should change.
@@ -242,6 +380,11 @@ static void prepareResults(HybridIterator *hr) {
     computeDistances(hr);
     return;
   }
+
+  if (hr->filtered) {
+    filteredBatches(hr);
+    return;
+  }
   // Batches mode.
   if (hr->child->NumEstimated(hr->child->ctx) == 0) {
     return;
@@ -417,6 +560,7 @@ IndexIterator *NewHybridVectorIterator(HybridIteratorParams hParams, QueryError
   HybridIterator *hi = rm_new(HybridIterator);
   hi->lastDocId = 0;
   hi->child = hParams.childIt;
+  hi->filtered = false;
   hi->resultsPrepared = false;
   hi->index = hParams.index;
   hi->dimension = hParams.dim;
@@ -452,7 +596,11 @@ IndexIterator *NewHybridVectorIterator(HybridIteratorParams hParams, QueryError
       subset_size = VecSimIndex_IndexSize(hParams.index);
     }
     // If user asks explicitly for a policy - use it.
-    if (hParams.qParams.searchMode) {
+    if (hParams.filtered) {
+      // Runs in batches, which are checked against the child ids rather than intersected with it
+      hi->searchMode = VECSIM_HYBRID_BATCHES;
+      hi->filtered = true;
+    } else if (hParams.qParams.searchMode) {
       hi->searchMode = (VecSimSearchMode)hParams.qParams.searchMode;
     } else {
       // Use a pre-defined heuristics that determines which approach should be faster.
@@ -20,6 +20,7 @@ typedef struct {
   VecSimMetric spaceMetric;
   KNNVectorQuery query;
   VecSimQueryParams qParams;
+  bool filtered;                   // HYBRID_POLICY FILTERED, which VecSim doesn't know
   char *vectorScoreField;
   bool ignoreDocScore;
   IndexIterator *childIt;
@@ -36,6 +37,7 @@ typedef struct {
   VecSimQueryParams runtimeParams; // Evaluated runtime params.
   IndexIterator *child;
   VecSimSearchMode searchMode;
+  bool filtered;                   // Batches filtered by the collected child ids (HYBRID_POLICY FILTERED)
   bool resultsPrepared;            // Indicates if the results were already processed
                                    // (should occur in the first call to Read)
   VecSimQueryResult_List list;
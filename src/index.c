@@ -2000,8 +2000,11 @@ void PrintIteratorChildProfile(RedisModule_Reply *reply, IndexIterator *root, si
 
     if (root->type == HYBRID_ITERATOR) {
       HybridIterator *hi = root->ctx;
-      if (hi->searchMode == VECSIM_HYBRID_BATCHES ||
-          hi->searchMode == VECSIM_HYBRID_BATCHES_TO_ADHOC_BF) {
+      if (hi->filtered) {
+        printProfileHybridPolicy(VECSIM_POLICY_FILTERED);
+        printProfileNumBatches(hi);
+      } else if (hi->searchMode == VECSIM_HYBRID_BATCHES ||
+                 hi->searchMode == VECSIM_HYBRID_BATCHES_TO_ADHOC_BF) {
         printProfileNumBatches(hi);
       }
     }
@@ -8,6 +8,7 @@
 #include "inverted_index.h"
 #include "vector_index.h"
 #include "cursor.h"
+#include "query_cache.h"
 #include "resp3.h"
 #include "geometry/geometry_api.h"
 #include "geometry_index.h"
@@ -237,6 +238,10 @@ int IndexInfoCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
 
   Cursors_RenderStats(&g_CursorsList, sp, reply);
 
+  if (sp->queryCache) {
+    QueryCache_RenderStats(sp->queryCache, reply);
+  }
+
   if (sp->flags & Index_HasCustomStopwords) {
     ReplyWithStopWordsList(reply, sp->stopwords);
   }
@@ -518,10 +518,8 @@ size_t InvertedIndex_WriteEntryGeneric(InvertedIndex *idx, IndexEncoder encoder,
   t_docId delta = 0;
   IndexBlock *blk = &INDEX_LAST_BLOCK(idx);
 
-  // use proper block size. Index_DocIdsOnly == 0x00
-  uint16_t blockSize = (idx->flags & INDEX_STORAGE_MASK) ?
-          INDEX_BLOCK_SIZE :
-          INDEX_BLOCK_SIZE_DOCID_ONLY;
+  // use proper block size
+  uint16_t blockSize = InvertedIndex_BlockCapacity(idx->flags);
 
   // see if we need to grow the current block
   if (blk->numEntries >= blockSize && !same_doc) {
@@ -759,10 +757,13 @@ DECODER(readNumeric) {
 
   NumericFilter *f = ctx->ptr;
   if (f) {
-    if (NumericFilter_IsNumeric(f)) {
+    if (NumericFilter_IsNumeric(f) || f->geoInside) {
+      // Values of a geo range which is within the radius don't need the distance check
       return NumericFilter_Match(f, res->num.value);
     } else {
-      return isWithinRadius(f->geoFilter, res->num.value, &res->num.value);
+      // The result keeps its geohash score, whether its range is within the radius or crosses it
+      double distance;
+      return isWithinRadius(f->geoFilter, res->num.value, &distance);
     }
   }
 
@@ -1478,6 +1479,69 @@ int IndexBlock_Repair(IndexBlock *blk, DocTable *dt, IndexFlags flags, IndexRepa
   return frags;
 }
 
+uint16_t InvertedIndex_BlockCapacity(IndexFlags flags) {
+  // Index_DocIdsOnly == 0x00
+  return (flags & INDEX_STORAGE_MASK) ? INDEX_BLOCK_SIZE : INDEX_BLOCK_SIZE_DOCID_ONLY;
+}
+
+/* Append the records of `src` to `dst`. Only the deltas that depend on the block boundaries are
+ * re-encoded, the rest of the records are copied as is. `src` must directly follow `dst` in the
+ * index. Returns 0 (and leaves `dst` untouched) if the blocks cannot be merged.
+ */
+int IndexBlock_Merge(IndexBlock *dst, const IndexBlock *src, IndexFlags flags) {
+  uint32_t readFlags = flags & INDEX_STORAGE_MASK;
+  IndexDecoderProcs decoders = InvertedIndex_GetDecoder(readFlags);
+  IndexEncoder encoder = InvertedIndex_GetEncoder(readFlags);
+  if (!encoder || !decoders.decoder || !src->numEntries) {
+    return 0;
+  }
+  if ((uint32_t)dst->numEntries + src->numEntries > UINT16_MAX) {
+    return 0;
+  }
+  // Raw doc ids are encoded relative to the first id of the block, the other encodings relative
+  // to the previous record. The new deltas must fit in 32 bits either way.
+  bool rawDocIds = encoder == encodeRawDocIdsOnly;
+  t_docId maxDelta = rawDocIds ? src->lastId - dst->firstId : src->firstId - dst->lastId;
+  if (!dst->numEntries || maxDelta > UINT32_MAX) {
+    return 0;
+  }
+
+  Buffer merged = {0};
+  Buffer_Init(&merged, dst->buf.offset + src->buf.offset + sizeof(uint32_t));
+  BufferWriter bw = NewBufferWriter(&merged);
+  Buffer_Write(&bw, dst->buf.data, dst->buf.offset);
+
+  RSIndexResult *res = flags == Index_StoreNumeric ? NewNumericResult() : NewTokenRecord(NULL, 1);
+  BufferReader br = NewBufferReader((Buffer *)&src->buf);
+  bool isFirstRes = true;
+  while (!BufferReader_AtEnd(&br)) {
+    static const IndexDecoderCtx empty = {0};
+    const char *bufBegin = BufferReader_Current(&br);
+    decoders.decoder(&br, &empty, res);
+    uint32_t delta = *(uint32_t *)&res->docId;
+    if (rawDocIds) {
+      res->docId = delta + src->firstId;
+      encoder(&bw, res->docId - dst->firstId, res);
+    } else {
+      // On old rdb versions the first entry holds the doc id itself and not the delta
+      res->docId = (isFirstRes && delta) ? delta : src->firstId;
+      encoder(&bw, res->docId - dst->lastId, res);
+      // Only the first delta depends on the previous block
+      Buffer_Write(&bw, BufferReader_Current(&br), BufferReader_Remaining(&br));
+      break;
+    }
+    isFirstRes = false;
+  }
+  IndexResult_Free(res);
+
+  Buffer_Free(&dst->buf);
+  dst->buf = merged;
+  Buffer_ShrinkToSize(&dst->buf);
+  dst->lastId = src->lastId;
+  dst->numEntries += src->numEntries;
+  return 1;
+}
+
 int InvertedIndex_Repair(InvertedIndex *idx, DocTable *dt, uint32_t startBlock,
                          IndexRepairParams *params) {
   size_t limit = params->limit ? params->limit : SIZE_MAX;
@@ -243,6 +243,13 @@ IndexIterator *NewReadIterator(IndexReader *ir);
 
 int IndexBlock_Repair(IndexBlock *blk, DocTable *dt, IndexFlags flags, IndexRepairParams *params);
 
+/* The number of entries after which the writer opens a new block */
+uint16_t InvertedIndex_BlockCapacity(IndexFlags flags);
+
+/* Append the records of `src` to `dst`, which must be the block preceding it in the same index.
+ * Returns 1 on success, or 0 if the blocks cannot be merged */
+int IndexBlock_Merge(IndexBlock *dst, const IndexBlock *src, IndexFlags flags);
+
 static inline double CalculateIDF(size_t totalDocs, size_t termDocs) {
   return logb(1.0F + totalDocs / (termDocs ? termDocs : (double)1));
 }
@@ -54,22 +54,45 @@ static int MR_Read(void *ctx, RSIndexResult **hit) {
   return INDEXREAD_OK;
 }
 
+// Find the index of the first id which is not lower than `docId`, starting from the current index.
+// The ids are sorted, so we gallop over them (1, 2, 4, 8... ahead) and then binary search the last
+// gap, which costs O(log(distance)) rather than a scan over all the skipped results.
+static size_t MR_FindFrom(const MetricIterator *mr, t_docId docId) {
+  size_t lo = mr->curIndex, hi = mr->curIndex, step = 1;
+  while (hi < mr->resultsNum && mr->idsList[hi] < docId) {
+    lo = hi + 1;
+    hi += step;
+    step *= 2;
+  }
+  if (hi > mr->resultsNum) {
+    hi = mr->resultsNum;
+  }
+  // All the ids before `lo` are lower than docId, and the id at `hi` (if any) is not.
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (mr->idsList[mid] < docId) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
 static int MR_SkipTo(void *ctx, t_docId docId, RSIndexResult **hit) {
   if (!MR_HasNext(ctx)) {
     return INDEXREAD_EOF;
   }
   MetricIterator *mr = ctx;
-  t_docId cur_id = mr->idsList[mr->curIndex];
-  while(cur_id < docId) {
-    // consider binary search for next value (skip exponentially to 2,4,8,...).
-    mr->curIndex++;
-    if (mr->curIndex == mr->resultsNum) {
-      mr->lastDocId = cur_id;
-      IITER_SET_EOF(&mr->base);
-      return INDEXREAD_EOF;
+  mr->curIndex = MR_FindFrom(mr, docId);
+  if (mr->curIndex == mr->resultsNum) {
+    if (mr->resultsNum) {
+      mr->lastDocId = mr->idsList[mr->resultsNum - 1];
     }
-    cur_id = mr->idsList[mr->curIndex];
+    IITER_SET_EOF(&mr->base);
+    return INDEXREAD_EOF;
   }
+  t_docId cur_id = mr->idsList[mr->curIndex];
   // Set the item that we skipped to it in hit.
   *hit = mr->base.current;
   (*hit)->docId = mr->lastDocId = cur_id;
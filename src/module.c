@@ -258,6 +258,7 @@ int QueryExplainCLICommand(RedisModuleCtx *ctx, RedisModuleString **argv, int ar
 
 int RSAggregateCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
 int RSSearchCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int RSMSearchCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
 int RSCursorCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
 int RSProfileCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
 
@@ -421,8 +422,10 @@ int DropIndexCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
     return RedisModule_WrongArity(ctx);
   }
 
-  const char* spec_name = RedisModule_StringPtrLen(argv[1], NULL);
-  StrongRef global_ref = IndexSpec_LoadUnsafe(ctx, spec_name, 0);
+  // there is no point rebuilding a cold index only to drop it
+  IndexLoadOptions lopts = {.flags = INDEXSPEC_LOAD_KEYLESS | INDEXSPEC_LOAD_NOREHYDRATE,
+                            .name = {.cstring = RedisModule_StringPtrLen(argv[1], NULL)}};
+  StrongRef global_ref = IndexSpec_LoadUnsafeEx(ctx, &lopts);
   IndexSpec *sp = StrongRef_Get(global_ref);
   if (!sp) {
     return RedisModule_ReplyWithError(ctx, "Unknown Index name");
@@ -455,11 +458,16 @@ int DropIndexCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
     // delete key notification callbacks.
     IndexSpec_RemoveFromGlobals(global_ref);
 
-    DocTable *dt = &sp->docs;
-    DOCTABLE_FOREACH(dt, Redis_DeleteKeyC(ctx, dmd->keyPtr));
+    if (sp->cold) {
+      // the keys are deleted in the background, which releases the reference when done
+      IndexSpec_DeleteColdDocs(own_ref, sp);
+    } else {
+      DocTable *dt = &sp->docs;
+      DOCTABLE_FOREACH(dt, Redis_DeleteKeyC(ctx, dmd->keyPtr));
 
-    // Return call's references
-    StrongRef_Release(own_ref);
+      // Return call's references
+      StrongRef_Release(own_ref);
+    }
   } else {
     // If we don't delete the docs, we just remove the index from the global dict
     IndexSpec_RemoveFromGlobals(global_ref);
@@ -476,7 +484,9 @@ int DropIfExistsIndexCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int
     return RedisModule_WrongArity(ctx);
   }
 
-  StrongRef ref = IndexSpec_LoadUnsafe(ctx, RedisModule_StringPtrLen(argv[1], NULL), 0);
+  IndexLoadOptions lopts = {.flags = INDEXSPEC_LOAD_KEYLESS | INDEXSPEC_LOAD_NOREHYDRATE,
+                            .name = {.cstring = RedisModule_StringPtrLen(argv[1], NULL)}};
+  StrongRef ref = IndexSpec_LoadUnsafeEx(ctx, &lopts);
   IndexSpec *sp = StrongRef_Get(ref);
   if (!sp) {
     return RedisModule_ReplyWithSimpleString(ctx, "OK");
@@ -1026,6 +1036,8 @@ int RediSearch_InitModuleInternal(RedisModuleCtx *ctx, RedisModuleString **argv,
          INDEX_ONLY_CMD_ARGS);
   RM_TRY(RedisModule_CreateCommand, ctx, RS_AGGREGATE_CMD, RSAggregateCommand, "readonly",
          INDEX_ONLY_CMD_ARGS);
+  RM_TRY(RedisModule_CreateCommand, ctx, RS_MSEARCH_CMD, RSMSearchCommand, "readonly",
+         INDEX_ONLY_CMD_ARGS);
 
   RM_TRY(RedisModule_CreateCommand, ctx, RS_GET_CMD, GetSingleDocumentCommand, "readonly",
          INDEX_DOC_CMD_ARGS);
@@ -1168,6 +1180,7 @@ void RediSearch_CleanupModule(void) {
   GC_ThreadPoolDestroy();
   CleanPool_ThreadPoolDestroy();
   ReindexPool_ThreadPoolDestroy();
+  Grouper_ThreadPoolDestroy();
   ConcurrentSearch_ThreadPoolDestroy();
 
   // free global structures
@@ -98,6 +98,7 @@ NumericFilter *NewNumericFilter(double min, double max, int inclusiveMin, int in
   f->inclusiveMax = inclusiveMax;
   f->inclusiveMin = inclusiveMin;
   f->geoFilter = NULL;
+  f->geoInside = false;
   f->asc = asc;
   f->offset = 0;
   f->limit = 0;
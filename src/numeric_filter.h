@@ -27,6 +27,7 @@ typedef struct NumericFilter {
   int inclusiveMin;         // range includes min value
   int inclusiveMax;         // range includes max val
   const void *geoFilter;    // geo filter
+  bool geoInside;           // the whole range is within the geo filter radius
 
   // used by optimizer
   bool asc;                 // order of SORTBY asc/desc
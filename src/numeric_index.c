@@ -17,7 +17,6 @@
 //#include "tests/time_sample.h"
 #define NR_EXPONENT 4
 #define NR_MAXRANGE_CARD 2500
-#define NR_MAXRANGE_SIZE 10000
 
 typedef struct {
   IndexIterator *it;
@@ -147,11 +146,8 @@ size_t NumericRange_Add(NumericRange *n, t_docId docId, double value, int checkC
   return size;
 }
 
-double NumericRange_Split(NumericRange *n, NumericRangeNode **lp, NumericRangeNode **rp,
-                          NRN_AddRv *rv) {
-
-  double split = (n->unique_sum) / (double)n->card;
-
+static void NumericRange_SplitAt(NumericRange *n, double split, NumericRangeNode **lp,
+                                 NumericRangeNode **rp, NRN_AddRv *rv) {
   *lp = NewLeafNode(n->entries->numDocs / 2 + 1, 
                     MIN(NR_MAXRANGE_CARD, 1 + n->splitCard * NR_EXPONENT));
   *rp = NewLeafNode(n->entries->numDocs / 2 + 1,
@@ -165,7 +161,13 @@ double NumericRange_Split(NumericRange *n, NumericRangeNode **lp, NumericRangeNo
     ++rv->numRecords;
   }
   IR_Free(ir);
+}
 
+double NumericRange_Split(NumericRange *n, NumericRangeNode **lp, NumericRangeNode **rp,
+                          NRN_AddRv *rv) {
+
+  double split = (n->unique_sum) / (double)n->card;
+  NumericRange_SplitAt(n, split, lp, rp, rv);
   return split;
 }
 
@@ -504,6 +506,101 @@ int NumericRangeNode_RemoveChild(NumericRangeNode **node, NRN_AddRv *rv) {
   return CHILD_NOT_EMPTY;
 }
 
+int NumericRangeNode_SplitAt(NumericRangeNode *n, double split, NRN_AddRv *rv) {
+  if (!NumericRangeNode_IsLeaf(n) || !n->range) {
+    return 0;
+  }
+  // both sides of the split must keep at least one value
+  if (split <= n->range->minVal || split > n->range->maxVal) {
+    return 0;
+  }
+
+  NumericRange_SplitAt(n->range, split, &n->left, &n->right, rv);
+  rv->numRanges += 2;
+  if (RSGlobalConfig.numericTreeMaxDepthRange == 0) {
+    removeRange(n, rv);
+  }
+  n->value = split;
+  n->maxDepth = 1;
+  rv->changed = 1;
+  return 1;
+}
+
+/* Merge the entries of two ranges into dst, keeping them ordered by docId */
+static void NumericRange_Merge(NumericRange *dst, NumericRange *a, NumericRange *b,
+                               NRN_AddRv *rv) {
+  IndexReader *ira = NewNumericReader(NULL, a->entries, NULL, 0, 0, false);
+  IndexReader *irb = NewNumericReader(NULL, b->entries, NULL, 0, 0, false);
+  RSIndexResult *ra = NULL, *rb = NULL;
+  int hasA = INDEXREAD_OK == IR_Read(ira, &ra);
+  int hasB = INDEXREAD_OK == IR_Read(irb, &rb);
+
+  while (hasA || hasB) {
+    if (hasA && (!hasB || ra->docId <= rb->docId)) {
+      rv->sz += NumericRange_Add(dst, ra->docId, ra->num.value, 1);
+      hasA = INDEXREAD_OK == IR_Read(ira, &ra);
+    } else {
+      rv->sz += NumericRange_Add(dst, rb->docId, rb->num.value, 1);
+      hasB = INDEXREAD_OK == IR_Read(irb, &rb);
+    }
+    ++rv->numRecords;
+  }
+
+  IR_Free(ira);
+  IR_Free(irb);
+}
+
+int NumericRangeNode_MergeLeaves(NumericRangeNode *n, NRN_AddRv *rv) {
+  if (NumericRangeNode_IsLeaf(n) || !n->left || !n->right ||
+      !NumericRangeNode_IsLeaf(n->left) || !NumericRangeNode_IsLeaf(n->right) ||
+      !n->left->range || !n->right->range) {
+    return 0;
+  }
+
+  // the two leaves are replaced by one, which is empty only if both of them were
+  rv->emptyLeaves -= (n->left->range->entries->numDocs == 0) + (n->right->range->entries->numDocs == 0);
+
+  // a node that retained its range already holds all the entries of its children
+  if (!n->range) {
+    NumericRange *l = n->left->range;
+    NumericRange *r = n->right->range;
+    NumericRangeNode *merged = NewLeafNode(l->entries->numDocs + r->entries->numDocs + 1,
+                                           MAX(l->splitCard, r->splitCard));
+    n->range = merged->range;
+    rm_free(merged);
+    NumericRange_Merge(n->range, l, r, rv);
+    rv->numRanges++;
+  }
+
+  rv->emptyLeaves += n->range->entries->numDocs == 0;
+
+  removeRange(n->left, rv);
+  removeRange(n->right, rv);
+  NumericRangeNode_Free(n->left);
+  NumericRangeNode_Free(n->right);
+  n->left = NULL;
+  n->right = NULL;
+  n->value = 0;
+  n->maxDepth = 0;
+  rv->changed = 1;
+  return 1;
+}
+
+int NumericRangeNode_UpdateDepth(NumericRangeNode *n, NRN_AddRv *rv) {
+  if (NumericRangeNode_IsLeaf(n)) {
+    n->maxDepth = 0;
+    return 0;
+  }
+
+  n->maxDepth = MAX(NumericRangeNode_UpdateDepth(n->left, rv),
+                    NumericRangeNode_UpdateDepth(n->right, rv)) + 1;
+  // same rule as NumericRangeNode_Add - nodes that became too deep drop their range
+  if (n->maxDepth > RSGlobalConfig.numericTreeMaxDepthRange && n->range) {
+    removeRange(n, rv);
+  }
+  return n->maxDepth;
+}
+
 NRN_AddRv NumericRangeTree_TrimEmptyLeaves(NumericRangeTree *t) {
   NRN_AddRv rv = {.numRanges = 0,
                   .changed = 0 };
@@ -23,6 +23,10 @@ extern "C" {
 #endif
 
 #define NR_CARD_CHECK 10
+// A leaf holding more entries than this is split even if its cardinality is low
+#define NR_MAXRANGE_SIZE 10000
+// Sibling leaves holding together fewer entries than this are merged back by the GC
+#define NR_MINRANGE_SIZE 100
 
 typedef struct {
   double value;
@@ -66,6 +70,7 @@ typedef struct {
   int numRecords;
   int changed;
   int numRanges;
+  int emptyLeaves;
 } NRN_AddRv;
 
 typedef struct {
@@ -118,6 +123,20 @@ Vector *NumericRangeNode_FindRange(NumericRangeNode *n, const NumericFilter *nf)
 /* Recursively free a node and its children */
 void NumericRangeNode_Free(NumericRangeNode *n);
 
+/* Split a leaf into two leaves at the given value. Unlike NumericRange_Split, the split point is
+ * chosen by the caller (the GC uses the median of the remaining values).
+ * Returns 1 if the leaf was split, 0 if the node is not a leaf or the split point is outside of
+ * its range */
+int NumericRangeNode_SplitAt(NumericRangeNode *n, double split, NRN_AddRv *rv);
+
+/* Collapse a node whose children are both leaves into a single leaf holding all their entries.
+ * Returns 1 if the children were merged, 0 otherwise */
+int NumericRangeNode_MergeLeaves(NumericRangeNode *n, NRN_AddRv *rv);
+
+/* Recompute maxDepth of a node and its children after the tree was reshaped outside of
+ * NumericRangeNode_Add. Returns the depth of the node */
+int NumericRangeNode_UpdateDepth(NumericRangeNode *n, NRN_AddRv *rv);
+
 /* Recursively trim empty nodes from tree  */
 NRN_AddRv NumericRangeTree_TrimEmptyLeaves(NumericRangeTree *t);
 
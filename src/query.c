@@ -132,6 +132,155 @@ void QueryNode_Free(QueryNode *n) {
   rm_free(n);
 }
 
+// A block of memory copied while cloning a node, which parameter targets may point into
+typedef struct {
+  const void *from;
+  void *to;
+  size_t size;
+} CloneRegion;
+
+static void *cloneRemapTarget(const CloneRegion *regions, size_t nregions, const void *target) {
+  if (!target) {
+    return NULL;
+  }
+  for (size_t ii = 0; ii < nregions; ++ii) {
+    const char *from = regions[ii].from;
+    if ((const char *)target >= from && (const char *)target < from + regions[ii].size) {
+      return (char *)regions[ii].to + ((const char *)target - from);
+    }
+  }
+  RS_LOG_ASSERT(0, "parameter target is not part of its query node");
+  return NULL;
+}
+
+static char *cloneStr(const char *s) {
+  return s ? rm_strdup(s) : NULL;
+}
+
+static void cloneToken(RSToken *dst, const RSToken *src) {
+  *dst = *src;
+  dst->str = src->str ? rm_strndup(src->str, src->len) : NULL;
+}
+
+static VectorQuery *cloneVectorQuery(const VectorQuery *src) {
+  VectorQuery *vq = rm_malloc(sizeof(*vq));
+  *vq = *src;
+  vq->property = cloneStr(src->property);
+  vq->scoreField = cloneStr(src->scoreField);
+  vq->results = NULL;
+  vq->resultsLen = 0;
+  vq->params.params = NULL;
+  vq->params.needResolve = NULL;
+  if (src->params.params) {
+    size_t nparams = array_len(src->params.params);
+    vq->params.params = array_new(VecSimRawParam, nparams);
+    vq->params.needResolve = array_new(bool, nparams);
+    for (size_t ii = 0; ii < nparams; ++ii) {
+      VecSimRawParam p = src->params.params[ii];
+      p.name = rm_strndup(p.name, p.nameLen);
+      p.value = rm_strndup(p.value, p.valLen);
+      vq->params.params = array_append(vq->params.params, p);
+      vq->params.needResolve = array_append(vq->params.needResolve, src->params.needResolve[ii]);
+    }
+  }
+  return vq;
+}
+
+QueryNode *QueryNode_Clone(const QueryNode *n) {
+  QueryNode *ret = rm_malloc(sizeof(*ret));
+  *ret = *n;
+  ret->children = NULL;
+  ret->params = NULL;
+  ret->opts.distField = cloneStr(n->opts.distField);
+
+  // parameters point into the node itself or into the filter it owns
+  CloneRegion regions[2] = {{.from = n, .to = ret, .size = sizeof(*n)}};
+  size_t nregions = 1;
+
+  switch (n->type) {
+    case QN_TOKEN:
+      cloneToken(&ret->tn, &n->tn);
+      break;
+    case QN_PREFIX:
+      cloneToken(&ret->pfx.tok, &n->pfx.tok);
+      break;
+    case QN_FUZZY:
+      cloneToken(&ret->fz.tok, &n->fz.tok);
+      break;
+    case QN_WILDCARD_QUERY:
+      cloneToken(&ret->verb.tok, &n->verb.tok);
+      break;
+    case QN_NUMERIC: {
+      NumericFilter *nf = rm_malloc(sizeof(*nf));
+      *nf = *n->nn.nf;
+      nf->fieldName = cloneStr(n->nn.nf->fieldName);
+      regions[nregions++] = (CloneRegion){.from = n->nn.nf, .to = nf, .size = sizeof(*nf)};
+      ret->nn.nf = nf;
+      break;
+    }
+    case QN_GEO:
+      if (n->gn.gf) {
+        GeoFilter *gf = rm_malloc(sizeof(*gf));
+        *gf = *n->gn.gf;
+        gf->property = cloneStr(n->gn.gf->property);
+        gf->numericFilters = NULL;
+        regions[nregions++] = (CloneRegion){.from = n->gn.gf, .to = gf, .size = sizeof(*gf)};
+        ret->gn.gf = gf;
+      }
+      break;
+    case QN_GEOMETRY:
+      if (n->gmn.geomq) {
+        GeometryQuery *geomq = rm_malloc(sizeof(*geomq));
+        *geomq = *n->gmn.geomq;
+        geomq->attr = cloneStr(n->gmn.geomq->attr);
+        geomq->str = n->gmn.geomq->str ? rm_strndup(n->gmn.geomq->str, n->gmn.geomq->str_len) : NULL;
+        regions[nregions++] = (CloneRegion){.from = n->gmn.geomq, .to = geomq, .size = sizeof(*geomq)};
+        ret->gmn.geomq = geomq;
+      }
+      break;
+    case QN_VECTOR:
+      if (n->vn.vq) {
+        ret->vn.vq = cloneVectorQuery(n->vn.vq);
+        regions[nregions++] = (CloneRegion){.from = n->vn.vq, .to = ret->vn.vq, .size = sizeof(VectorQuery)};
+      }
+      break;
+    case QN_LEXRANGE:
+      ret->lxrng.begin = cloneStr(n->lxrng.begin);
+      ret->lxrng.end = cloneStr(n->lxrng.end);
+      break;
+    case QN_TAG:
+      ret->tag.fieldName = rm_strndup(n->tag.fieldName, n->tag.len);
+      break;
+    case QN_IDS:  // the ids are not owned by the node
+    case QN_WILDCARD:
+    case QN_UNION:
+    case QN_NOT:
+    case QN_OPTIONAL:
+    case QN_NULL:
+    case QN_PHRASE:
+      break;
+  }
+
+  if (n->params) {
+    ret->params = array_newlen(Param, QueryNode_NumParams(n));
+    for (size_t ii = 0; ii < QueryNode_NumParams(n); ++ii) {
+      Param *p = ret->params + ii;
+      *p = n->params[ii];
+      p->name = p->name ? rm_strndup(p->name, p->len) : NULL;
+      p->target = cloneRemapTarget(regions, nregions, p->target);
+      p->target_len = cloneRemapTarget(regions, nregions, p->target_len);
+    }
+  }
+
+  if (n->children) {
+    ret->children = array_new(QueryNode *, QueryNode_NumChildren(n));
+    for (size_t ii = 0; ii < QueryNode_NumChildren(n); ++ii) {
+      ret->children = array_append(ret->children, QueryNode_Clone(n->children[ii]));
+    }
+  }
+  return ret;
+}
+
 void RangeNumber_Free(RangeNumber *r) {
   rm_free(r);
 }
@@ -1429,6 +1578,7 @@ int QAST_Parse(QueryAST *dst, const RedisSearchCtx *sctx, const RSSearchOptions
   }
   dst->numTokens = qpCtx.numTokens;
   dst->numParams = qpCtx.numParams;
+  dst->paramsInlined = qpCtx.paramsInlined;
   return REDISMODULE_OK;
 }
 
@@ -1460,6 +1610,7 @@ void QAST_Destroy(QueryAST *q) {
   q->metricRequests = NULL;
   q->numTokens = 0;
   q->numParams = 0;
+  q->paramsInlined = false;
   rm_free(q->query);
   q->nquery = 0;
   q->query = NULL;
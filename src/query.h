@@ -43,6 +43,8 @@ typedef struct MetricRequest{
 typedef struct QueryAST {
   size_t numTokens;
   size_t numParams;
+  // Parameters were substituted by the parser, the tree cannot be reused with other values
+  bool paramsInlined;
   QueryNode *root;
   // User data and length, for use by scorers
   const void *udata;
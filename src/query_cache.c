@@ -0,0 +1,165 @@
+/*
+ * Copyright Redis Ltd. 2016 - present
+ * Licensed under your choice of the Redis Source Available License 2.0 (RSALv2) or
+ * the Server Side Public License v1 (SSPLv1).
+ */
+
+#include "query_cache.h"
+#include "config.h"
+#include "rmalloc.h"
+
+static QueryCache *QueryCache_New() {
+  QueryCache *cache = rm_calloc(1, sizeof(*cache));
+  cache->entries = dictCreate(&dictTypeHeapStrings, NULL);
+  pthread_mutex_init(&cache->lock, NULL);
+  return cache;
+}
+
+static void QueryCacheEntry_Free(QueryCacheEntry *e) {
+  QueryNode_Free(e->root);
+  rm_free(e->key);
+  rm_free(e);
+}
+
+static void QueryCache_Unlink(QueryCache *cache, QueryCacheEntry *e) {
+  if (e->prev) {
+    e->prev->next = e->next;
+  } else {
+    cache->head = e->next;
+  }
+  if (e->next) {
+    e->next->prev = e->prev;
+  } else {
+    cache->tail = e->prev;
+  }
+  e->prev = e->next = NULL;
+}
+
+static void QueryCache_PushFront(QueryCache *cache, QueryCacheEntry *e) {
+  e->prev = NULL;
+  e->next = cache->head;
+  if (cache->head) {
+    cache->head->prev = e;
+  } else {
+    cache->tail = e;
+  }
+  cache->head = e;
+}
+
+// Assuming the cache is locked
+static void QueryCache_ClearUnsafe(QueryCache *cache) {
+  QueryCacheEntry *e = cache->head;
+  while (e) {
+    QueryCacheEntry *next = e->next;
+    QueryCacheEntry_Free(e);
+    e = next;
+  }
+  cache->head = cache->tail = NULL;
+  dictEmpty(cache->entries, NULL);
+}
+
+void QueryCache_Free(QueryCache *cache) {
+  QueryCache_ClearUnsafe(cache);
+  dictRelease(cache->entries);
+  pthread_mutex_destroy(&cache->lock);
+  rm_free(cache);
+}
+
+void QueryCache_Clear(QueryCache *cache) {
+  pthread_mutex_lock(&cache->lock);
+  QueryCache_ClearUnsafe(cache);
+  pthread_mutex_unlock(&cache->lock);
+}
+
+void QueryCache_RenderStats(QueryCache *cache, RedisModule_Reply *reply) {
+  pthread_mutex_lock(&cache->lock);
+
+  RedisModule_ReplyKV_Map(reply, "query_cache_stats");
+    RedisModule_ReplyKV_LongLong(reply, "entries", dictSize(cache->entries));
+    RedisModule_ReplyKV_LongLong(reply, "hits", cache->hits);
+    RedisModule_ReplyKV_LongLong(reply, "misses", cache->misses);
+  RedisModule_Reply_MapEnd(reply);
+
+  pthread_mutex_unlock(&cache->lock);
+}
+
+// The cache of an index is created on its first query, possibly by several queries at once
+static QueryCache *IndexSpec_GetQueryCache(IndexSpec *sp) {
+  QueryCache *cache = __atomic_load_n(&sp->queryCache, __ATOMIC_ACQUIRE);
+  if (cache) {
+    return cache;
+  }
+  QueryCache *new_cache = QueryCache_New();
+  if (!__atomic_compare_exchange_n(&sp->queryCache, &cache, new_cache, false, __ATOMIC_ACQ_REL,
+                                   __ATOMIC_ACQUIRE)) {
+    QueryCache_Free(new_cache);
+    return cache;
+  }
+  return new_cache;
+}
+
+int QAST_ParseCached(QueryAST *dst, const RedisSearchCtx *sctx, const RSSearchOptions *opts,
+                     const char *q, size_t n, unsigned int dialectVersion, QueryError *status) {
+  size_t capacity = RSGlobalConfig.queryCacheSize;
+  if (!capacity || !sctx->spec) {
+    return QAST_Parse(dst, sctx, opts, q, n, dialectVersion, status);
+  }
+  QueryCache *cache = IndexSpec_GetQueryCache(sctx->spec);
+
+  // stopwords are dropped by the parser, the index stopwords are fixed once it is created
+  char *key;
+  rm_asprintf(&key, "%u:%d:%.*s", dialectVersion, opts->stopwords != NULL, (int)n, q);
+
+  pthread_mutex_lock(&cache->lock);
+  dictEntry *de = dictFind(cache->entries, key);
+  if (de) {
+    QueryCacheEntry *e = dictGetVal(de);
+    QueryCache_Unlink(cache, e);
+    QueryCache_PushFront(cache, e);
+    cache->hits++;
+    // clone while locked, the entry may be evicted as soon as the cache is unlocked
+    dst->root = QueryNode_Clone(e->root);
+    dst->numTokens = e->numTokens;
+    dst->numParams = e->numParams;
+    pthread_mutex_unlock(&cache->lock);
+
+    if (!dst->query) {
+      dst->query = rm_strndup(q, n);
+      dst->nquery = n;
+    }
+    rm_free(key);
+    return REDISMODULE_OK;
+  }
+  cache->misses++;
+  pthread_mutex_unlock(&cache->lock);
+
+  int rc = QAST_Parse(dst, sctx, opts, q, n, dialectVersion, status);
+  if (rc != REDISMODULE_OK || dst->paramsInlined) {
+    rm_free(key);
+    return rc;
+  }
+
+  // the parsed tree is cached before its parameters are evaluated
+  QueryCacheEntry *e = rm_calloc(1, sizeof(*e));
+  e->key = key;
+  e->root = QueryNode_Clone(dst->root);
+  e->numTokens = dst->numTokens;
+  e->numParams = dst->numParams;
+
+  pthread_mutex_lock(&cache->lock);
+  if (dictAdd(cache->entries, key, e) != DICT_OK) {
+    // parsed concurrently by another query
+    pthread_mutex_unlock(&cache->lock);
+    QueryCacheEntry_Free(e);
+    return rc;
+  }
+  QueryCache_PushFront(cache, e);
+  while (dictSize(cache->entries) > capacity) {
+    QueryCacheEntry *lru = cache->tail;
+    QueryCache_Unlink(cache, lru);
+    dictDelete(cache->entries, lru->key);
+    QueryCacheEntry_Free(lru);
+  }
+  pthread_mutex_unlock(&cache->lock);
+  return rc;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright Redis Ltd. 2016 - present
+ * Licensed under your choice of the Redis Source Available License 2.0 (RSALv2) or
+ * the Server Side Public License v1 (SSPLv1).
+ */
+
+#pragma once
+
+#include "query.h"
+#include "spec.h"
+#include "reply.h"
+#include "util/dict.h"
+
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * An entry of the query cache: a query tree as parsed, before its parameters are evaluated and
+ * before it is expanded.
+ */
+typedef struct QueryCacheEntry {
+  char *key;
+  QueryNode *root;
+  size_t numTokens;
+  size_t numParams;
+  struct QueryCacheEntry *prev;
+  struct QueryCacheEntry *next;
+} QueryCacheEntry;
+
+/*
+ * A per index LRU cache of parsed queries, keyed by the dialect, the options the parser depends on
+ * and the query string. Queries which differ only by their PARAMS values share an entry.
+ * The cache is accessed by concurrent queries and is protected by its own lock.
+ */
+typedef struct QueryCache {
+  dict *entries;
+  // most recently used first
+  QueryCacheEntry *head;
+  QueryCacheEntry *tail;
+  size_t hits;
+  size_t misses;
+  pthread_mutex_t lock;
+} QueryCache;
+
+void QueryCache_Free(QueryCache *cache);
+
+/* Drop all the entries of the cache. Used when the index schema changes */
+void QueryCache_Clear(QueryCache *cache);
+
+void QueryCache_RenderStats(QueryCache *cache, RedisModule_Reply *reply);
+
+/**
+ * Parse the query string into an AST, same as QAST_Parse, reusing a cached tree of the index if
+ * the query was parsed before. Query caching is enabled by QUERY_CACHE_SIZE.
+ */
+int QAST_ParseCached(QueryAST *dst, const RedisSearchCtx *sctx, const RSSearchOptions *opts,
+                     const char *q, size_t n, unsigned int dialectVersion, QueryError *status);
+
+#ifdef __cplusplus
+}
+#endif
@@ -28,6 +28,9 @@ extern "C" {
   // the param count
   size_t numParams;
 
+  // whether parameters were substituted while parsing, making the tree specific to their values
+  bool paramsInlined;
+
   // Index spec
   RedisSearchCtx *sctx;
 
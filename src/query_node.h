@@ -211,6 +211,9 @@ typedef struct RSQueryNode {
 int QueryNode_ApplyAttributes(QueryNode *qn, QueryAttribute *attr, size_t len, QueryError *status);
 int QueryNode_CheckAllowSlopAndInorder(QueryNode *qn, const IndexSpec *spec, bool anyField, QueryError *status);
 
+/* Deep copy a query node and its children, including its unresolved parameters */
+QueryNode *QueryNode_Clone(const QueryNode *n);
+
 void QueryNode_AddChildren(QueryNode *parent, QueryNode **children, size_t n);
 void QueryNode_AddChild(QueryNode *parent, QueryNode *child);
 void QueryNode_ClearChildren(QueryNode *parent, int shouldFree);
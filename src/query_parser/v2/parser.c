@@ -1695,6 +1695,7 @@ static YYACTIONTYPE yy_reduce(
   const char *value = rm_strndup(yymsp[0].minor.yy0.s, yymsp[0].minor.yy0.len);
   size_t value_len = yymsp[0].minor.yy0.len;
   if (yymsp[0].minor.yy0.type == QT_PARAM_TERM) {
+    ctx->paramsInlined = true;
     size_t found_value_len;
     const char *found_value = Param_DictGet(ctx->opts->params, value, &found_value_len, ctx->status);
     if (found_value) {
@@ -506,6 +506,7 @@ attribute(A) ::= ATTRIBUTE(B) COLON param_term(C). {
   const char *value = rm_strndup(C.s, C.len);
   size_t value_len = C.len;
   if (C.type == QT_PARAM_TERM) {
+    ctx->paramsInlined = true;
     size_t found_value_len;
     const char *found_value = Param_DictGet(ctx->opts->params, value, &found_value_len, ctx->status);
     if (found_value) {
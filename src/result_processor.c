@@ -14,6 +14,7 @@
 #include "rmutil/cxx/chrono-clock.h"
 #include "util/timeout.h"
 #include "util/arr.h"
+#include "result_spill.h"
 
 /*******************************************************************************************************************
  *  General Result Processor Helper functions
@@ -335,6 +336,37 @@ ResultProcessor *RPMetricsLoader_New() {
 
 typedef int (*RPSorterCompareFunc)(const void *e1, const void *e2, const void *udata);
 
+/**
+ * A normalized sort key of a single field, computed once when the result reaches the sorter.
+ *
+ * Numbers and strings are mapped to unsigned integers with the same order as RSValue_Cmp(), with
+ * the sort direction folded in, so that a greater key always ranks higher. Strings are truncated
+ * to their first 8 bytes - when the truncated keys are equal (or the values can not be mapped),
+ * the values themselves are compared.
+ */
+typedef struct {
+  uint64_t bits;
+  uint8_t type;   // RPSortKeyType
+  uint8_t exact;  // equal bits mean equal values
+} RPSortKey;
+
+typedef enum {
+  RPSortKey_Missing = 0,
+  RPSortKey_Null,
+  RPSortKey_Number,
+  RPSortKey_String,  // only comparable with keys of the same RSValue type
+  RPSortKey_RedisString,
+  RPSortKey_OwnRstring,
+  RPSortKey_Other,  // always compared by value
+} RPSortKeyType;
+
+/* A result on the heap of the sorter, followed by its sort keys */
+typedef struct {
+  SearchResult r;
+  size_t run;  // the spilled run the result was read from
+  RPSortKey keys[];
+} RPSorterResult;
+
 typedef struct {
   ResultProcessor base;
 
@@ -355,8 +387,100 @@ typedef struct {
     size_t nkeys;
     uint64_t ascendMap;
   } fieldcmp;
+
+  // Spilling. If the sorter may return more results than the threshold, the heap is limited to
+  // the threshold, and whenever it is full, its results are written as a sorted run to a
+  // temporary file. The runs and the heap are then merged when yielding.
+  struct {
+    size_t threshold;
+    size_t limit;       // the number of results to return
+    size_t numYielded;
+    SpillRun **runs;
+    mm_heap_t *heads;   // the next result of every run
+  } spill;
 } RPSorter;
 
+static void srDtor(void *p) {
+  if (p) {
+    SearchResult_Destroy(p);
+    rm_free(p);
+  }
+}
+
+static SearchResult *rpsortNewResult(const RPSorter *self) {
+  return rm_calloc(1, sizeof(RPSorterResult) + self->fieldcmp.nkeys * sizeof(RPSortKey));
+}
+
+static void rpsortComputeKey(const RSValue *v, int ascending, RPSortKey *key) {
+  const char *str;
+  size_t len;
+  key->bits = 0;
+  key->exact = 1;
+
+  if (!v) {
+    key->type = RPSortKey_Missing;
+    return;
+  }
+
+  switch (v->t) {
+    case RSValue_Null:
+      key->type = RPSortKey_Null;
+      return;
+
+    case RSValue_Number: {
+      double d = v->numval;
+      if (isnan(d)) {
+        key->type = RPSortKey_Other;
+        return;
+      }
+      if (d == 0) {
+        d = 0;  // -0 == 0
+      }
+      uint64_t u;
+      memcpy(&u, &d, sizeof(u));
+      // flip the negatives so that the bits of all numbers are ordered as unsigned integers
+      key->bits = (u & (1ULL << 63)) ? ~u : (u | (1ULL << 63));
+      key->type = RPSortKey_Number;
+      break;
+    }
+
+    case RSValue_String:
+    case RSValue_RedisString:
+    case RSValue_OwnRstring: {
+      str = RSValue_StringPtrLen(v, &len);
+      size_t n = len < sizeof(key->bits) ? len : sizeof(key->bits);
+      // strings are compared with strncmp(), which stops at the first NUL
+      if (memchr(str, '\0', n)) {
+        key->type = RPSortKey_Other;
+        return;
+      }
+      for (size_t i = 0; i < sizeof(key->bits); i++) {
+        key->bits = (key->bits << 8) | (i < n ? (uint8_t)str[i] : 0);
+      }
+      key->exact = len <= sizeof(key->bits);
+      key->type = v->t == RSValue_String        ? RPSortKey_String
+                  : v->t == RSValue_RedisString ? RPSortKey_RedisString
+                                                : RPSortKey_OwnRstring;
+      break;
+    }
+
+    default:
+      key->type = RPSortKey_Other;
+      return;
+  }
+
+  if (ascending) {
+    key->bits = ~key->bits;
+  }
+}
+
+static void rpsortComputeKeys(const RPSorter *self, RPSorterResult *res) {
+  for (size_t i = 0; i < self->fieldcmp.nkeys && i < SORTASCMAP_MAXFIELDS; i++) {
+    const RSValue *v = RLookup_GetItem(self->fieldcmp.keys[i], &res->r.rowdata);
+    rpsortComputeKey(v, SORTASCMAP_GETASC(self->fieldcmp.ascendMap, i), &res->keys[i]);
+  }
+}
+
 /* Yield - pops the current top result from the heap */
 static int rpsortNext_Yield(ResultProcessor *rp, SearchResult *r) {
   RPSorter *self = (RPSorter *)rp;
@@ -373,6 +497,95 @@ static int rpsortNext_Yield(ResultProcessor *rp, SearchResult *r) {
   return RS_RESULT_EOF;
 }
 
+/* Read the next result of a spilled run into the merge heap. Returns 0 if it can not be read */
+static int rpsortReadRun(RPSorter *self, size_t run) {
+  RPSorterResult *next = (RPSorterResult *)rpsortNewResult(self);
+  int rc = SpillRun_Read(self->spill.runs[run], &next->r);
+  if (rc != 1) {
+    srDtor(next);
+    return rc == 0;
+  }
+  next->run = run;
+  if (self->fieldcmp.nkeys) {
+    rpsortComputeKeys(self, next);
+  }
+  mmh_insert(self->spill.heads, next);
+  return 1;
+}
+
+static int rpsortSpillError(ResultProcessor *rp) {
+  if (rp->parent->err) {
+    QueryError_SetError(rp->parent->err, QUERY_EGENERIC, "Could not spill sorted results to disk");
+  }
+  return RS_RESULT_ERROR;
+}
+
+/* Yield - pops the current top result from either the spilled runs or the heap */
+static int rpsortNext_YieldSpilled(ResultProcessor *rp, SearchResult *r) {
+  RPSorter *self = (RPSorter *)rp;
+  if (self->spill.numYielded == self->spill.limit) {
+    return RS_RESULT_EOF;
+  }
+
+  RPSorterResult *fromRun = mmh_peek_max(self->spill.heads);
+  SearchResult *fromHeap = mmh_peek_max(self->pq);
+  SearchResult *cur_best;
+  if (fromRun && (!fromHeap || self->cmp(fromRun, fromHeap, self->cmpCtx) > 0)) {
+    cur_best = mmh_pop_max(self->spill.heads);
+    if (!rpsortReadRun(self, fromRun->run)) {
+      srDtor(cur_best);
+      return rpsortSpillError(rp);
+    }
+  } else if (fromHeap) {
+    cur_best = mmh_pop_max(self->pq);
+  } else {
+    return RS_RESULT_EOF;
+  }
+
+  self->spill.numYielded++;
+  RLookupRow oldrow = r->rowdata;
+  *r = *cur_best;
+  rm_free(cur_best);
+  RLookupRow_Cleanup(&oldrow);
+  return RS_RESULT_OK;
+}
+
+/* Write the results of the (full) heap as a sorted run */
+static int rpsortSpill(RPSorter *self) {
+  SpillRun *run = SpillRun_New();
+  if (!run) {
+    return REDISMODULE_ERR;
+  }
+  *array_ensure_tail(&self->spill.runs, SpillRun *) = run;
+
+  int rc = REDISMODULE_OK;
+  SearchResult *cur;
+  while ((cur = mmh_pop_max(self->pq))) {
+    if (SpillRun_Write(run, cur) != REDISMODULE_OK) {
+      rc = REDISMODULE_ERR;
+    }
+    srDtor(cur);
+  }
+  if (rc == REDISMODULE_OK) {
+    rc = SpillRun_Seal(run);
+  }
+  return rc;
+}
+
+/* Start merging the spilled runs with the remaining results of the heap */
+static int rpsortStartMerge(ResultProcessor *rp, SearchResult *r) {
+  RPSorter *self = (RPSorter *)rp;
+  size_t nruns = array_len(self->spill.runs);
+  self->spill.heads = mmh_init_with_size(nruns, self->cmp, self->cmpCtx, srDtor);
+  for (size_t ii = 0; ii < nruns; ++ii) {
+    if (!rpsortReadRun(self, ii)) {
+      return rpsortSpillError(rp);
+    }
+  }
+  rp->Next = rpsortNext_YieldSpilled;
+  return rpsortNext_YieldSpilled(rp, r);
+}
+
 static void rpsortFree(ResultProcessor *rp) {
   RPSorter *self = (RPSorter *)rp;
 
@@ -381,6 +594,14 @@ static void rpsortFree(ResultProcessor *rp) {
 
   // calling mmh_free will free all the remaining results in the heap, if any
   mmh_free(self->pq);
+
+  if (self->spill.heads) {
+    mmh_free(self->spill.heads);
+  }
+  for (size_t ii = 0; ii < array_len(self->spill.runs); ++ii) {
+    SpillRun_Free(self->spill.runs[ii]);
+  }
+  array_free(self->spill.runs);
   rm_free(rp);
 }
 
@@ -395,6 +616,9 @@ static int rpsortNext_innerLoop(ResultProcessor *rp, SearchResult *r) {
   // if our upstream has finished - just change the state to not accumulating, and yield
   if (rc == RS_RESULT_EOF || (rc == RS_RESULT_TIMEDOUT && rp->parent->timeoutPolicy == TimeoutPolicy_Return)) {
     // Transition state:
+    if (self->spill.runs) {
+      return rpsortStartMerge(rp, r);
+    }
     rp->Next = rpsortNext_Yield;
     return rpsortNext_Yield(rp, r);
   } else if (rc != RS_RESULT_OK) {
@@ -402,6 +626,17 @@ static int rpsortNext_innerLoop(ResultProcessor *rp, SearchResult *r) {
     return rc;
   }
 
+  if (self->fieldcmp.nkeys) {
+    rpsortComputeKeys(self, (RPSorterResult *)self->pooledResult);
+  }
+
+  // When spilling, the heap holds all the results until it is full
+  if (self->spill.threshold && self->pq->count == self->pq->size) {
+    if (rpsortSpill(self) != REDISMODULE_OK) {
+      return rpsortSpillError(rp);
+    }
+  }
+
   // If the queue is not full - we just push the result into it
   if (self->pq->count < self->pq->size) {
 
@@ -412,7 +647,7 @@ static int rpsortNext_innerLoop(ResultProcessor *rp, SearchResult *r) {
       rp->parent->minScore = self->pooledResult->score;
     }
     // we need to allocate a new result for the next iteration
-    self->pooledResult = rm_calloc(1, sizeof(*self->pooledResult));
+    self->pooledResult = rpsortNewResult(self);
   } else {
     // find the min result
     SearchResult *minh = mmh_peek_min(self->pq);
@@ -456,10 +691,10 @@ static inline int cmpByScore(const void *e1, const void *e2, const void *udata)
   return h1->docId > h2->docId ? -1 : 1;
 }
 
-/* Compare results for the heap by sorting key */
+/* Compare results for the heap by their sort keys, falling back to their values */
 static int cmpByFields(const void *e1, const void *e2, const void *udata) {
   const RPSorter *self = udata;
-  const SearchResult *h1 = e1, *h2 = e2;
+  const RPSorterResult *h1 = e1, *h2 = e2;
   int ascending = 0;
 
   QueryError *qerr = NULL;
@@ -468,15 +703,14 @@ static int cmpByFields(const void *e1, const void *e2, const void *udata) {
   }
 
   for (size_t i = 0; i < self->fieldcmp.nkeys && i < SORTASCMAP_MAXFIELDS; i++) {
-    const RSValue *v1 = RLookup_GetItem(self->fieldcmp.keys[i], &h1->rowdata);
-    const RSValue *v2 = RLookup_GetItem(self->fieldcmp.keys[i], &h2->rowdata);
+    const RPSortKey *k1 = &h1->keys[i], *k2 = &h2->keys[i];
     // take the ascending bit for this property from the ascending bitmap
     ascending = SORTASCMAP_GETASC(self->fieldcmp.ascendMap, i);
-    if (!v1 || !v2) {
+    if (k1->type == RPSortKey_Missing || k2->type == RPSortKey_Missing) {
       // If at least one of these has no sort key, it gets high value regardless of asc/desc
-      if (v1) {
+      if (k1->type != RPSortKey_Missing) {
         return 1;
-      } else if (v2) {
+      } else if (k2->type != RPSortKey_Missing) {
         return -1;
       } else {
         // Both have no sort key, so they are equal. Continue to next sort key
@@ -484,28 +718,26 @@ static int cmpByFields(const void *e1, const void *e2, const void *udata) {
       }
     }
 
-    int rc = RSValue_Cmp(v1, v2, qerr);
-    // printf("asc? %d Compare: \n", ascending);
-    // RSValue_Print(v1);
-    // printf(" <=> ");
-    // RSValue_Print(v2);
-    // printf("\n");
+    if (k1->type == k2->type && k1->type != RPSortKey_Other) {
+      if (k1->bits != k2->bits) {
+        return k1->bits > k2->bits ? 1 : -1;
+      } else if (k1->exact && k2->exact) {
+        continue;
+      }
+    }
 
+    const RSValue *v1 = RLookup_GetItem(self->fieldcmp.keys[i], &h1->r.rowdata);
+    const RSValue *v2 = RLookup_GetItem(self->fieldcmp.keys[i], &h2->r.rowdata);
+    int rc = RSValue_Cmp(v1, v2, qerr);
     if (rc != 0) return ascending ? -rc : rc;
   }
 
-  int rc = h1->docId < h2->docId ? -1 : 1;
+  int rc = h1->r.docId < h2->r.docId ? -1 : 1;
   return ascending ? -rc : rc;
 }
 
-static void srDtor(void *p) {
-  if (p) {
-    SearchResult_Destroy(p);
-    rm_free(p);
-  }
-}
-
-ResultProcessor *RPSorter_NewByFields(size_t maxresults, const RLookupKey **keys, size_t nkeys, uint64_t ascmap) {
+ResultProcessor *RPSorter_NewByFields(size_t maxresults, const RLookupKey **keys, size_t nkeys,
+                                      uint64_t ascmap, size_t spillThreshold) {
 
   RPSorter *ret = rm_calloc(1, sizeof(*ret));
   ret->cmp = nkeys ? cmpByFields : cmpByScore;
@@ -514,16 +746,21 @@ ResultProcessor *RPSorter_NewByFields(size_t maxresults, const RLookupKey **keys
   ret->fieldcmp.keys = keys;
   ret->fieldcmp.nkeys = nkeys;
 
+  if (spillThreshold && maxresults > spillThreshold) {
+    ret->spill.threshold = spillThreshold;
+    ret->spill.limit = maxresults;
+    maxresults = spillThreshold;
+  }
   ret->pq = mmh_init_with_size(maxresults, ret->cmp, ret->cmpCtx, srDtor);
-  ret->pooledResult = rm_calloc(1, sizeof(*ret->pooledResult));
+  ret->pooledResult = rpsortNewResult(ret);
   ret->base.Next = rpsortNext_Accum;
   ret->base.Free = rpsortFree;
   ret->base.type = RP_SORTER;
   return &ret->base;
 }
 
-ResultProcessor *RPSorter_NewByScore(size_t maxresults) {
-  return RPSorter_NewByFields(maxresults, NULL, 0, 0);
+ResultProcessor *RPSorter_NewByScore(size_t maxresults, size_t spillThreshold) {
+  return RPSorter_NewByFields(maxresults, NULL, 0, 0, spillThreshold);
 }
 
 void SortAscMap_Dump(uint64_t tt, size_t n) {
@@ -694,13 +931,20 @@ static ResultProcessor *RPPlainLoader_New(RedisSearchCtx *sctx, RLookup *lk, con
  *
  * The RP has few phases:
  * 1. Buffering phase - the RP will buffer the results from the upstream.
- * 2. Loading phase:
- *   a. Verify that the spec is unlocked, and lock the Redis keyspace.
- *   b. Load the needed data for each buffered result.
+ * 2. Loading phase - verify that the spec is unlocked, then for each chunk of the buffered results:
+ *   a. Lock the Redis keyspace.
+ *   b. Load the needed data for each result of the chunk. The fields of hash documents are only
+ *      fetched here, as raw strings.
  *   c. Unlock the Redis keyspace.
+ *   d. Convert the fetched fields into the results' rows.
+ *    Loading in chunks bounds the time Redis is locked by the loader, so writes are not held back
+ *    for a whole buffer.
  * 3. Yielding phase - the RP will yield the buffered results.
  *******************************************************************************************************************/
 
+// Number of results loaded each time the safe loader locks Redis
+#define SAFE_LOADER_CHUNK_SIZE 128
+
 typedef struct RPSafeLoader {
   // Loading context
   RPLoader base_loader;
@@ -715,6 +959,10 @@ typedef struct RPSafeLoader {
 
   // Last buffered result code. To know weather to return OK or EOF.
   char last_buffered_rc;
+
+  // Raw hash fields fetched for the current chunk, `nkeys` per result. NULL if the loader doesn't
+  // load a list of keys.
+  RedisModuleString **fetched;
 } RPSafeLoader;
 
 /************************* Safe Loader private functions *************************/
@@ -794,13 +1042,53 @@ static int rpSafeLoader_ResetAndReturnLastCode(RPSafeLoader *self) {
 
 /*********************************************************************************/
 
+// Like `rpLoader_loadDocument`, but only fetches the fields of a hash document into `vals`
+static void rpLoader_fetchHashFields(RPLoader *self, SearchResult *r, RedisModuleString **vals) {
+  memset(vals, 0, sizeof(*vals) * self->loadopts.nkeys);
+  if ((r->dmd->flags & Document_FailedToOpen) || (r->dmd->flags & Document_Deleted)) {
+    return;
+  }
+
+  self->loadopts.dmd = r->dmd;
+  if (RLookup_FetchHashFields(&r->rowdata, &self->loadopts, vals) != REDISMODULE_OK) {
+    ((RSDocumentMetadata *)(r->dmd))->flags |= Document_FailedToOpen;
+    QueryError_ClearError(&self->status);
+  }
+}
+
 static void rpSafeLoader_Load(RPSafeLoader *self) {
+  RPLoader *loader = &self->base_loader;
+  RedisModuleCtx *redisCtx = loader->loadopts.sctx->redisCtx;
+  size_t nkeys = loader->loadopts.nkeys;
   SearchResult *curr_res;
 
-  // iterate the buffer.
-  // TODO: implement `GetNextResult` that gets the current block to save calculation time.
-  while ((curr_res = GetNextResult(self))) {
-    rpLoader_loadDocument(&self->base_loader, curr_res);
+  while (self->curr_result_index < self->buffer_results_count) {
+    size_t chunk_start = self->curr_result_index;
+    size_t chunk_len = MIN(SAFE_LOADER_CHUNK_SIZE, self->buffer_results_count - chunk_start);
+
+    // Lock Redis to guarantee safe access to Redis keyspace
+    RedisModule_ThreadSafeContextLock(redisCtx);
+    for (size_t ii = 0; ii < chunk_len; ++ii) {
+      curr_res = GetNextResult(self);
+      if (self->fetched && curr_res->dmd->type == DocumentType_Hash) {
+        rpLoader_fetchHashFields(loader, curr_res, self->fetched + ii * nkeys);
+      } else {
+        rpLoader_loadDocument(loader, curr_res);
+      }
+    }
+    RedisModule_ThreadSafeContextUnlock(redisCtx);
+
+    if (!self->fetched) {
+      continue;
+    }
+    // Convert the fetched fields, without holding the lock
+    self->curr_result_index = chunk_start;
+    for (size_t ii = 0; ii < chunk_len; ++ii) {
+      curr_res = GetNextResult(self);
+      if (curr_res->dmd->type == DocumentType_Hash) {
+        RLookup_WriteHashFields(&curr_res->rowdata, &loader->loadopts, self->fetched + ii * nkeys);
+      }
+    }
   }
 
   // Reset the iterator
@@ -857,14 +1145,9 @@ static int rpSafeLoaderNext_Accumulate(ResultProcessor *rp, SearchResult *res) {
   // First, we verify that we unlocked the spec before we lock Redis.
   RedisSearchCtx_UnlockSpec(sctx);
 
-  // Then, lock Redis to guarantee safe access to Redis keyspace
-  RedisModule_ThreadSafeContextLock(sctx->redisCtx);
-
+  // Then, load the results, locking Redis for a chunk of them at a time
   rpSafeLoader_Load(self);
 
-  // Done loading. Unlock Redis
-  RedisModule_ThreadSafeContextUnlock(sctx->redisCtx);
-
   // Move to the yielding phase
   rp->Next = rpSafeLoaderNext_Yield;
   return rp->Next(rp, res);
@@ -883,6 +1166,7 @@ static void rpSafeLoaderFree(ResultProcessor *base) {
   array_foreach(sl->BufferBlocks, SearchResultsBlock, array_free(SearchResultsBlock));
   array_free(sl->BufferBlocks);
 
+  rm_free(sl->fetched);
   rploaderFreeInternal(base);
 
   rm_free(sl);
@@ -900,6 +1184,10 @@ static ResultProcessor *RPSafeLoader_New(RedisSearchCtx *sctx, RLookup *lk, cons
 
   sl->last_buffered_rc = RS_RESULT_OK;
 
+  if (sl->base_loader.loadopts.mode == RLOOKUP_LOAD_KEYLIST) {
+    sl->fetched = rm_malloc(sizeof(*sl->fetched) * nkeys * SAFE_LOADER_CHUNK_SIZE);
+  }
+
   sl->base_loader.base.Next = rpSafeLoaderNext_Accumulate;
   sl->base_loader.base.Free = rpSafeLoaderFree;
   sl->base_loader.base.type = RP_SAFE_LOADER;
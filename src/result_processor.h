@@ -205,10 +205,13 @@ void SortAscMap_Dump(uint64_t v, size_t n);
  * @param keys is an array of RLookupkeys to sort by them,
  * @param nkeys is the number of keys.
  * keys will be freed by the arrange step dtor.
+ * @param spillThreshold is the maximal number of results kept in memory if the sorter returns
+ * more than that, the rest are spilled to temporary files. 0 keeps all the results in memory.
  */
-ResultProcessor *RPSorter_NewByFields(size_t maxresults, const RLookupKey **keys, size_t nkeys, uint64_t ascendingMap);
+ResultProcessor *RPSorter_NewByFields(size_t maxresults, const RLookupKey **keys, size_t nkeys,
+                                      uint64_t ascendingMap, size_t spillThreshold);
 
-ResultProcessor *RPSorter_NewByScore(size_t maxresults);
+ResultProcessor *RPSorter_NewByScore(size_t maxresults, size_t spillThreshold);
 
 ResultProcessor *RPPager_New(size_t offset, size_t limit);
 
@@ -0,0 +1,310 @@
+/*
+ * Copyright Redis Ltd. 2016 - present
+ * Licensed under your choice of the Redis Source Available License 2.0 (RSALv2) or
+ * the Server Side Public License v1 (SSPLv1).
+ */
+
+#include "result_spill.h"
+#include "doc_table.h"
+#include "rmalloc.h"
+#include "util/arr.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define SPILL_FILE_BUFFER_SIZE (64 * 1024)
+
+// Nesting limit of the values read back, against corrupted files
+#define SPILL_MAX_VALUE_DEPTH 64
+
+typedef enum {
+  SpillValue_Absent = 0,
+  SpillValue_Number,
+  SpillValue_String,
+  SpillValue_Null,
+  SpillValue_Array,
+  SpillValue_Map,
+  SpillValue_Duo,
+} SpillValueType;
+
+/*
+ * Record of a spilled result:
+ *   docId, score, number of values,
+ *   followed by (row index, value) for each value of the row
+ */
+typedef struct __attribute__((packed)) {
+  t_docId docId;
+  double score;
+  uint32_t numValues;
+} SpillRecordHeader;
+
+/*
+ * What a spilled result owns is kept in memory rather than in the file, so that it can be released
+ * even if the file can not be read back
+ */
+typedef struct {
+  const RSDocumentMetadata *dmd;
+  const RSSortingVector *sv;
+  RSScoreExplain *scoreExplain;
+} SpillRecordRefs;
+
+struct SpillRun {
+  FILE *fp;
+  char *buf;
+  arrayof(SpillRecordRefs) refs;  // one entry per written result
+  size_t numRead;
+  int error;
+};
+
+SpillRun *SpillRun_New(void) {
+  FILE *fp = tmpfile();
+  if (!fp) {
+    return NULL;
+  }
+  SpillRun *run = rm_calloc(1, sizeof(*run));
+  run->fp = fp;
+  run->buf = rm_malloc(SPILL_FILE_BUFFER_SIZE);
+  run->refs = array_new(SpillRecordRefs, 16);
+  setvbuf(fp, run->buf, _IOFBF, SPILL_FILE_BUFFER_SIZE);
+  return run;
+}
+
+static inline void spillWrite(SpillRun *run, const void *p, size_t n) {
+  if (n && fwrite(p, n, 1, run->fp) != 1) {
+    run->error = 1;
+  }
+}
+
+static inline int spillRead(SpillRun *run, void *p, size_t n) {
+  if (n && fread(p, n, 1, run->fp) != 1) {
+    run->error = 1;
+    return 0;
+  }
+  return 1;
+}
+
+static void spillWriteValue(SpillRun *run, const RSValue *v) {
+  uint8_t t = SpillValue_Absent;
+  v = RSValue_Dereference(v);
+  if (!v) {
+    spillWrite(run, &t, sizeof(t));
+    return;
+  }
+
+  switch (v->t) {
+    case RSValue_Number:
+      t = SpillValue_Number;
+      spillWrite(run, &t, sizeof(t));
+      spillWrite(run, &v->numval, sizeof(v->numval));
+      break;
+
+    case RSValue_String:
+    case RSValue_RedisString:
+    case RSValue_OwnRstring: {
+      size_t len;
+      const char *str = RSValue_StringPtrLen(v, &len);
+      uint32_t len32 = len;
+      t = SpillValue_String;
+      spillWrite(run, &t, sizeof(t));
+      spillWrite(run, &len32, sizeof(len32));
+      spillWrite(run, str, len);
+      break;
+    }
+
+    case RSValue_Null:
+      t = SpillValue_Null;
+      spillWrite(run, &t, sizeof(t));
+      break;
+
+    case RSValue_Array: {
+      uint32_t len = v->arrval.len;
+      t = SpillValue_Array;
+      spillWrite(run, &t, sizeof(t));
+      spillWrite(run, &len, sizeof(len));
+      for (uint32_t i = 0; i < v->arrval.len; i++) {
+        spillWriteValue(run, v->arrval.vals[i]);
+      }
+      break;
+    }
+
+    case RSValue_Map:
+      t = SpillValue_Map;
+      spillWrite(run, &t, sizeof(t));
+      spillWrite(run, &v->mapval.len, sizeof(v->mapval.len));
+      for (uint32_t i = 0; i < v->mapval.len; i++) {
+        spillWriteValue(run, v->mapval.pairs[RSVALUE_MAP_KEYPOS(i)]);
+        spillWriteValue(run, v->mapval.pairs[RSVALUE_MAP_VALUEPOS(i)]);
+      }
+      break;
+
+    case RSValue_Duo:
+      t = SpillValue_Duo;
+      spillWrite(run, &t, sizeof(t));
+      spillWriteValue(run, RS_DUOVAL_VAL(*v));
+      spillWriteValue(run, RS_DUOVAL_OTHERVAL(*v));
+      spillWriteValue(run, RS_DUOVAL_OTHER2VAL(*v));
+      break;
+
+    default:
+      // Undefined values are read back as missing
+      spillWrite(run, &t, sizeof(t));
+      break;
+  }
+}
+
+// Returns 0 if the value could not be read. `*out` is NULL for absent values
+static int spillReadValue(SpillRun *run, RSValue **out, int depth) {
+  uint8_t t;
+  uint32_t len;
+  *out = NULL;
+  if (depth > SPILL_MAX_VALUE_DEPTH || !spillRead(run, &t, sizeof(t))) {
+    return 0;
+  }
+
+  switch (t) {
+    case SpillValue_Absent:
+      return 1;
+
+    case SpillValue_Number: {
+      double d;
+      if (!spillRead(run, &d, sizeof(d))) return 0;
+      *out = RS_NumVal(d);
+      return 1;
+    }
+
+    case SpillValue_String: {
+      if (!spillRead(run, &len, sizeof(len))) return 0;
+      char *str = rm_malloc(len + 1);
+      if (!spillRead(run, str, len)) {
+        rm_free(str);
+        return 0;
+      }
+      str[len] = '\0';
+      *out = RS_StringVal(str, len);
+      return 1;
+    }
+
+    case SpillValue_Null:
+      *out = RSValue_IncrRef(RS_NullVal());
+      return 1;
+
+    case SpillValue_Array:
+    case SpillValue_Map: {
+      if (!spillRead(run, &len, sizeof(len))) return 0;
+      uint32_t n = t == SpillValue_Map ? len * 2 : len;
+      RSValue **vals = rm_calloc(n ? n : 1, sizeof(*vals));
+      int ok = 1;
+      for (uint32_t i = 0; i < n; i++) {
+        if (ok) {
+          ok = spillReadValue(run, &vals[i], depth + 1);
+        }
+        // containers don't hold missing values. On failure, the container is still completed so
+        // that it can be freed
+        if (!vals[i]) {
+          vals[i] = RSValue_IncrRef(RS_NullVal());
+        }
+      }
+      *out = t == SpillValue_Map ? RSValue_NewMap(vals, len) : RSValue_NewArray(vals, len);
+      return ok;
+    }
+
+    case SpillValue_Duo: {
+      RSValue *vals[3] = {0};
+      int ok = 1;
+      for (int i = 0; i < 3 && ok; i++) {
+        ok = spillReadValue(run, &vals[i], depth + 1);
+      }
+      *out = RS_DuoVal(vals[0], vals[1], vals[2]);
+      return ok;
+    }
+
+    default:
+      run->error = 1;
+      return 0;
+  }
+}
+
+int SpillRun_Write(SpillRun *run, SearchResult *r) {
+  RLookupRow *row = &r->rowdata;
+  SpillRecordHeader hdr = {.docId = r->docId, .score = r->score, .numValues = 0};
+  for (size_t i = 0; i < array_len(row->dyn); i++) {
+    hdr.numValues += row->dyn[i] != NULL;
+  }
+
+  spillWrite(run, &hdr, sizeof(hdr));
+  for (uint32_t i = 0; i < array_len(row->dyn); i++) {
+    if (row->dyn[i]) {
+      spillWrite(run, &i, sizeof(i));
+      spillWriteValue(run, row->dyn[i]);
+    }
+  }
+
+  // the run owns the metadata and the explanation from now on, even if the write failed, so that
+  // they are released with the run
+  SpillRecordRefs refs = {.dmd = r->dmd, .sv = row->sv, .scoreExplain = r->scoreExplain};
+  run->refs = array_append(run->refs, refs);
+  r->dmd = NULL;
+  r->scoreExplain = NULL;
+  SearchResult_Clear(r);
+  return run->error ? REDISMODULE_ERR : REDISMODULE_OK;
+}
+
+int SpillRun_Seal(SpillRun *run) {
+  if (fflush(run->fp) != 0 || fseek(run->fp, 0, SEEK_SET) != 0) {
+    run->error = 1;
+  }
+  return run->error ? REDISMODULE_ERR : REDISMODULE_OK;
+}
+
+int SpillRun_Read(SpillRun *run, SearchResult *r) {
+  SpillRecordHeader hdr;
+  if (run->numRead == array_len(run->refs)) {
+    return 0;
+  } else if (run->error || !spillRead(run, &hdr, sizeof(hdr))) {
+    return -1;
+  }
+  // the result owns the references from now on, even if its values can not be read
+  SpillRecordRefs *refs = &run->refs[run->numRead++];
+  r->docId = hdr.docId;
+  r->score = hdr.score;
+  r->dmd = refs->dmd;
+  r->scoreExplain = refs->scoreExplain;
+  r->rowdata.sv = refs->sv;
+  *refs = (SpillRecordRefs){0};
+
+  for (uint32_t i = 0; i < hdr.numValues; i++) {
+    uint32_t idx;
+    RSValue *v = NULL;
+    if (!spillRead(run, &idx, sizeof(idx)) || !spillReadValue(run, &v, 0)) {
+      if (v) RSValue_Decref(v);
+      return -1;
+    }
+    if (v) {
+      RSValue **vp = array_ensure_at(&r->rowdata.dyn, idx, RSValue *);
+      if (*vp) {
+        RSValue_Decref(*vp);
+        r->rowdata.ndyn--;
+      }
+      *vp = v;
+      r->rowdata.ndyn++;
+    }
+  }
+  return 1;
+}
+
+void SpillRun_Free(SpillRun *run) {
+  // Release what the unread results own, without reading the file
+  for (size_t i = run->numRead; i < array_len(run->refs); i++) {
+    if (run->refs[i].dmd) {
+      DMD_Return(run->refs[i].dmd);
+    }
+    if (run->refs[i].scoreExplain) {
+      SEDestroy(run->refs[i].scoreExplain);
+    }
+  }
+  array_free(run->refs);
+
+  fclose(run->fp);
+  rm_free(run->buf);
+  rm_free(run);
+}
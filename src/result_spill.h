@@ -0,0 +1,53 @@
+/*
+ * Copyright Redis Ltd. 2016 - present
+ * Licensed under your choice of the Redis Source Available License 2.0 (RSALv2) or
+ * the Server Side Public License v1 (SSPLv1).
+ */
+
+#pragma once
+
+#include "result_processor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A run of search results written to a temporary file, and read back in the order they were
+ * written. It is used by the sorter to keep results which do not fit its memory budget.
+ *
+ * The row values of a result are written to the file in a compact format, while the document
+ * metadata, the sorting vector and the score explanation are kept in memory, owned by the run until
+ * the result is read back. Unread results are released when the run is freed, even if the file
+ * can not be read.
+ *
+ * The file is written and read with blocking I/O, by the thread which runs the query. That is the
+ * main thread, unless the query runs in the worker threads.
+ */
+typedef struct SpillRun SpillRun;
+
+/* Create a new, empty run. Returns NULL if the temporary file can not be created */
+SpillRun *SpillRun_New(void);
+
+/*
+ * Move the result into the run. The result is left cleared, and can be reused.
+ * Returns REDISMODULE_ERR if the result could not be written
+ */
+int SpillRun_Write(SpillRun *run, SearchResult *r);
+
+/* Stop writing and rewind the run for reading. Returns REDISMODULE_ERR on failure */
+int SpillRun_Seal(SpillRun *run);
+
+/*
+ * Read the next result of a sealed run into the cleared result `r`.
+ * Returns 1 if a result was read, 0 if the run is exhausted, or -1 if it can not be read, in
+ * which case `r` should be cleared
+ */
+int SpillRun_Read(SpillRun *run, SearchResult *r);
+
+/* Free the run, its temporary file, and the results which were not read */
+void SpillRun_Free(SpillRun *run);
+
+#ifdef __cplusplus
+}
+#endif
@@ -600,6 +600,23 @@ static RSValue *replyElemToValue(RedisModuleCallReply *rep, RLookupCoerceType ot
   }
 }
 
+static RedisModuleKey *openHashKey(RLookupLoadOptions *options, const char *keyPtr) {
+  RedisModuleCtx *ctx = options->sctx->redisCtx;
+  RedisModuleString *keyName = RedisModule_CreateString(ctx, keyPtr, strlen(keyPtr));
+  RedisModuleKey *keyobj = RedisModule_OpenKey(ctx, keyName, REDISMODULE_READ | REDISMODULE_OPEN_KEY_NOEFFECTS);
+  RedisModule_FreeString(ctx, keyName);
+  if (!keyobj) {
+    QueryError_SetCode(options->status, QUERY_ENODOC);
+    return NULL;
+  }
+  if (RedisModule_KeyType(keyobj) != REDISMODULE_KEYTYPE_HASH) {
+    RedisModule_CloseKey(keyobj);
+    QueryError_SetCode(options->status, QUERY_EREDISKEYTYPE);
+    return NULL;
+  }
+  return keyobj;
+}
+
 static int getKeyCommonHash(const RLookupKey *kk, RLookupRow *dst, RLookupLoadOptions *options,
                         RedisModuleKey **keyobj) {
   if (!options->forceLoad && (kk->flags & RLOOKUP_F_VAL_AVAILABLE)) {
@@ -609,20 +626,8 @@ static int getKeyCommonHash(const RLookupKey *kk, RLookupRow *dst, RLookupLoadOp
 
   const char *keyPtr = options->dmd ? options->dmd->keyPtr : options->keyPtr;
   // In this case, the flag must be obtained via HGET
-  if (!*keyobj) {
-    RedisModuleCtx *ctx = options->sctx->redisCtx;
-    RedisModuleString *keyName =
-        RedisModule_CreateString(ctx, keyPtr, strlen(keyPtr));
-    *keyobj = RedisModule_OpenKey(ctx, keyName, REDISMODULE_READ | REDISMODULE_OPEN_KEY_NOEFFECTS);
-    RedisModule_FreeString(ctx, keyName);
-    if (!*keyobj) {
-      QueryError_SetCode(options->status, QUERY_ENODOC);
-      return REDISMODULE_ERR;
-    }
-    if (RedisModule_KeyType(*keyobj) != REDISMODULE_KEYTYPE_HASH) {
-      QueryError_SetCode(options->status, QUERY_EREDISKEYTYPE);
-      return REDISMODULE_ERR;
-    }
+  if (!*keyobj && !(*keyobj = openHashKey(options, keyPtr))) {
+    return REDISMODULE_ERR;
   }
 
   // Get the actual hash value
@@ -927,6 +932,53 @@ int RLookup_LoadDocument(RLookup *it, RLookupRow *dst, RLookupLoadOptions *optio
   return rv;
 }
 
+int RLookup_FetchHashFields(RLookupRow *dst, RLookupLoadOptions *options, RedisModuleString **vals) {
+  const char *keyPtr = options->dmd ? options->dmd->keyPtr : options->keyPtr;
+  RedisModuleKey *keyobj = NULL;
+  if (options->dmd) {
+    dst->sv = options->dmd->sortVector;
+  }
+
+  for (size_t ii = 0; ii < options->nkeys; ++ii) {
+    const RLookupKey *kk = options->keys[ii];
+    vals[ii] = NULL;
+    if (!options->forceLoad && (kk->flags & RLOOKUP_F_VAL_AVAILABLE)) {
+      continue;
+    }
+    // The key is opened on the first field to fetch, so none were fetched if it fails
+    if (!keyobj && !(keyobj = openHashKey(options, keyPtr))) {
+      return REDISMODULE_ERR;
+    }
+    if (RedisModule_HashGet(keyobj, REDISMODULE_HASH_CFIELDS, kk->path, &vals[ii], NULL) != REDISMODULE_OK) {
+      vals[ii] = NULL;
+    }
+    if (!vals[ii] && !strncmp(kk->path, UNDERSCORE_KEY, strlen(UNDERSCORE_KEY))) {
+      // Not bound to a context, so that it can be released without the lock
+      vals[ii] = RedisModule_CreateString(NULL, keyPtr, strlen(keyPtr));
+    }
+  }
+
+  if (keyobj) {
+    RedisModule_CloseKey(keyobj);
+  }
+  return REDISMODULE_OK;
+}
+
+void RLookup_WriteHashFields(RLookupRow *dst, RLookupLoadOptions *options, RedisModuleString **vals) {
+  for (size_t ii = 0; ii < options->nkeys; ++ii) {
+    if (!vals[ii]) {
+      continue;
+    }
+    const RLookupKey *kk = options->keys[ii];
+    // As in `getKeyCommonHash`, we hold the only reference to the fetched string, so it is
+    // thread-safe to convert and release it
+    RSValue *rsv = hvalToValue(vals[ii], (kk->flags & RLOOKUP_T_NUMERIC) ? RLOOKUP_C_DBL : RLOOKUP_C_STR);
+    RedisModule_FreeString(RSDummyContext, vals[ii]);
+    vals[ii] = NULL;
+    RLookup_WriteOwnKey(kk, dst, rsv);
+  }
+}
+
 int RLookup_LoadRuleFields(RedisModuleCtx *ctx, RLookup *it, RLookupRow *dst, IndexSpec *spec, const char *keyptr) {
   SchemaRule *rule = spec->rule;
 
@@ -380,6 +380,20 @@ typedef struct {
  */
 int RLookup_LoadDocument(RLookup *lt, RLookupRow *dst, RLookupLoadOptions *options);
 
+/**
+ * Load the keys of a hash document in two steps, so that the Redis keyspace only needs to be
+ * locked while the raw values are fetched, and not while they are converted.
+ *
+ * RLookup_FetchHashFields fetches the values of `options->keys` into `vals`, which holds
+ * `options->nkeys` entries (NULL for fields which are not fetched). It must be called with Redis
+ * locked.
+ *
+ * RLookup_WriteHashFields converts the fetched values into the row, and releases them. It does
+ * not access the keyspace.
+ */
+int RLookup_FetchHashFields(RLookupRow *dst, RLookupLoadOptions *options, RedisModuleString **vals);
+void RLookup_WriteHashFields(RLookupRow *dst, RLookupLoadOptions *options, RedisModuleString **vals);
+
 /**
  * Initialize the lookup. If cache is provided, then it will be used as an
  * alternate source for lookups whose fields are absent
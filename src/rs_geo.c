@@ -6,6 +6,9 @@
 
 #include "rs_geo.h"
 
+#include <math.h>
+#include <stdlib.h>
+
 int encodeGeo(double lon, double lat, double *bits) {
   GeoHashBits hash;
   int rv = geohashEncodeWGS84(lon, lat, GEO_STEP_MAX, &hash);
@@ -96,6 +99,159 @@ void calcRanges(double longitude, double latitude, double radius_meters, GeoHash
   calcAllNeighbors(&georadius, longitude, latitude, radius_meters, ranges);
 }
 
+typedef enum {
+  GeoCell_Outside,
+  GeoCell_Crossing,
+  GeoCell_Inside,
+} GeoCellRelation;
+
+typedef struct {
+  GeoHashBits hash;
+  GeoCellRelation rel;
+} GeoCoverCell;
+
+#define GEO_DEG_RAD(ang) ((ang) * M_PI / 180.0)
+#define GEO_RAD_DEG(ang) ((ang) * 180.0 / M_PI)
+
+// Longitude difference, in degrees, normalized to [-180, 180)
+static double lonDelta(double from, double to) {
+  return fmod(to - from + 540.0, 360.0) - 180.0;
+}
+
+/* Distance between the point and the closest point of the area. A parallel gets farther from the
+ * point as its longitude gets farther, so the closest point is on the nearest meridian edge, at the
+ * latitude of the great circle from the point which crosses it at a right angle. */
+static double areaMinDistance(double lon, double lat, const GeoHashArea *area) {
+  double dmin = lonDelta(lon, area->longitude.min);
+  double dmax = lonDelta(lon, area->longitude.max);
+  double edgeLon;
+  double closestLat;
+
+  if (dmin <= 0 && dmax >= 0) {
+    if (lat >= area->latitude.min && lat <= area->latitude.max) {
+      return 0;
+    }
+    edgeLon = lon;
+    closestLat = lat;
+  } else {
+    double d = fabs(dmin) < fabs(dmax) ? dmin : dmax;
+    if (fabs(d) >= 90) {
+      // Too far for the edge to be convex as seen from the point, don't rule anything out
+      return 0;
+    }
+    edgeLon = lon + d;
+    closestLat = GEO_RAD_DEG(atan(tan(GEO_DEG_RAD(lat)) / cos(GEO_DEG_RAD(d))));
+  }
+  if (closestLat < area->latitude.min) closestLat = area->latitude.min;
+  if (closestLat > area->latitude.max) closestLat = area->latitude.max;
+  return geohashGetDistance(lon, lat, edgeLon, closestLat);
+}
+
+/* Distance between the point and the farthest point of the area, which is one of its corners */
+static double areaMaxDistance(double lon, double lat, const GeoHashArea *area) {
+  double corners[4] = {
+      geohashGetDistance(lon, lat, area->longitude.min, area->latitude.min),
+      geohashGetDistance(lon, lat, area->longitude.min, area->latitude.max),
+      geohashGetDistance(lon, lat, area->longitude.max, area->latitude.min),
+      geohashGetDistance(lon, lat, area->longitude.max, area->latitude.max),
+  };
+  double max = corners[0];
+  for (int i = 1; i < 4; i++) {
+    if (corners[i] > max) max = corners[i];
+  }
+  return max;
+}
+
+static GeoCellRelation cellRelation(GeoHashBits hash, double lon, double lat, double radius) {
+  GeoHashArea area;
+  geohashDecodeWGS84(hash, &area);
+  if (areaMinDistance(lon, lat, &area) > radius) {
+    return GeoCell_Outside;
+  } else if (areaMaxDistance(lon, lat, &area) < radius) {
+    return GeoCell_Inside;
+  }
+  return GeoCell_Crossing;
+}
+
+static int cmpCoverCells(const void *p1, const void *p2) {
+  GeoHashFix52Bits s1 = geohashAlign52Bits(((const GeoCoverCell *)p1)->hash);
+  GeoHashFix52Bits s2 = geohashAlign52Bits(((const GeoCoverCell *)p2)->hash);
+  return s1 < s2 ? -1 : (s1 > s2 ? 1 : 0);
+}
+
+size_t calcCoverRanges(double longitude, double latitude, double radius_meters,
+                       GeoCoverRange *ranges) {
+  GeoHashRadius n = geohashGetAreasByRadiusWGS84(longitude, latitude, radius_meters);
+  GeoHashBits squares[GEO_RANGE_COUNT] = {
+      n.hash,
+      n.neighbors.north,
+      n.neighbors.south,
+      n.neighbors.east,
+      n.neighbors.west,
+      n.neighbors.north_east,
+      n.neighbors.north_west,
+      n.neighbors.south_east,
+      n.neighbors.south_west,
+  };
+  GeoCoverCell cells[GEO_MAX_RANGES];
+  size_t count = 0;
+
+  for (size_t i = 0; i < GEO_RANGE_COUNT; i++) {
+    if (HASHISZERO(squares[i])) {
+      continue;
+    }
+    // With a huge radius, neighbors can be the same square
+    bool dup = false;
+    for (size_t j = 0; j < count && !dup; j++) {
+      dup = cells[j].hash.bits == squares[i].bits && cells[j].hash.step == squares[i].step;
+    }
+    GeoCellRelation rel = cellRelation(squares[i], longitude, latitude, radius_meters);
+    if (!dup && rel != GeoCell_Outside) {
+      cells[count++] = (GeoCoverCell){.hash = squares[i], .rel = rel};
+    }
+  }
+
+  // Split the largest crossing cells, while the sub-squares fit
+  while (count + 3 <= GEO_MAX_RANGES) {
+    ssize_t next = -1;
+    for (size_t i = 0; i < count; i++) {
+      if (cells[i].rel == GeoCell_Crossing && cells[i].hash.step < GEO_STEP_MAX &&
+          (next < 0 || cells[i].hash.step < cells[next].hash.step)) {
+        next = i;
+      }
+    }
+    if (next < 0) {
+      break;
+    }
+
+    GeoHashBits parent = cells[next].hash;
+    cells[next] = cells[--count];
+    for (uint64_t q = 0; q < 4; q++) {
+      GeoHashBits child = {.bits = (parent.bits << 2) | q, .step = parent.step + 1};
+      GeoCellRelation rel = cellRelation(child, longitude, latitude, radius_meters);
+      if (rel != GeoCell_Outside) {
+        cells[count++] = (GeoCoverCell){.hash = child, .rel = rel};
+      }
+    }
+  }
+
+  // Merge the adjacent cells which need the same check into a single range
+  qsort(cells, count, sizeof(*cells), cmpCoverCells);
+  size_t numRanges = 0;
+  for (size_t i = 0; i < count; i++) {
+    GeoHashFix52Bits min, max;
+    scoresOfGeoHashBox(cells[i].hash, &min, &max);
+    bool inside = cells[i].rel == GeoCell_Inside;
+    if (numRanges && ranges[numRanges - 1].inside == inside &&
+        ranges[numRanges - 1].range.max == min) {
+      ranges[numRanges - 1].range.max = max;
+    } else {
+      ranges[numRanges++] = (GeoCoverRange){.range = {.min = min, .max = max}, .inside = inside};
+    }
+  }
+  return numRanges;
+}
+
 bool isWithinRadiusLonLat(double lon1, double lat1, double lon2, double lat2, double radius,
                           double *distance) {
   double dist = geohashGetDistance(lon1, lat1, lon2, lat2);
@@ -130,30 +286,3 @@ int parseGeo(const char *c, size_t len, double *lon, double *lat) {
 
   return REDISMODULE_OK;
 }
-
-/*
-int isWithinRadius(double center, double point, double radius, double *distance) {
-  double xyCenter[2], xyPoint[2];
-  decodeGeo(center, xyCenter);
-  decodeGeo(point, xyPoint);
-  return isWithinRadiusLonLat(xyCenter[0], xyCenter[1], xyPoint[0], xyPoint[1],
-                                    radius, distance);
-}
-
-IndexIterator *NewGeoRangeIterator(GeoIndex *gi, const GeoFilter *gf, double weight) {
-  GeoHashRange ranges[GEO_RANGE_COUNT] = {0};
-  calcRanges(gf, ranges);
-
-  int iterCount = 0;
-  IndexIterator **iters = rm_calloc(GEO_RANGE_COUNT, sizeof(*iters));
-  for (size_t ii = 0; ii < GEO_RANGE_COUNT; ++ii) {
-    if (ranges[ii].min != ranges[ii].max) {
-      NumericFilter *filt = NewNumericFilter(ranges[ii].min, ranges[ii].max, 1, 1);
-      iters[iterCount++] = NewNumericFilterIterator(NULL, filt, NULL);
-    }
-  }
-  iters = rm_realloc(iters, iterCount * sizeof(*iters));
-  IndexIterator *it = NewUnionIterator(iters, iterCount, NULL, 1, 1);
-  return it;
-}*/
-
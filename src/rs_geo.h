@@ -31,6 +31,26 @@ int  decodeGeo(double bits, double *xy);
 void calcRanges(double longitude, double latitude, double radius_meters,
                 GeoHashRange *ranges);
 
+// Maximal number of cells in the covering of a radius query
+#define GEO_MAX_RANGES 16
+
+typedef struct {
+  GeoHashRange range;  // scores range, min inclusive and max exclusive
+  bool inside;         // all the points of the range are within the radius
+} GeoCoverRange;
+
+/*
+ * Cover the circle of the given radius around a point with ranges of scores, and return their
+ * number, which is at most GEO_MAX_RANGES.
+ *
+ * Starting from the squares of `calcRanges`, the squares which are out of the circle are dropped,
+ * and the largest squares which cross its edge are split into their 4 sub-squares as long as the
+ * covering has room for them. Only the points of the ranges which are not `inside` need to be
+ * checked with `isWithinRadiusLonLat`.
+ */
+size_t calcCoverRanges(double longitude, double latitude, double radius_meters,
+                       GeoCoverRange *ranges);
+
 /*
  * Return true is distance is smaller than radius. radius must be in meters.
  * If `distance' is not NULL, the distance value is returned.
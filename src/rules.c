@@ -7,8 +7,10 @@
 #include "rules.h"
 #include "aggregate/expr/expression.h"
 #include "aggregate/expr/exprast.h"
+#include "aggregate/expr/bytecode.h"
 #include "json.h"
 #include "rdb.h"
+#include "util/minmax.h"
 
 TrieMap *ScemaPrefixes_g;
 
@@ -124,6 +126,7 @@ SchemaRule *SchemaRule_Create(SchemaRuleArgs *args, StrongRef ref, QueryError *s
       QueryError_SetError(status, QUERY_EADDARGS, "Invalid expression");
       goto error;
     }
+    rule->filter_prog = ExprProgram_Compile(rule->filter_exp);
   }
 
   for (int i = 0; i < array_len(rule->prefixes); ++i) {
@@ -176,6 +179,9 @@ void SchemaRule_Free(SchemaRule *rule) {
   rm_free((void *)rule->score_field);
   rm_free((void *)rule->payload_field);
   rm_free((void *)rule->filter_exp_str);
+  if (rule->filter_prog) {
+    ExprProgram_Free(rule->filter_prog);
+  }
   if (rule->filter_exp) {
     ExprAST_Free((RSExpr *)rule->filter_exp);
   }
@@ -197,6 +203,7 @@ static SchemaPrefixNode *SchemaPrefixNode_Create(const char *prefix, StrongRef r
 
 static void SchemaPrefixNode_Free(SchemaPrefixNode *node) {
   array_free(node->index_specs);
+  array_free(node->dispatch);
   rm_free(node->prefix);
   rm_free(node);
 }
@@ -495,7 +502,7 @@ bool SchemaRule_ShouldIndex(struct IndexSpec *sp, RedisModuleString *keyname, Do
 
     RLookup_LoadRuleFields(RSDummyContext, &r->lk, &r->row, sp, keyCstr);
 
-    if (EvalCtx_EvalExpr(r, rule->filter_exp) != EXPR_EVAL_OK ||
+    if (EvalCtx_EvalProgram(r, rule->filter_exp, rule->filter_prog) != EXPR_EVAL_OK ||
         !RSValue_BoolTest(&r->res)) {
       ret = false;
     }
@@ -521,8 +528,23 @@ void SchemaPrefixes_Free(TrieMap *t) {
   TrieMap_Free(t, freePrefixNode);
 }
 
+// Drop the compiled dispatch of a prefix and of all the longer prefixes it is part of
+static void SchemaPrefixes_Invalidate(const char *prefix, size_t nprefix) {
+  TrieMapIterator *it = TrieMap_Iterate(ScemaPrefixes_g, prefix, nprefix);
+  char *str;
+  tm_len_t len;
+  void *value;
+  while (TrieMapIterator_Next(it, &str, &len, &value)) {
+    SchemaPrefixNode *node = value;
+    array_free(node->dispatch);
+    node->dispatch = NULL;
+  }
+  TrieMapIterator_Free(it);
+}
+
 void SchemaPrefixes_Add(const char *prefix, StrongRef ref) {
   size_t nprefix = strlen(prefix);
+  SchemaPrefixes_Invalidate(prefix, nprefix);
   void *p = TrieMap_Find(ScemaPrefixes_g, (char *)prefix, nprefix);
   if (p == TRIEMAP_NOTFOUND) {
     SchemaPrefixNode *node = SchemaPrefixNode_Create(prefix, ref);
@@ -547,6 +569,7 @@ void SchemaPrefixes_RemoveSpec(StrongRef ref) {
     // iterate over specs list and remove
     for (int j = 0; j < array_len(node->index_specs); ++j) {
       if (StrongRef_Equals(node->index_specs[j], ref)) {
+        SchemaPrefixes_Invalidate(prefixes[i], strlen(prefixes[i]));
         array_del_fast(node->index_specs, j);
         if (array_len(node->index_specs) == 0) {
           // if all specs were deleted, remove the node
@@ -558,4 +581,122 @@ void SchemaPrefixes_RemoveSpec(StrongRef ref) {
   }
 }
 
+//---------------------------------------------------------------------------------------------
+
+typedef struct {
+  SchemaPrefixDispatch d;
+  char *fields;  // the fields the filter loads, NULL if there is no filter
+  size_t fields_len;
+  const char *filter;
+} DispatchEntry;
+
+static void filterField(const IndexSpec *sp, size_t i, const char **name, const char **path) {
+  const SchemaRule *rule = sp->rule;
+  int idx = rule->filter_fields_index[i];
+  *name = idx == -1 ? rule->filter_fields[i] : sp->fields[idx].name;
+  *path = idx == -1 ? "" : sp->fields[idx].path;
+}
+
+// Serialize the fields loaded by the filter of an index, as loaded by RLookup_LoadRuleFields:
+// the rule type, then the name and the path of each field, each terminated by \0.
+static char *filterFieldsKey(const IndexSpec *sp, size_t *len) {
+  size_t nfields = array_len(sp->rule->filter_fields);
+  const char *name, *path;
+
+  *len = 1;
+  for (size_t i = 0; i < nfields; ++i) {
+    filterField(sp, i, &name, &path);
+    *len += strlen(name) + strlen(path) + 2;
+  }
+
+  char *key = rm_malloc(*len);
+  char *p = key;
+  *p++ = (char)sp->rule->type;
+  for (size_t i = 0; i < nfields; ++i) {
+    filterField(sp, i, &name, &path);
+    p = stpcpy(p, name) + 1;
+    p = stpcpy(p, path) + 1;
+  }
+  return key;
+}
+
+static int cmpDispatchEntries(const void *a, const void *b) {
+  const DispatchEntry *ea = a, *eb = b;
+  if (!ea->fields || !eb->fields) {
+    if (ea->fields != eb->fields) {
+      return ea->fields ? 1 : -1;
+    }
+  } else {
+    int rc = memcmp(ea->fields, eb->fields, MIN(ea->fields_len, eb->fields_len));
+    if (rc) {
+      return rc;
+    }
+    if (ea->fields_len != eb->fields_len) {
+      return ea->fields_len < eb->fields_len ? -1 : 1;
+    }
+    rc = strcmp(ea->filter, eb->filter);
+    if (rc) {
+      return rc;
+    }
+  }
+  uintptr_t pa = (uintptr_t)ea->d.spec.rm, pb = (uintptr_t)eb->d.spec.rm;
+  return pa < pb ? -1 : pa > pb;
+}
+
+static void SchemaPrefixNode_Compile(SchemaPrefixNode *node) {
+  arrayof(SchemaPrefixNode *) prefixes = array_new(SchemaPrefixNode *, 4);
+  TrieMap_FindPrefixes(ScemaPrefixes_g, node->prefix, strlen(node->prefix),
+                       (arrayof(void *) *)&prefixes);
+
+  arrayof(DispatchEntry) entries = array_new(DispatchEntry, array_len(node->index_specs));
+  for (size_t i = 0; i < array_len(prefixes); ++i) {
+    for (size_t j = 0; j < array_len(prefixes[i]->index_specs); ++j) {
+      DispatchEntry entry = {.d = {.spec = prefixes[i]->index_specs[j]}};
+      IndexSpec *sp = StrongRef_Get(entry.d.spec);
+      if (sp && sp->rule->filter_exp) {
+        entry.fields = filterFieldsKey(sp, &entry.fields_len);
+        entry.filter = sp->rule->filter_exp_str;
+      }
+      entries = array_append(entries, entry);
+    }
+  }
+  array_free(prefixes);
+
+  // indexes appearing under several prefixes end up next to each other
+  qsort(entries, array_len(entries), sizeof(*entries), cmpDispatchEntries);
+
+  node->dispatch = array_new(SchemaPrefixDispatch, array_len(entries));
+  uint32_t fields_group = 0, filter_group = 0;
+  for (size_t i = 0; i < array_len(entries); ++i) {
+    DispatchEntry *entry = entries + i, *prev = i ? entry - 1 : NULL;
+    if (prev && StrongRef_Equals(prev->d.spec, entry->d.spec)) {
+      continue;
+    }
+    if (entry->fields) {
+      if (!prev || !prev->fields || prev->fields_len != entry->fields_len ||
+          memcmp(prev->fields, entry->fields, entry->fields_len)) {
+        ++fields_group;
+        ++filter_group;
+      } else if (strcmp(prev->filter, entry->filter)) {
+        ++filter_group;
+      }
+      entry->d.fields_group = fields_group;
+      entry->d.filter_group = filter_group;
+    }
+    node->dispatch = array_append(node->dispatch, entry->d);
+  }
+  array_free_ex(entries, rm_free(((DispatchEntry *)ptr)->fields));
+}
+
+const SchemaPrefixDispatch *SchemaPrefixes_Match(const char *key, size_t len) {
+  SchemaPrefixNode *node = TrieMap_FindLongestPrefix(ScemaPrefixes_g, key, len);
+  if (node == TRIEMAP_NOTFOUND) {
+    return NULL;
+  }
+  if (!node->dispatch) {
+    SchemaPrefixNode_Compile(node);
+  }
+  return node->dispatch;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -50,6 +50,8 @@ typedef struct SchemaRule {
   arrayof(const char *) prefixes;
   char *filter_exp_str;
   struct RSExpr *filter_exp;
+  // compiled form of a numeric filter_exp
+  struct ExprProgram *filter_prog;
   char **filter_fields;
   int *filter_fields_index;
   char *lang_field;
@@ -95,11 +97,30 @@ void SchemaPrefixes_Free(TrieMap *t);
 void SchemaPrefixes_Add(const char *prefix, StrongRef spec);
 void SchemaPrefixes_RemoveSpec(StrongRef spec);
 
+/*
+ * An index a key is dispatched to. Indexes with a filter are grouped by the fields the filter
+ * loads and by the filter itself, so each group is loaded and evaluated once per key.
+ */
+typedef struct {
+  StrongRef spec;
+  uint32_t fields_group;  // 0 if the index has no filter
+  uint32_t filter_group;  // 0 if the index has no filter
+} SchemaPrefixDispatch;
+
 typedef struct {
   char *prefix;
   arrayof(StrongRef) index_specs;
+  // All the indexes matching keys with this prefix, including the ones of shorter prefixes,
+  // ordered by filter groups. Compiled on first use and dropped whenever the prefixes change.
+  arrayof(SchemaPrefixDispatch) dispatch;
 } SchemaPrefixNode;
 
+/*
+ * Return the indexes matching a key, or NULL if there are none.
+ * The result is valid until the prefixes change.
+ */
+const SchemaPrefixDispatch *SchemaPrefixes_Match(const char *key, size_t len);
+
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
 #ifdef __cplusplus
@@ -32,6 +32,7 @@
 #include "commands.h"
 #include "rmutil/cxx/chrono-clock.h"
 #include "util/workers.h"
+#include "query_cache.h"
 
 #define INITIAL_DOC_TABLE_SIZE 1000
 
@@ -64,6 +65,10 @@ size_t used_memory = 0;
 
 static redisearch_threadpool cleanPool = NULL;
 
+// LRU clock of the lazy loading, advanced each time an index is loaded. Only accessed with the
+// GIL held.
+static uint64_t specLRUClock_g = 0;
+
 //---------------------------------------------------------------------------------------------
 
 static void setMemoryInfo(RedisModuleCtx *ctx) {
@@ -388,6 +393,9 @@ IndexSpec *IndexSpec_CreateNew(RedisModuleCtx *ctx, RedisModuleString **argv, in
   if (!(sp->flags & Index_SkipInitialScan)) {
     IndexSpec_ScanAndReindex(ctx, spec_ref);
   }
+
+  sp->lastUsed = ++specLRUClock_g;
+  Indexes_EnforceResidentLimit();
   return sp;
 }
 
@@ -638,6 +646,9 @@ static int parseVectorField_hnsw(FieldSpec *fs, VecSimParams *params, ArgsCursor
         QERR_MKBADARGS_AC(status, "vector similarity HNSW index epsilon", rc);
         return 0;
       }
+    } else if (AC_AdvanceIfMatch(ac, VECSIM_DECLINED_QUANTIZATION)) {
+      VECSIM_ERR_QUANTIZATION(status, VECSIM_ALGORITHM_HNSW);
+      return 0;
     } else {
       QERR_MKBADARGS_FMT(status, "Bad arguments for algorithm %s: %s", VECSIM_ALGORITHM_HNSW, AC_GetStringNC(ac, NULL));
       return 0;
@@ -715,6 +726,9 @@ static int parseVectorField_flat(FieldSpec *fs, VecSimParams *params, ArgsCursor
         QERR_MKBADARGS_AC(status, "vector similarity FLAT index blocksize", rc);
         return 0;
       }
+    } else if (AC_AdvanceIfMatch(ac, VECSIM_DECLINED_QUANTIZATION)) {
+      VECSIM_ERR_QUANTIZATION(status, VECSIM_ALGORITHM_BF);
+      return 0;
     } else {
       QERR_MKBADARGS_FMT(status, "Bad arguments for algorithm %s: %s", VECSIM_ALGORITHM_BF, AC_GetStringNC(ac, NULL));
       return 0;
@@ -1082,6 +1096,10 @@ int IndexSpec_AddFields(StrongRef spec_ref, IndexSpec *sp, RedisModuleCtx *ctx,
   setMemoryInfo(ctx);
 
   int rc = IndexSpec_AddFieldsInternal(sp, spec_ref, ac, status, 0);
+  // cached queries were parsed with the previous schema
+  if (rc && sp->queryCache) {
+    QueryCache_Clear(sp->queryCache);
+  }
   if (rc && initialScan) {
     IndexSpec_ScanAndReindex(ctx, spec_ref);
   }
@@ -1358,6 +1376,10 @@ static void IndexSpec_FreeUnlinkedData(IndexSpec *spec) {
   if (spec->suffix) {
     TrieType_Free(spec->suffix);
   }
+  // Free parsed queries
+  if (spec->queryCache) {
+    QueryCache_Free(spec->queryCache);
+  }
 
   // Destroy the spec's lock
   pthread_rwlock_destroy(&spec->rwlock);
@@ -1452,6 +1474,7 @@ void Indexes_Free(dict *d) {
   // spec<-->prefix
   SchemaPrefixes_Free(ScemaPrefixes_g);
   SchemaPrefixes_Create();
+  Indexes_FreeMatchingCache();
 
   // cursor list is iterating through the list as well and consuming a lot of CPU
   CursorList_Empty(&g_CursorsList);
@@ -1479,6 +1502,227 @@ inline static void IndexSpec_IncreasCounter(IndexSpec *sp) {
   __atomic_fetch_add(&sp->counter , 1, __ATOMIC_RELAXED);
 }
 
+void IndexSpec_AddActiveQuery(IndexSpec *sp) {
+  __atomic_fetch_add(&sp->activeQueries, 1, __ATOMIC_RELEASE);
+}
+
+void IndexSpec_RemoveActiveQuery(IndexSpec *sp) {
+  __atomic_fetch_sub(&sp->activeQueries, 1, __ATOMIC_RELEASE);
+}
+
+
+//---------------------------------------- lazy loading -----------------------------------------
+
+// The data an evicted index releases. Freed in the background like the data of a dropped index
+typedef struct {
+  DocTable docs;
+  Trie *terms;
+  Trie *suffix;
+  dict *keysDict;
+} IndexSpecEvictedData;
+
+static void IndexSpec_FreeEvictedData(IndexSpecEvictedData *data) {
+  DocTable_Free(&data->docs);
+  if (data->terms) {
+    TrieType_Free(data->terms);
+  }
+  if (data->suffix) {
+    TrieType_Free(data->suffix);
+  }
+  if (data->keysDict) {
+    dictRelease(data->keysDict);
+  }
+  rm_free(data);
+}
+
+static bool IndexSpec_IsEvictable(const IndexSpec *sp) {
+  // Only indexes which follow the keyspace can be rebuilt from it. Indexes created with
+  // SKIPINITIALSCAN would pick up documents they never indexed.
+  // Queries running in the worker threads may hold readers into its data between two locks of
+  // the spec, so an index they use is not evicted until they are done.
+  return !sp->cold && sp->rule &&
+         !(sp->flags & (Index_Temporary | Index_FromLLAPI | Index_SkipInitialScan)) &&
+         !sp->scan_in_progress && !sp->activeCursors &&
+         !__atomic_load_n(&sp->activeQueries, __ATOMIC_ACQUIRE);
+}
+
+// Assuming the GIL is held.
+static void IndexSpec_Evict(IndexSpec *sp) {
+  if (sp->gc) {
+    GCContext_Stop(sp->gc);
+    sp->gc = NULL;
+  }
+
+  RedisSearchCtx sctx = SEARCH_CTX_STATIC(RSDummyContext, sp);
+  RedisSearchCtx_LockSpecWrite(&sctx);
+
+  IndexSpecEvictedData *data = rm_malloc(sizeof(*data));
+  *data = (IndexSpecEvictedData){
+      .docs = sp->docs,
+      .terms = sp->terms,
+      .suffix = sp->suffix,
+      .keysDict = sp->keysDict,
+  };
+
+  // keep the index usable (and empty) in case someone reaches it without loading it
+  sp->docs = DocTable_New(0);
+  sp->terms = NewTrie(NULL, Trie_Sort_Lex);
+  sp->suffix = data->suffix ? NewTrie(suffixTrie_freeCallback, Trie_Sort_Lex) : NULL;
+  IndexSpec_MakeKeyless(sp);
+  memset(&sp->stats, 0, sizeof(sp->stats));
+  sp->cold = true;
+
+  RedisSearchCtx_UnlockSpec(&sctx);
+
+  RedisModule_Log(RSDummyContext, "verbose", "Evicting index %s", sp->name);
+  if (RSGlobalConfig.freeResourcesThread == false) {
+    IndexSpec_FreeEvictedData(data);
+  } else {
+    redisearch_thpool_add_work(cleanPool, (redisearch_thpool_proc)IndexSpec_FreeEvictedData, data, THPOOL_PRIORITY_HIGH);
+  }
+}
+
+int IndexSpec_UpdateDoc(IndexSpec *spec, RedisModuleCtx *ctx, RedisModuleString *key, DocumentType type);
+static void IndexSpec_RepackGeometryAsync(StrongRef spec_ref);
+
+static void IndexSpec_RehydrateProc(RedisModuleCtx *ctx, RedisModuleString *keyname,
+                                    RedisModuleKey *key, IndexSpec *sp) {
+  // RMKey it is provided as best effort but in some cases it might be NULL
+  bool keyOpened = false;
+  if (!key) {
+    key = RedisModule_OpenKey(ctx, keyname, REDISMODULE_READ);
+    keyOpened = true;
+  }
+  DocumentType type = getDocType(key);
+  if (keyOpened) {
+    RedisModule_CloseKey(key);
+  }
+
+  if (type != DocumentType_Unsupported && SchemaRule_ShouldIndex(sp, keyname, type)) {
+    IndexSpec_UpdateDoc(sp, ctx, keyname, type);
+  }
+}
+
+// Assuming the GIL is held.
+// The index is rebuilt in the foreground, so the command which loads it sees all of its documents
+// rather than the partial results of a background scan.
+static void IndexSpec_Rehydrate(StrongRef spec_ref) {
+  IndexSpec *sp = StrongRef_Get(spec_ref);
+  RedisModule_Log(RSDummyContext, "verbose", "Rebuilding cold index %s", sp->name);
+
+  sp->cold = false;
+  IndexSpec_StartGC(RSDummyContext, spec_ref, sp);
+  RedisModuleScanCursor *cursor = RedisModule_ScanCursorCreate();
+  while (RedisModule_Scan(RSDummyContext, cursor, (RedisModuleScanCB)IndexSpec_RehydrateProc, sp)) {
+  }
+  RedisModule_ScanCursorDestroy(cursor);
+  IndexSpec_RepackGeometryAsync(spec_ref);
+
+  Indexes_EnforceResidentLimit();
+}
+
+static int cmpSpecsLastUsed(const void *a, const void *b) {
+  const IndexSpec *sa = *(const IndexSpec **)a, *sb = *(const IndexSpec **)b;
+  return sa->lastUsed < sb->lastUsed ? -1 : sa->lastUsed > sb->lastUsed;
+}
+
+// Assuming the GIL is held.
+void Indexes_EnforceResidentLimit() {
+  size_t limit = RSGlobalConfig.maxResidentIndexes;
+  if (!limit || dictSize(specDict_g) <= limit) {
+    return;
+  }
+
+  size_t nresident = 0;
+  arrayof(IndexSpec *) candidates = array_new(IndexSpec *, 16);
+  dictIterator *iter = dictGetIterator(specDict_g);
+  dictEntry *entry = NULL;
+  while ((entry = dictNext(iter))) {
+    IndexSpec *sp = StrongRef_Get(dictGetRef(entry));
+    if (sp->cold) {
+      continue;
+    }
+    ++nresident;
+    if (IndexSpec_IsEvictable(sp)) {
+      candidates = array_append(candidates, sp);
+    }
+  }
+  dictReleaseIterator(iter);
+
+  if (nresident > limit) {
+    qsort(candidates, array_len(candidates), sizeof(*candidates), cmpSpecsLastUsed);
+    for (size_t i = 0; i < array_len(candidates) && nresident > limit; ++i) {
+      IndexSpec_Evict(candidates[i]);
+      --nresident;
+    }
+  }
+  array_free(candidates);
+}
+
+typedef struct {
+  StrongRef spec_ref;
+  IndexSpec *sp;  // the spec was removed from the globals, so spec_ref no longer returns it
+  arrayof(RedisModuleString *) keys;
+} ColdDocsCtx;
+
+static void IndexSpec_CollectColdDocsProc(RedisModuleCtx *ctx, RedisModuleString *keyname,
+                                          RedisModuleKey *key, ColdDocsCtx *cdc) {
+  // RMKey it is provided as best effort but in some cases it might be NULL
+  bool keyOpened = false;
+  if (!key) {
+    key = RedisModule_OpenKey(ctx, keyname, REDISMODULE_READ);
+    keyOpened = true;
+  }
+  DocumentType type = getDocType(key);
+  if (keyOpened) {
+    RedisModule_CloseKey(key);
+  }
+
+  if (type != DocumentType_Unsupported && SchemaRule_ShouldIndex(cdc->sp, keyname, type)) {
+    cdc->keys = array_append(cdc->keys, RedisModule_CreateStringFromString(NULL, keyname));
+  }
+}
+
+static void IndexSpec_DeleteColdDocsTask(ColdDocsCtx *cdc) {
+  RedisModuleCtx *ctx = RedisModule_GetThreadSafeContext(NULL);
+  RedisModuleScanCursor *cursor = RedisModule_ScanCursorCreate();
+  RedisModule_ThreadSafeContextLock(ctx);
+  RedisModule_Log(ctx, "notice", "Deleting the documents of index %s in background", cdc->sp->name);
+
+  size_t counter = 0;
+  while (true) {
+    bool more = RedisModule_Scan(ctx, cursor, (RedisModuleScanCB)IndexSpec_CollectColdDocsProc, cdc);
+    // keys are deleted between two scan iterations, deleting them from the callback is not safe
+    for (size_t i = 0; i < array_len(cdc->keys); ++i) {
+      Redis_DeleteKeyC(ctx, (char *)RedisModule_StringPtrLen(cdc->keys[i], NULL));
+      RedisModule_FreeString(NULL, cdc->keys[i]);
+    }
+    cdc->keys = array_clear(cdc->keys);
+    if (!more) {
+      break;
+    }
+
+    // let redis serve other commands between the iterations, like the background scan does
+    RedisModule_ThreadSafeContextUnlock(ctx);
+    if (++counter % RSGlobalConfig.numBGIndexingIterationsBeforeSleep == 0) {
+      usleep(1);
+    } else {
+      sched_yield();
+    }
+    RedisModule_ThreadSafeContextLock(ctx);
+  }
+
+  RedisModule_Log(ctx, "notice", "Deleting the documents of index %s in background: done",
+                  cdc->sp->name);
+  // may free the spec, which is done with the GIL held like on the main thread
+  StrongRef_Release(cdc->spec_ref);
+  RedisModule_ThreadSafeContextUnlock(ctx);
+
+  array_free(cdc->keys);
+  rm_free(cdc);
+  RedisModule_ScanCursorDestroy(cursor);
+  RedisModule_FreeThreadSafeContext(ctx);
+}
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -1511,6 +1755,11 @@ StrongRef IndexSpec_LoadUnsafeEx(RedisModuleCtx *ctx, IndexLoadOptions *options)
 
   // Increament the number of uses.
   IndexSpec_IncreasCounter(sp);
+  sp->lastUsed = ++specLRUClock_g;
+
+  if (sp->cold && !(options->flags & INDEXSPEC_LOAD_NOREHYDRATE)) {
+    IndexSpec_Rehydrate(spec_ref);
+  }
 
   if (!RS_IsMock && (sp->flags & Index_Temporary) && !(options->flags & INDEXSPEC_LOAD_NOTIMERUPDATE)) {
     if (sp->isTimerSet) {
@@ -2017,6 +2266,87 @@ static void Indexes_ScanProc(RedisModuleCtx *ctx, RedisModuleString *keyname, Re
 
 //---------------------------------------------------------------------------------------------
 
+#ifdef MT_BUILD
+static bool IndexSpec_HasTieredVectorFields(const IndexSpec *sp) {
+  for (int i = 0; i < sp->numFields; ++i) {
+    const FieldSpec *fs = sp->fields + i;
+    if (FIELD_IS(fs, INDEXFLD_T_VECTOR) && fs->vectorOpts.vecSimParams.algo == VecSimAlgo_TIERED) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Whether the scan should wait for the workers between iterations. Should be called with the GIL.
+static bool IndexesScanner_ShouldWaitForWorkers(IndexesScanner *scanner) {
+  if (RSGlobalConfig.mt_mode != MT_MODE_FULL || !RSGlobalConfig.numWorkerThreads ||
+      !RSGlobalConfig.tieredVecSimIndexBufferLimit) {
+    return false;
+  }
+  bool found = false;
+  if (scanner->global) {
+    dictIterator *iter = dictGetIterator(specDict_g);
+    dictEntry *entry;
+    while (!found && (entry = dictNext(iter))) {
+      StrongRef spec_ref = dictGetRef(entry);
+      IndexSpec *sp = StrongRef_Get(spec_ref);
+      found = sp && IndexSpec_HasTieredVectorFields(sp);
+    }
+    dictReleaseIterator(iter);
+  } else {
+    StrongRef spec_ref = WeakRef_Promote(scanner->spec_ref);
+    IndexSpec *sp = StrongRef_Get(spec_ref);
+    found = sp && IndexSpec_HasTieredVectorFields(sp);
+    StrongRef_Release(spec_ref);
+  }
+  return found;
+}
+#endif
+
+static void IndexSpec_RepackGeometryTask(StrongRef *spec_ref) {
+  RedisModuleCtx *ctx = RedisModule_GetThreadSafeContext(NULL);
+  IndexSpec *sp = StrongRef_Get(*spec_ref);
+  if (sp) {
+    GeometryIndex_Repack(ctx, sp, true);
+  }
+  RedisModule_ThreadSafeContextLock(ctx);
+  StrongRef_Release(*spec_ref);
+  RedisModule_ThreadSafeContextUnlock(ctx);
+  RedisModule_FreeThreadSafeContext(ctx);
+  rm_free(spec_ref);
+}
+
+static void IndexSpec_RepackGeometryAsync(StrongRef spec_ref) {
+  IndexSpec *sp = StrongRef_Get(spec_ref);
+  if (!sp || !(sp->flags & Index_HasGeometry)) {
+    return;
+  }
+  if (!reindexPool) {
+    reindexPool = redisearch_thpool_create(1, DEFAULT_PRIVILEGED_THREADS_NUM);
+    redisearch_thpool_init(reindexPool, LogCallback);
+  }
+  StrongRef *task_ref = rm_new(StrongRef);
+  *task_ref = StrongRef_Clone(spec_ref);
+  redisearch_thpool_add_work(reindexPool, (redisearch_thpool_proc)IndexSpec_RepackGeometryTask, task_ref, THPOOL_PRIORITY_HIGH);
+}
+
+// Pack the geometry indexes which were filled one document at a time. The indexes are packed in
+// the background, see GeometryIndex_Repack(). Should be called with the GIL
+static void Indexes_RepackGeometry(IndexesScanner *scanner) {
+  if (scanner && !scanner->global) {
+    StrongRef spec_ref = WeakRef_Promote(scanner->spec_ref);
+    IndexSpec_RepackGeometryAsync(spec_ref);
+    StrongRef_Release(spec_ref);
+    return;
+  }
+  dictIterator *iter = dictGetIterator(specDict_g);
+  dictEntry *entry;
+  while ((entry = dictNext(iter))) {
+    IndexSpec_RepackGeometryAsync(dictGetRef(entry));
+  }
+  dictReleaseIterator(iter);
+}
+
 static void Indexes_ScanAndReindexTask(IndexesScanner *scanner) {
   RS_LOG_ASSERT(scanner, "invalid IndexesScanner");
 
@@ -2033,9 +2363,21 @@ static void Indexes_ScanAndReindexTask(IndexesScanner *scanner) {
     RedisModule_Log(ctx, "notice", "Scanning index %s in background", scanner->spec_name);
   }
 
+#ifdef MT_BUILD
+  bool waitForWorkers = IndexesScanner_ShouldWaitForWorkers(scanner);
+#endif
+
   size_t counter = 0;
   while (RedisModule_Scan(ctx, cursor, (RedisModuleScanCB)Indexes_ScanProc, scanner)) {
     RedisModule_ThreadSafeContextUnlock(ctx);
+#ifdef MT_BUILD
+    if (waitForWorkers) {
+      // Let the workers catch up with the vectors waiting in the flat buffers of the tiered indexes.
+      // Once a buffer is full, vectors are inserted into the HNSW graph in place, by this thread and
+      // while holding the GIL, instead of by all the workers in parallel.
+      workersThreadPool_DrainFromBackground(RSGlobalConfig.tieredVecSimIndexBufferLimit / 2);
+    }
+#endif
     counter++;
     if (counter % RSGlobalConfig.numBGIndexingIterationsBeforeSleep == 0) {
       // Sleep for one microsecond to allow redis server to acquire the GIL while we release it.
@@ -2065,6 +2407,9 @@ static void Indexes_ScanAndReindexTask(IndexesScanner *scanner) {
   }
 
 end:
+  if (!scanner->cancelled) {
+    Indexes_RepackGeometry(scanner);
+  }
   if (!scanner->cancelled && scanner->global) {
     Indexes_SetTempSpecsTimers(TimerOp_Add);
   }
@@ -2090,6 +2435,21 @@ static void IndexSpec_ScanAndReindexAsync(StrongRef spec_ref) {
   redisearch_thpool_add_work(reindexPool, (redisearch_thpool_proc)Indexes_ScanAndReindexTask, scanner, THPOOL_PRIORITY_HIGH);
 }
 
+// Assuming the GIL is held.
+void IndexSpec_DeleteColdDocs(StrongRef spec_ref, IndexSpec *sp) {
+  if (!reindexPool) {
+    reindexPool = redisearch_thpool_create(1, DEFAULT_PRIVILEGED_THREADS_NUM);
+    redisearch_thpool_init(reindexPool, LogCallback);
+  }
+  ColdDocsCtx *cdc = rm_new(ColdDocsCtx);
+  *cdc = (ColdDocsCtx){
+      .spec_ref = spec_ref,
+      .sp = sp,
+      .keys = array_new(RedisModuleString *, 16),
+  };
+  redisearch_thpool_add_work(reindexPool, (redisearch_thpool_proc)IndexSpec_DeleteColdDocsTask, cdc, THPOOL_PRIORITY_HIGH);
+}
+
 void ReindexPool_ThreadPoolDestroy() {
   if (reindexPool != NULL) {
     RedisModule_ThreadSafeContextUnlock(RSDummyContext);
@@ -2391,7 +2751,12 @@ int IndexSpec_CreateFromRdb(RedisModuleCtx *ctx, RedisModuleIO *rdb, int encver,
 
   sp->uniqueId = spec_unique_ids++;
 
-  IndexSpec_StartGC(ctx, spec_ref, sp);
+  // With lazy loading, indexes are not rebuilt at load time. They stay cold until first used.
+  // Only the indexes which can be rebuilt from the keyspace are left cold.
+  sp->cold = RSGlobalConfig.maxResidentIndexes > 0 && IndexSpec_IsEvictable(sp);
+  if (!sp->cold) {
+    IndexSpec_StartGC(ctx, spec_ref, sp);
+  }
   Cursors_initSpec(sp, RSCURSORS_DEFAULT_CAPACITY);
 
   if (sp->flags & Index_HasSmap) {
@@ -2694,6 +3059,8 @@ static void Indexes_LoadingEvent(RedisModuleCtx *ctx, RedisModuleEvent eid, uint
     } else {
       RedisModule_Log(ctx, "warning",
                       "Skip background reindex scan, redis version contains loaded event.");
+      // The documents were indexed one by one as they were loaded
+      Indexes_RepackGeometry(NULL);
     }
 #ifdef MT_BUILD
     workersThreadPool_waitAndTerminate(ctx);
@@ -2861,84 +3228,88 @@ void Indexes_Init(RedisModuleCtx *ctx) {
   SchemaPrefixes_Create();
 }
 
+// Matching runs on every write, so its contexts are recycled and filters are evaluated in a
+// shared context. Only accessed with the GIL held.
+#define SPEC_OPS_CTX_CACHE_SIZE 4
+static SpecOpIndexingCtx *specOpsCtxCache_g[SPEC_OPS_CTX_CACHE_SIZE];
+static size_t specOpsCtxCacheLen_g = 0;
+static EvalCtx *schemaRulesEvalCtx_g = NULL;
+
+static SpecOpIndexingCtx *SpecOpIndexingCtx_New() {
+  if (specOpsCtxCacheLen_g) {
+    return specOpsCtxCache_g[--specOpsCtxCacheLen_g];
+  }
+  SpecOpIndexingCtx *res = rm_malloc(sizeof(*res));
+  res->specsOps = array_new(SpecOpCtx, 10);
+  return res;
+}
+
+static EvalCtx *SchemaRules_ResetEvalCtx() {
+  EvalCtx *r = schemaRulesEvalCtx_g;
+  if (!r) {
+    return schemaRulesEvalCtx_g = EvalCtx_Create();
+  }
+  RLookupRow_Wipe(&r->row);
+  RLookup_Cleanup(&r->lk);
+  RLookup_Init(&r->lk, NULL);
+  return r;
+}
+
 SpecOpIndexingCtx *Indexes_FindMatchingSchemaRules(RedisModuleCtx *ctx, RedisModuleString *key,
                                                    bool runFilters,
                                                    RedisModuleString *keyToReadData) {
   if (!keyToReadData) {
     keyToReadData = key;
   }
-  SpecOpIndexingCtx *res = rm_malloc(sizeof(*res));
-  res->specs = dictCreate(&dictTypeHeapStrings, NULL);
-  res->specsOps = array_new(SpecOpCtx, 10);
+  SpecOpIndexingCtx *res = SpecOpIndexingCtx_New();
   if (dictSize(specDict_g) == 0) {
     return res;
   }
-  dict *specs = res->specs;
-
-#if defined(_DEBUG) && 0
-  RLookupKey *k = RLookup_GetKey_LoadEx(&r->lk, UNDERSCORE_KEY, strlen(UNDERSCORE_KEY), UNDERSCORE_KEY, RLOOKUP_F_NOFLAGS);
-  RSValue *v = RLookup_GetItem(k, &r->row);
-  const char *x = RSValue_StringPtrLen(v, NULL);
-  RedisModule_Log(NULL, "notice", "Indexes_FindMatchingSchemaRules: x=%s", x);
-  const char *f = "name";
-  k = RLookup_GetKeyEx(&r->lk, f, strlen(f), RLOOKUP_M_READ, RLOOKUP_F_NOFLAGS);
-  if (k) {
-    v = RLookup_GetItem(k, &r->row);
-    x = RSValue_StringPtrLen(v, NULL);
-  }
-#endif  // _DEBUG
 
   size_t n;
   const char *key_p = RedisModule_StringPtrLen(key, &n);
-  arrayof(SchemaPrefixNode *) prefixes = array_new(SchemaPrefixNode *, 1);
-  // collect specs that their name is prefixed by the key name
-  // `prefixes` includes list of arrays of specs, one for each prefix of key name
-  int nprefixes = TrieMap_FindPrefixes(ScemaPrefixes_g, key_p, n, (arrayof(void *) *)&prefixes);
-  for (int i = 0; i < array_len(prefixes); ++i) {
-    SchemaPrefixNode *node = prefixes[i];
-    for (int j = 0; j < array_len(node->index_specs); ++j) {
-      StrongRef global = node->index_specs[j];
-      IndexSpec *spec = StrongRef_Get(global);
-      if (spec && !dictFind(specs, spec->name)) {
-        SpecOpCtx specOp = {
-            .spec = spec,
-            .op = SpecOp_Add,
-        };
-        res->specsOps = array_append(res->specsOps, specOp);
-        dictEntry *entry = dictAddRaw(specs, spec->name, NULL);
-        // put the location on the specsOps array so we can get it
-        // fast using index name
-        entry->v.u64 = array_len(res->specsOps) - 1;
-      }
+  // the dispatch holds every index with a prefix of the key name, each one once, and the ones
+  // with a filter are grouped by the fields they load and by their filter
+  const SchemaPrefixDispatch *dispatch = SchemaPrefixes_Match(key_p, n);
+
+  EvalCtx *r = NULL;
+  uint32_t loaded = 0, evaluated = 0;
+  bool pass = true;
+  for (size_t i = 0; i < array_len(dispatch); ++i) {
+    IndexSpec *spec = StrongRef_Get(dispatch[i].spec);
+    // cold indexes are rebuilt from the keyspace when used, so they skip updates
+    if (!spec || spec->cold) {
+      continue;
     }
-  }
-  array_free(prefixes);
-
-  if (runFilters) {
-
-    EvalCtx *r = NULL;
-    for (size_t i = 0; i < array_len(res->specsOps); ++i) {
-      SpecOpCtx *specOp = res->specsOps + i;
-      IndexSpec *spec = specOp->spec;
-      if (!spec->rule->filter_exp) {
-        continue;
+    SpecOpCtx specOp = {
+        .spec = spec,
+        .op = SpecOp_Add,
+    };
+
+    if (runFilters && dispatch[i].filter_group) {
+      // load hash only if required, and once for all the filters on the same fields
+      if (dispatch[i].fields_group != loaded) {
+        r = SchemaRules_ResetEvalCtx();
+        RLookup_LoadRuleFields(ctx, &r->lk, &r->row, spec, key_p);
+        loaded = dispatch[i].fields_group;
       }
-
-      // load hash only if required
-      if (!r) r = EvalCtx_Create();
-      RLookup_LoadRuleFields(ctx, &r->lk, &r->row, spec, key_p);
-
-      if (EvalCtx_EvalExpr(r, spec->rule->filter_exp) == EXPR_EVAL_OK) {
-        if (!RSValue_BoolTest(&r->res) && dictFind(specs, spec->name)) {
-          specOp->op = SpecOp_Del;
-        }
+      if (dispatch[i].filter_group != evaluated) {
+        SchemaRule *rule = spec->rule;
+        pass = EvalCtx_EvalProgram(r, rule->filter_exp, rule->filter_prog) != EXPR_EVAL_OK ||
+               RSValue_BoolTest(&r->res);
+        QueryError_ClearError(r->ee.err);
+        evaluated = dispatch[i].filter_group;
+      }
+      if (!pass) {
+        specOp.op = SpecOp_Del;
       }
-      QueryError_ClearError(r->ee.err);
     }
+    res->specsOps = array_append(res->specsOps, specOp);
+  }
 
-    if (r) {
-      EvalCtx_Destroy(r);
-    }
+  if (r) {
+    // do not hold on to the loaded values until the next write
+    RLookupRow_Wipe(&r->row);
   }
   return res;
 }
@@ -2967,11 +3338,33 @@ static bool hashFieldChanged(IndexSpec *spec, RedisModuleString **hashFields) {
 }
 
 void Indexes_SpecOpsIndexingCtxFree(SpecOpIndexingCtx *specs) {
-  dictRelease(specs->specs);
+  if (specOpsCtxCacheLen_g < SPEC_OPS_CTX_CACHE_SIZE) {
+    specs->specsOps = array_clear(specs->specsOps);
+    specOpsCtxCache_g[specOpsCtxCacheLen_g++] = specs;
+    return;
+  }
   array_free(specs->specsOps);
   rm_free(specs);
 }
 
+void Indexes_FreeMatchingCache() {
+  while (specOpsCtxCacheLen_g) {
+    SpecOpIndexingCtx *specs = specOpsCtxCache_g[--specOpsCtxCacheLen_g];
+    array_free(specs->specsOps);
+    rm_free(specs);
+  }
+  if (schemaRulesEvalCtx_g) {
+    EvalCtx_Destroy(schemaRulesEvalCtx_g);
+    schemaRulesEvalCtx_g = NULL;
+  }
+}
+
+static int cmpSpecOps(const void *a, const void *b) {
+  uintptr_t sa = (uintptr_t)((const SpecOpCtx *)a)->spec;
+  uintptr_t sb = (uintptr_t)((const SpecOpCtx *)b)->spec;
+  return sa < sb ? -1 : sa > sb;
+}
+
 void Indexes_UpdateMatchingWithSchemaRules(RedisModuleCtx *ctx, RedisModuleString *key, DocumentType type,
                                            RedisModuleString **hashFields) {
   if (type == DocumentType_Unsupported) {
@@ -3030,6 +3423,10 @@ void Indexes_ReplaceMatchingWithSchemaRules(RedisModuleCtx *ctx, RedisModuleStri
   const char *from_str = RedisModule_StringPtrLen(from_key, &from_len);
   const char *to_str = RedisModule_StringPtrLen(to_key, &to_len);
 
+  // sort the target indexes to look up the source ones in them
+  size_t nto = array_len(to_specs->specsOps);
+  qsort(to_specs->specsOps, nto, sizeof(SpecOpCtx), cmpSpecOps);
+
   for (size_t i = 0; i < array_len(from_specs->specsOps); ++i) {
     SpecOpCtx *specOp = from_specs->specsOps + i;
     IndexSpec *spec = specOp->spec;
@@ -3037,15 +3434,14 @@ void Indexes_ReplaceMatchingWithSchemaRules(RedisModuleCtx *ctx, RedisModuleStri
       // the document is not in the index from the first place
       continue;
     }
-    dictEntry *entry = dictFind(to_specs->specs, spec->name);
-    if (entry) {
+    SpecOpCtx *toOp = bsearch(specOp, to_specs->specsOps, nto, sizeof(SpecOpCtx), cmpSpecOps);
+    if (toOp) {
       RedisSearchCtx sctx = SEARCH_CTX_STATIC(ctx, spec);
       RedisSearchCtx_LockSpecWrite(&sctx);
       DocTable_Replace(&spec->docs, from_str, from_len, to_str, to_len);
       RedisSearchCtx_UnlockSpec(&sctx);
-      size_t index = entry->v.u64;
-      dictDelete(to_specs->specs, spec->name);
-      array_del_fast(to_specs->specsOps, index);
+      // the document was moved, nothing left to do on the target index
+      toOp->op = SpecOp_Del;
     } else {
       IndexSpec_DeleteDoc(spec, ctx, from_key);
     }
@@ -34,6 +34,7 @@ extern "C" {
 
 struct IndexesScanner;
 struct DocumentIndexer;
+struct QueryCache;
 
 #define SPEC_GEO_STR "GEO"
 #define SPEC_GEOMETRY_STR "GEOSHAPE"
@@ -303,6 +304,15 @@ typedef struct IndexSpec {
   // Count the number of times the index was used
   long long counter;
 
+  // A cold index was evicted by the lazy loading LRU (see MAX_RESIDENT_INDEXES). It keeps only
+  // its definition; its data is rebuilt from the keyspace the next time it is loaded
+  bool cold;
+  // Value of the LRU clock when the index was last loaded
+  uint64_t lastUsed;
+
+  // Parsed queries of the index (see QUERY_CACHE_SIZE), created on first use
+  struct QueryCache *queryCache;
+
   // read write lock
   pthread_rwlock_t rwlock;
 
@@ -310,6 +320,9 @@ typedef struct IndexSpec {
   size_t cursorsCap;
   size_t activeCursors;
 
+  // Queries dispatched to the worker threads which did not finish yet. Accessed atomically
+  size_t activeQueries;
+
   // Quick access to the spec's strong ref
   StrongRef own_ref;
 } IndexSpec;
@@ -323,7 +336,6 @@ typedef struct SpecOpCtx {
 } SpecOpCtx;
 
 typedef struct SpecOpIndexingCtx {
-  dict *specs;
   SpecOpCtx *specsOps;
 } SpecOpIndexingCtx;
 
@@ -452,6 +464,28 @@ void IndexSpec_MakeKeyless(IndexSpec *sp);
 
 void IndexesScanner_Cancel(struct IndexesScanner *scanner);
 void IndexSpec_ScanAndReindex(RedisModuleCtx *ctx, StrongRef ref);
+
+/**
+ * Evict the least recently used indexes until no more than MAX_RESIDENT_INDEXES indexes
+ * keep their data in memory. Does nothing if the limit is 0.
+ */
+void Indexes_EnforceResidentLimit();
+
+/**
+ * Delete the documents of a dropped cold index. A cold index has no doc table, so the keyspace
+ * is scanned in the background for the keys matching its rule. Takes ownership of `spec_ref`,
+ * which keeps the spec alive until the scan is done.
+ */
+void IndexSpec_DeleteColdDocs(StrongRef spec_ref, IndexSpec *sp);
+
+/**
+ * Count a query dispatched to the worker threads, so the index is not evicted while the query
+ * may still hold readers into its data. Called from the main thread before dispatching the query.
+ */
+void IndexSpec_AddActiveQuery(IndexSpec *sp);
+
+/** Called from the worker thread once the query no longer uses the data of the index */
+void IndexSpec_RemoveActiveQuery(IndexSpec *sp);
 #ifdef FTINFO_FOR_INFO_MODULES
 /**
  * Exposing all the fields of the index to INFO command.
@@ -502,6 +536,9 @@ int VecSimIndex_validate_params(RedisModuleCtx *ctx, VecSimParams *params, Query
 
 #define INDEXSPEC_LOAD_NOTIMERUPDATE 0x20
 
+/** Don't rebuild the data of a cold index */
+#define INDEXSPEC_LOAD_NOREHYDRATE 0x40
+
 typedef struct {
   uint32_t flags;
   union {
@@ -594,6 +631,8 @@ void Indexes_DeleteMatchingWithSchemaRules(RedisModuleCtx *ctx, RedisModuleStrin
                                            RedisModuleString **hashFields);
 void Indexes_ReplaceMatchingWithSchemaRules(RedisModuleCtx *ctx, RedisModuleString *from_key,
                                             RedisModuleString *to_key);
+// Free the contexts kept for matching keys with the schema rules
+void Indexes_FreeMatchingCache();
 
 //---------------------------------------------------------------------------------------------
 
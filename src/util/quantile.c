@@ -273,6 +273,42 @@ double QS_Query(QuantStream *stream, double q) {
   return prev->v;
 }
 
+void QS_Merge(QuantStream *dst, QuantStream *src) {
+  if (dst->bufferLength) {
+    QS_Flush(dst);
+  }
+  if (src->bufferLength) {
+    QS_Flush(src);
+  }
+
+  // Both lists are ordered, so they are merged in a single pass. The rank of a sample in the merged
+  // stream is also uncertain by the ranks covered by the following sample of the other stream,
+  // which is added to its delta
+  Sample *pos = dst->firstSample;
+  const Sample *cur = src->firstSample;
+  while (pos || cur) {
+    if (cur && (!pos || cur->v < pos->v)) {
+      Sample *newSample = QS_NewSample(dst);
+      newSample->v = cur->v;
+      newSample->g = cur->g;
+      newSample->d = cur->d + (pos ? pos->g + pos->d - 1 : 0);
+      if (pos) {
+        QS_InsertSampleAt(dst, pos, newSample);
+      } else {
+        QS_AppendSample(dst, newSample);
+      }
+      cur = cur->next;
+    } else {
+      if (cur) {
+        pos->d += cur->g + cur->d - 1;
+      }
+      pos = pos->next;
+    }
+  }
+  dst->n += src->n;
+  QS_Compress(dst);
+}
+
 QuantStream *NewQuantileStream(const double *quantiles, size_t numQuantiles, size_t bufferLength) {
   QuantStream *ret = rm_calloc(1, sizeof(QuantStream));
   if ((ret->numQuantiles = numQuantiles)) {
@@ -15,6 +15,8 @@ typedef struct QuantStream QuantStream;
 QuantStream *NewQuantileStream(const double *quantiles, size_t numQuantiles, size_t bufferLength);
 void QS_Insert(QuantStream *qs, double val);
 double QS_Query(QuantStream *qs, double val);
+// Merge the samples of `src` into `dst`, `src` is not modified except for flushing its buffer
+void QS_Merge(QuantStream *dst, QuantStream *src);
 void QS_Free(QuantStream *qs);
 void QS_Dump(const QuantStream *stream, FILE *fp);
 size_t QS_GetCount(const QuantStream *stream);
@@ -0,0 +1,207 @@
+/*
+ * Copyright Redis Ltd. 2016 - present
+ * Licensed under your choice of the Redis Source Available License 2.0 (RSALv2) or
+ * the Server Side Public License v1 (SSPLv1).
+ */
+
+#include "tdigest.h"
+#include "rmalloc.h"
+
+#include <math.h>
+#include <string.h>
+
+// The merged centroids take up to 2 * compression slots, the rest of the slots buffer new values
+#define TDIGEST_CAPACITY_FACTOR 7
+// Slots allocated for the centroids of a new digest, doubled until the capacity is reached
+#define TDIGEST_INITIAL_ALLOCATED 16
+
+/** Serialized digest format */
+typedef struct __attribute__((packed)) {
+  uint32_t flags;  // Currently unused
+  double compression;
+  double min;
+  double max;
+  uint32_t numCentroids;
+  // followed by numCentroids (mean, weight) pairs
+} TDigestSerializedHeader;
+
+TDigest *TDigest_New(double compression) {
+  if (!(compression >= TDIGEST_MIN_COMPRESSION)) {
+    compression = TDIGEST_MIN_COMPRESSION;
+  } else if (compression > TDIGEST_MAX_COMPRESSION) {
+    compression = TDIGEST_MAX_COMPRESSION;
+  }
+  TDigest *td = rm_calloc(1, sizeof(*td));
+  td->compression = compression;
+  td->capacity = TDIGEST_CAPACITY_FACTOR * (size_t)ceil(compression);
+  td->allocated = TDIGEST_INITIAL_ALLOCATED;
+  td->centroids = rm_malloc(td->allocated * sizeof(*td->centroids));
+  td->min = INFINITY;
+  td->max = -INFINITY;
+  return td;
+}
+
+void TDigest_Free(TDigest *td) {
+  rm_free(td->centroids);
+  rm_free(td);
+}
+
+static int cmpCentroids(const void *a, const void *b) {
+  double ma = ((const TDigestCentroid *)a)->mean, mb = ((const TDigestCentroid *)b)->mean;
+  return ma < mb ? -1 : (ma > mb ? 1 : 0);
+}
+
+// The k1 scale function, which maps a quantile to the index of its centroid
+static inline double scaleK(double q, double compression) {
+  return compression / (2 * M_PI) * asin(2 * q - 1);
+}
+
+static inline double scaleQ(double k, double compression) {
+  if (k >= compression / 4) {
+    return 1;
+  }
+  return (sin(k * 2 * M_PI / compression) + 1) / 2;
+}
+
+// Merge the buffered values into the centroids. Adjacent centroids are merged as long as the
+// merged centroid spans at most one unit of the scale function
+static void TDigest_Compress(TDigest *td) {
+  if (!td->numBuffered) {
+    return;
+  }
+  size_t n = td->numMerged + td->numBuffered;
+  qsort(td->centroids, n, sizeof(*td->centroids), cmpCentroids);
+
+  double total = td->totalWeight;
+  double weightSoFar = 0;
+  double limit = total * scaleQ(scaleK(0, td->compression) + 1, td->compression);
+  size_t out = 0;
+  TDigestCentroid cur = td->centroids[0];
+  for (size_t ii = 1; ii < n; ++ii) {
+    const TDigestCentroid *next = &td->centroids[ii];
+    if (weightSoFar + cur.weight + next->weight <= limit) {
+      cur.weight += next->weight;
+      cur.mean += (next->mean - cur.mean) * next->weight / cur.weight;
+    } else {
+      weightSoFar += cur.weight;
+      td->centroids[out++] = cur;
+      limit = total * scaleQ(scaleK(weightSoFar / total, td->compression) + 1, td->compression);
+      cur = *next;
+    }
+  }
+  td->centroids[out++] = cur;
+  td->numMerged = out;
+  td->numBuffered = 0;
+}
+
+void TDigest_Add(TDigest *td, double value, double weight) {
+  if (isnan(value) || !(weight > 0)) {
+    return;
+  }
+  if (td->numMerged + td->numBuffered == td->allocated) {
+    if (td->allocated < td->capacity) {
+      td->allocated *= 2;
+      if (td->allocated > td->capacity) td->allocated = td->capacity;
+      td->centroids = rm_realloc(td->centroids, td->allocated * sizeof(*td->centroids));
+    } else {
+      TDigest_Compress(td);
+    }
+  }
+  td->centroids[td->numMerged + td->numBuffered++] = (TDigestCentroid){value, weight};
+  td->totalWeight += weight;
+  if (value < td->min) {
+    td->min = value;
+  }
+  if (value > td->max) {
+    td->max = value;
+  }
+}
+
+void TDigest_Merge(TDigest *dst, TDigest *src) {
+  size_t n = src->numMerged + src->numBuffered;
+  for (size_t ii = 0; ii < n; ++ii) {
+    TDigest_Add(dst, src->centroids[ii].mean, src->centroids[ii].weight);
+  }
+  // the extremes of src may have been merged into centroids
+  if (src->min < dst->min) {
+    dst->min = src->min;
+  }
+  if (src->max > dst->max) {
+    dst->max = src->max;
+  }
+}
+
+double TDigest_Quantile(TDigest *td, double q) {
+  TDigest_Compress(td);
+  size_t n = td->numMerged;
+  if (!n) {
+    return NAN;
+  }
+  if (q <= 0) {
+    return td->min;
+  } else if (q >= 1) {
+    return td->max;
+  }
+  const TDigestCentroid *c = td->centroids;
+  if (n == 1) {
+    return c[0].mean;
+  }
+
+  // Each centroid is assumed to be centered around its mean, values between two centroids are
+  // interpolated, and the ends are interpolated towards the min and max values
+  double index = q * td->totalWeight;
+  if (index < c[0].weight / 2) {
+    return td->min + (c[0].mean - td->min) * index / (c[0].weight / 2);
+  }
+  double weightSoFar = c[0].weight / 2;
+  for (size_t ii = 0; ii < n - 1; ++ii) {
+    double dw = (c[ii].weight + c[ii + 1].weight) / 2;
+    if (weightSoFar + dw > index) {
+      return c[ii].mean + (c[ii + 1].mean - c[ii].mean) * (index - weightSoFar) / dw;
+    }
+    weightSoFar += dw;
+  }
+  double lastHalf = c[n - 1].weight / 2;
+  double frac = (index - weightSoFar) / lastHalf;
+  return c[n - 1].mean + (td->max - c[n - 1].mean) * (frac > 1 ? 1 : frac);
+}
+
+char *TDigest_Serialize(TDigest *td, size_t *len) {
+  TDigest_Compress(td);
+  TDigestSerializedHeader hdr = {.flags = 0,
+                                 .compression = td->compression,
+                                 .min = td->min,
+                                 .max = td->max,
+                                 .numCentroids = td->numMerged};
+  size_t centroidsSize = td->numMerged * sizeof(*td->centroids);
+  *len = sizeof(hdr) + centroidsSize;
+  char *buf = rm_malloc(*len);
+  memcpy(buf, &hdr, sizeof(hdr));
+  memcpy(buf + sizeof(hdr), td->centroids, centroidsSize);
+  return buf;
+}
+
+TDigest *TDigest_Deserialize(const char *buf, size_t len) {
+  TDigestSerializedHeader hdr;
+  if (len < sizeof(hdr)) {
+    return NULL;
+  }
+  memcpy(&hdr, buf, sizeof(hdr));
+  if (len - sizeof(hdr) != hdr.numCentroids * sizeof(TDigestCentroid) ||
+      !(hdr.compression >= TDIGEST_MIN_COMPRESSION && hdr.compression <= TDIGEST_MAX_COMPRESSION)) {
+    return NULL;
+  }
+
+  TDigest *td = TDigest_New(hdr.compression);
+  const char *p = buf + sizeof(hdr);
+  for (uint32_t ii = 0; ii < hdr.numCentroids; ++ii, p += sizeof(TDigestCentroid)) {
+    TDigestCentroid c;
+    memcpy(&c, p, sizeof(c));
+    TDigest_Add(td, c.mean, c.weight);
+  }
+  if (td->totalWeight) {
+    td->min = hdr.min;
+    td->max = hdr.max;
+  }
+  return td;
+}
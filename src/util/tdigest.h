@@ -0,0 +1,75 @@
+/*
+ * Copyright Redis Ltd. 2016 - present
+ * Licensed under your choice of the Redis Source Available License 2.0 (RSALv2) or
+ * the Server Side Public License v1 (SSPLv1).
+ */
+
+#ifndef TDIGEST_H
+#define TDIGEST_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TDIGEST_DEFAULT_COMPRESSION 100
+#define TDIGEST_MIN_COMPRESSION 10
+#define TDIGEST_MAX_COMPRESSION 1000
+
+typedef struct {
+  double mean;
+  double weight;
+} TDigestCentroid;
+
+/**
+ * A merging t-digest (Dunning & Ertl, "Computing Extremely Accurate Quantiles Using t-Digests").
+ *
+ * Values are added to a buffer, which is merged into the centroids once full. The centroids are
+ * sized by the k1 scale function, so they are small near the tails and large near the median.
+ * The number of centroids is bounded by the compression, so the memory of a digest is bounded no
+ * matter how many values are added to it. The slots are allocated as values are added, so a digest
+ * holding a few values (e.g. the digest of a small group) stays small.
+ */
+typedef struct TDigest {
+  double compression;
+  double min;
+  double max;
+  // the merged centroids are followed by the buffered ones
+  TDigestCentroid *centroids;
+  size_t numMerged;
+  size_t numBuffered;
+  size_t allocated;  // slots allocated for the centroids, grown up to the capacity
+  size_t capacity;
+  double totalWeight;
+} TDigest;
+
+TDigest *TDigest_New(double compression);
+void TDigest_Free(TDigest *td);
+
+void TDigest_Add(TDigest *td, double value, double weight);
+
+/* Add the centroids of `src` to `dst` */
+void TDigest_Merge(TDigest *dst, TDigest *src);
+
+/* Estimate the value at quantile `q`, between 0 and 1. Returns NAN if the digest is empty */
+double TDigest_Quantile(TDigest *td, double q);
+
+static inline double TDigest_Count(const TDigest *td) {
+  return td->totalWeight;
+}
+
+/**
+ * Serialize the digest into a newly allocated buffer. The serialized form is portable between
+ * threads and shards, and is loaded with TDigest_Deserialize.
+ */
+char *TDigest_Serialize(TDigest *td, size_t *len);
+
+/* Returns NULL if `buf` is not a serialized digest */
+TDigest *TDigest_Deserialize(const char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
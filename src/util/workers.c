@@ -30,6 +30,9 @@ static void yieldCallback(void *yieldCtx) {
   RedisModule_Yield(ctx, REDISMODULE_YIELD_FLAG_CLIENTS, NULL);
 }
 
+static void noYieldCallback(void *yieldCtx) {
+}
+
 // set up workers' thread pool
 int workersThreadPool_CreatePool(size_t worker_count) {
   assert(worker_count);
@@ -79,6 +82,14 @@ void workersThreadPool_Drain(RedisModuleCtx *ctx, size_t threshold) {
   }
 }
 
+// Wait until job queue contains no more than <threshold> pending jobs, without yielding.
+void workersThreadPool_DrainFromBackground(size_t threshold) {
+  if (!_workers_thpool) {
+    return;
+  }
+  redisearch_thpool_drain(_workers_thpool, 100, noYieldCallback, NULL, threshold);
+}
+
 void workersThreadPool_Terminate(void) {
   redisearch_thpool_terminate_threads(_workers_thpool);
 }
@@ -31,6 +31,10 @@ int workersThreadPool_AddWork(redisearch_thpool_proc, void *arg_p);
 // Wait until the workers job queue contains no more than <threshold> jobs.
 void workersThreadPool_Drain(RedisModuleCtx *ctx, size_t threshold);
 
+// Wait until the workers job queue contains no more than <threshold> jobs, from a thread which
+// doesn't hold the GIL. The workers must be running, otherwise the queue is never drained.
+void workersThreadPool_DrainFromBackground(size_t threshold);
+
 // Terminate threads, allows threads to exit gracefully (without deallocating).
 void workersThreadPool_Terminate(void);
 
@@ -11,6 +11,7 @@
 #include "rdb.h"
 #include "util/workers_pool.h"
 #include "util/threadpool_api.h"
+#include "util/strconv.h"
 
 static VecSimIndex *openVectorKeysDict(IndexSpec *spec, RedisModuleString *keyName, int write) {
   KeysDictValue *kdv = dictFetchValue(spec->keysDict, keyName);
@@ -86,6 +87,7 @@ IndexIterator *NewVectorIterator(QueryEvalCtx *q, VectorQuery *vq, IndexIterator
   VecSimMetric metric = info.metric;
 
   VecSimQueryParams qParams = {0};
+  bool filtered = false;
   switch (vq->type) {
     case VECSIM_QT_KNN: {
       if ((dim * VecSimType_sizeof(type)) != vq->knn.vecLen) {
@@ -97,7 +99,7 @@ IndexIterator *NewVectorIterator(QueryEvalCtx *q, VectorQuery *vq, IndexIterator
       }
       VecsimQueryType queryType = child_it != NULL ? QUERY_TYPE_HYBRID : QUERY_TYPE_KNN;
       if (VecSim_ResolveQueryParams(vecsim, vq->params.params, array_len(vq->params.params),
-                                    &qParams, queryType, q->status) != VecSim_OK)  {
+                                    &qParams, &filtered, queryType, q->status) != VecSim_OK)  {
         return NULL;
       }
       HybridIteratorParams hParams = {.index = vecsim,
@@ -106,6 +108,7 @@ IndexIterator *NewVectorIterator(QueryEvalCtx *q, VectorQuery *vq, IndexIterator
                                       .spaceMetric = metric,
                                       .query = vq->knn,
                                       .qParams = qParams,
+                                      .filtered = filtered,
                                       .vectorScoreField = vq->scoreField,
                                       .ignoreDocScore = q->opts->flags & Search_IgnoreScores,
                                       .childIt = child_it,
@@ -129,7 +132,7 @@ IndexIterator *NewVectorIterator(QueryEvalCtx *q, VectorQuery *vq, IndexIterator
         return NULL;
       }
       if (VecSim_ResolveQueryParams(vecsim, vq->params.params, array_len(vq->params.params),
-                                    &qParams, QUERY_TYPE_RANGE, q->status) != VecSim_OK)  {
+                                    &qParams, &filtered, QUERY_TYPE_RANGE, q->status) != VecSim_OK)  {
         return NULL;
       }
       qParams.timeoutCtx = &(TimeoutCtx){ .timeout = q->sctx->timeout, .counter = 0 };
@@ -451,9 +454,35 @@ void VecSimParams_Cleanup(VecSimParams *params) {
 }
 
 VecSimResolveCode VecSim_ResolveQueryParams(VecSimIndex *index, VecSimRawParam *params, size_t params_len,
-                          VecSimQueryParams *qParams, VecsimQueryType queryType, QueryError *status) {
+                          VecSimQueryParams *qParams, bool *filtered, VecsimQueryType queryType,
+                          QueryError *status) {
+
+  // The FILTERED hybrid policy is resolved here, since VecSim doesn't know it. The rest of the
+  // params are resolved by VecSim.
+  VecSimRawParam vsParams[params_len ? params_len : 1];
+  size_t vsParamsLen = 0;
+  VecSimResolveCode vecSimCode = VecSim_OK;
+  *filtered = false;
+  for (size_t i = 0; i < params_len; i++) {
+    if (STR_EQCASE(params[i].name, params[i].nameLen, VECSIM_HYBRID_POLICY) &&
+        STR_EQCASE(params[i].value, params[i].valLen, VECSIM_POLICY_FILTERED)) {
+      vecSimCode = *filtered ? VecSimParamResolverErr_AlreadySet : vecSimCode;
+      *filtered = true;
+    } else {
+      vsParams[vsParamsLen++] = params[i];
+    }
+  }
+  if (*filtered && queryType != QUERY_TYPE_HYBRID) {
+    vecSimCode = VecSimParamResolverErr_InvalidPolicy_NHybrid;
+  }
 
-  VecSimResolveCode vecSimCode = VecSimIndex_ResolveParams(index, params, params_len, qParams, queryType);
+  if (vecSimCode == VecSim_OK) {
+    vecSimCode = VecSimIndex_ResolveParams(index, vsParams, vsParamsLen, qParams, queryType);
+  }
+  if (vecSimCode == VecSim_OK && *filtered && qParams->searchMode) {
+    // Another policy was given as well
+    vecSimCode = VecSimParamResolverErr_AlreadySet;
+  }
   if (vecSimCode == VecSim_OK) {
     return vecSimCode;
   }
@@ -32,6 +32,7 @@
 #define VECSIM_EPSILON "EPSILON"
 #define VECSIM_HYBRID_POLICY "HYBRID_POLICY"
 #define VECSIM_BATCH_SIZE "BATCH_SIZE"
+#define VECSIM_POLICY_FILTERED "FILTERED"
 #define VECSIM_TYPE "TYPE"
 #define VECSIM_DIM "DIM"
 #define VECSIM_DISTANCE_METRIC "DISTANCE_METRIC"
@@ -39,6 +40,12 @@
 #define VECSIM_ERR_MANDATORY(status,algorithm,arg) \
   QERR_MKBADARGS_FMT(status, "Missing mandatory parameter: cannot create %s index without specifying %s argument", algorithm, arg)
 
+// Quantized vector storage is not supported by the vector similarity library. QUANTIZATION is
+// not a schema option, the keyword is only recognized to reject it with a clear error
+#define VECSIM_DECLINED_QUANTIZATION "QUANTIZATION"
+#define VECSIM_ERR_QUANTIZATION(status,algorithm) \
+  QERR_MKBADARGS_FMT(status, "Bad arguments for algorithm %s: %s is not supported by the vector similarity library", algorithm, VECSIM_DECLINED_QUANTIZATION)
+
 typedef enum {
   VECSIM_QT_KNN,
   VECSIM_QT_RANGE
@@ -98,7 +105,6 @@ typedef enum {
                                      //  query vector.
   VECSIM_LAST_SEARCHMODE,            // Last value of this enum. Can be used to check if a given value resides within
                                      //  this enum values range.
-
 } VecSimSearchMode;
 
 // External log ctx to be sent to the log callback that vecsim is using internally.
@@ -117,8 +123,10 @@ int VectorQuery_EvalParams(dict *params, QueryNode *node, QueryError *status);
 int VectorQuery_ParamResolve(VectorQueryParams params, size_t index, dict *paramsDict, QueryError *status);
 void VectorQuery_Free(VectorQuery *vq);
 
+// `*filtered` is set if the FILTERED hybrid policy was given, which is resolved by RediSearch.
 VecSimResolveCode VecSim_ResolveQueryParams(VecSimIndex *index, VecSimRawParam *params, size_t params_len,
-                                            VecSimQueryParams *qParams, VecsimQueryType queryType, QueryError *status);
+                                            VecSimQueryParams *qParams, bool *filtered,
+                                            VecsimQueryType queryType, QueryError *status);
 size_t VecSimType_sizeof(VecSimType type);
 const char *VecSimType_ToString(VecSimType type);
 const char *VecSimMetric_ToString(VecSimMetric metric);
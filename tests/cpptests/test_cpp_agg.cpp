@@ -11,6 +11,8 @@
 
 #include <vector>
 #include <array>
+#include <map>
+#include <string>
 #include <iostream>
 #include <cstdarg>
 
@@ -246,6 +248,77 @@ TEST_F(AggTest, testGroupSplit) {
   RLookup_Cleanup(&lk_out);
 }
 
+TEST_F(AggTest, testGroupByParallel) {
+  QueryIterator qitr = {0};
+  RPMock ctx;
+  RLookup rk_in = {0};
+  const char *values[] = {"foo", "bar", "baz", "foo"};
+  ctx.values = values;
+  ctx.numvals = sizeof(values) / sizeof(values[0]);
+  ctx.rkscore = RLookup_GetKey(&rk_in, "score", RLOOKUP_M_WRITE, RLOOKUP_F_NOFLAGS);
+  ctx.rkvalue = RLookup_GetKey(&rk_in, "value", RLOOKUP_M_WRITE, RLOOKUP_F_NOFLAGS);
+  ctx.Next = [](ResultProcessor *rp, SearchResult *res) -> int {
+    RPMock *p = (RPMock *)rp;
+    if (p->counter >= NUM_RESULTS) {
+      return RS_RESULT_EOF;
+    }
+    res->docId = ++p->counter;
+    RSValue *sval = RS_ConstStringValC((char *)p->values[p->counter % p->numvals]);
+    RLookup_WriteOwnKey(p->rkvalue, &res->rowdata, sval);
+    RLookup_WriteOwnKey(p->rkscore, &res->rowdata, RS_NumVal(p->counter));
+    return RS_RESULT_OK;
+  };
+  QITR_PushRP(&qitr, &ctx);
+
+  RLookup rk_out = {0};
+  RLookupKey *v_out = RLookup_GetKey(&rk_out, "value", RLOOKUP_M_WRITE, RLOOKUP_F_NOFLAGS);
+  RLookupKey *score_out = RLookup_GetKey(&rk_out, "SCORE", RLOOKUP_M_WRITE, RLOOKUP_F_NOFLAGS);
+  RLookupKey *count_out = RLookup_GetKey(&rk_out, "COUNT", RLOOKUP_M_WRITE, RLOOKUP_F_NOFLAGS);
+
+  Grouper *gr = Grouper_New((const RLookupKey **)&ctx.rkvalue, (const RLookupKey **)&v_out, 1);
+  ArgsCursor args = {0};
+  ReducerOptions opt = {0};
+  opt.args = &args;
+  Grouper_AddReducer(gr, RDCRCount_New(&opt), count_out);
+  ReducerOptionsCXX sumOptions("SUM", &rk_in, "score");
+  Grouper_AddReducer(gr, RDCRSum_New(&sumOptions), score_out);
+  ResultProcessor *gp = Grouper_GetRP(gr);
+  QITR_PushRP(&qitr, gp);
+
+  // the rows are aggregated by 4 partial groupers, whose groups are merged
+  size_t groupbyThreads = RSGlobalConfig.groupbyThreads;
+  RSGlobalConfig.groupbyThreads = 4;
+
+  SearchResult res = {0};
+  std::map<std::string, std::pair<double, double>> groups;
+  while (gp->Next(gp, &res) == RS_RESULT_OK) {
+    RSValue *v = RLookup_GetItem(v_out, &res.rowdata);
+    ASSERT_TRUE(v != NULL && RSValue_IsString(v));
+    double count = 0, score = 0;
+    ASSERT_TRUE(RSValue_ToNumber(RLookup_GetItem(count_out, &res.rowdata), &count));
+    ASSERT_TRUE(RSValue_ToNumber(RLookup_GetItem(score_out, &res.rowdata), &score));
+    groups[RSValue_StringPtrLen(v, NULL)] = {count, score};
+    SearchResult_Clear(&res);
+  }
+  RSGlobalConfig.groupbyThreads = groupbyThreads;
+
+  ASSERT_EQ(3, groups.size());
+  // counter % 4 is 1 for "bar", 2 for "baz", and 0 or 3 for "foo"
+  ASSERT_EQ(NUM_RESULTS / 4, groups["bar"].first);
+  ASSERT_EQ(NUM_RESULTS / 4, groups["baz"].first);
+  ASSERT_EQ(NUM_RESULTS / 2, groups["foo"].first);
+  double total = 0;
+  for (auto &it : groups) {
+    total += it.second.second;
+  }
+  ASSERT_EQ((double)NUM_RESULTS * (NUM_RESULTS + 1) / 2, total);
+
+  SearchResult_Destroy(&res);
+  gp->Free(gp);
+  RLookup_Cleanup(&rk_out);
+  RLookup_Cleanup(&rk_in);
+}
+
 #if 0
 int testAggregatePlan() {
   CmdString *argv = CmdParser_NewArgListV(
@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 #include "aggregate/expr/expression.h"
 #include "aggregate/expr/exprast.h"
+#include "aggregate/expr/bytecode.h"
 #include "aggregate/functions/function.h"
 #include "util/arr.h"
 
@@ -262,3 +263,68 @@ TEST_F(ExprTest, testPropertyFetch) {
   RLookupRow_Cleanup(&rr);
   RLookup_Cleanup(&lk);
 }
+
+TEST_F(ExprTest, testProgram) {
+  RLookup lk = {0};
+  RLookup_Init(&lk, NULL);
+  auto *kfoo = RLookup_GetKey(&lk, "foo", RLOOKUP_M_WRITE, RLOOKUP_F_NOFLAGS);
+  auto *kbar = RLookup_GetKey(&lk, "bar", RLOOKUP_M_WRITE, RLOOKUP_F_NOFLAGS);
+  RLookupRow rows[4] = {{0}};
+  RLookup_WriteOwnKey(kfoo, &rows[0], RS_NumVal(1));
+  RLookup_WriteOwnKey(kbar, &rows[0], RS_NumVal(2));
+  RLookup_WriteOwnKey(kfoo, &rows[1], RS_NumVal(-3));
+  RLookup_WriteOwnKey(kbar, &rows[1], RS_NumVal(0));
+  // rows which the program can not evaluate
+  RLookup_WriteOwnKey(kfoo, &rows[2], RS_ConstStringValC("4"));
+  RLookup_WriteOwnKey(kbar, &rows[2], RS_NumVal(2));
+  RLookup_WriteOwnKey(kbar, &rows[3], RS_NumVal(2));
+  const RLookupRow *rowsp[4] = {&rows[0], &rows[1], &rows[2], &rows[3]};
+
+  const char *exprs[] = {"@foo + @bar * 2 - 1", "@foo / @bar", "@foo % @bar", "2 ^ @foo",
+                         "@foo > @bar || @bar == 0", "!(@foo <= 1) && @bar", "@foo != -3"};
+  for (auto e : exprs) {
+    TEvalCtx ctx(e);
+    ASSERT_TRUE(ctx) << ctx.error();
+    ctx.lookup = &lk;
+    ASSERT_EQ(EXPR_EVAL_OK, ctx.bindLookupKeys());
+
+    ExprProgram *prog = ExprProgram_Compile(ctx.root);
+    ASSERT_TRUE(prog != NULL) << e;
+    double scratch[ExprProgram_ScratchSize(prog, 4)];
+    bool fallback[4];
+    ExprProgram_EvalBatch(prog, rowsp, 4, scratch, fallback);
+    ASSERT_FALSE(fallback[0]);
+    ASSERT_FALSE(fallback[1]);
+    ASSERT_TRUE(fallback[2]);
+    ASSERT_TRUE(fallback[3]);
+
+    // the program computes the same values as the expression tree
+    for (size_t i = 0; i < 2; ++i) {
+      ctx.srcrow = &rows[i];
+      ASSERT_EQ(EXPR_EVAL_OK, ctx.eval()) << e;
+      ASSERT_EQ(RSValue_Number, ctx.result().t);
+      if (isnan(ctx.result().numval)) {
+        ASSERT_TRUE(isnan(scratch[i])) << e;
+      } else {
+        ASSERT_EQ(ctx.result().numval, scratch[i]) << e;
+      }
+      double d;
+      ASSERT_TRUE(ExprProgram_EvalRow(prog, &rows[i], &d));
+      ASSERT_EQ(0, memcmp(&d, &scratch[i], sizeof(d)));
+    }
+    ExprProgram_Free(prog);
+  }
+
+  // expressions which are not numeric are not compiled
+  const char *notCompiled[] = {"log(@foo)", "@foo == 'foo'", "NULL", "@foo + sqrt(4)"};
+  for (auto e : notCompiled) {
+    TEvalCtx ctx(e);
+    ASSERT_TRUE(ctx) << ctx.error();
+    ASSERT_TRUE(ExprProgram_Compile(ctx.root) == NULL) << e;
+  }
+
+  for (auto &rr : rows) {
+    RLookupRow_Cleanup(&rr);
+  }
+  RLookup_Cleanup(&lk);
+}
@@ -313,3 +313,46 @@ TEST_F(FGCTest, testRemoveMiddleBlock) {
   ASSERT_NE(ss.end(), ss.find(numToDocid(lastLastBlockId)));
   ASSERT_EQ(0, fgc->stats.gcBlocksDenied);
 }
+
+/**
+ * Blocks left underfilled by the repair are merged with their neighbours,
+ * while the last block is left for the parent to keep writing to.
+ */
+TEST_F(FGCTest, testMergeUnderfilledBlocks) {
+  unsigned curId = 0;
+  RedisSearchCtx sctx = SEARCH_CTX_STATIC(ctx, get_spec(ism));
+  InvertedIndex *iv = getTagInvidx(&sctx, "f1", "hello");
+
+  while (iv->size < 4) {
+    ASSERT_TRUE(RS::addDocument(ctx, ism, numToDocid(++curId).c_str(), "f1", "hello"));
+  }
+  unsigned lastId = curId;
+  ASSERT_EQ(4, iv->size);
+
+  // Keep every tenth document of the first three blocks
+  std::set<std::string> expected;
+  for (unsigned ii = 1; ii < lastId; ++ii) {
+    if (ii % 10) {
+      ASSERT_TRUE(RS::deleteDocument(ctx, ism, numToDocid(ii).c_str()));
+    } else {
+      expected.insert(numToDocid(ii));
+    }
+  }
+  expected.insert(numToDocid(lastId));
+
+  FGC_WaitAtFork(fgc);
+  FGC_WaitAtApply(fgc);
+  FGC_WaitClear(fgc);
+
+  // The three repaired blocks fit in a single one, the last block is kept
+  ASSERT_EQ(2, iv->size);
+  ASSERT_EQ(2, fgc->stats.gcBlocksMerged);
+  ASSERT_LT(0, fgc->stats.gcBytesMerged);
+  ASSERT_EQ(lastId / 10 + 1, iv->numDocs);
+  ASSERT_EQ(lastId / 10, iv->blocks[0].numEntries);
+  ASSERT_EQ(lastId - 1, iv->blocks[0].lastId);
+
+  auto vv = RS::search(ism, "@f1:{hello}");
+  std::set<std::string> ss(vv.begin(), vv.end());
+  ASSERT_EQ(expected, ss);
+}
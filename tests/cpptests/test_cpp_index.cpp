@@ -24,6 +24,7 @@
 #include <time.h>
 #include <float.h>
 #include <vector>
+#include <set>
 #include <cstdint>
 #include <random>
 #include <chrono>
@@ -819,6 +820,81 @@ TEST_F(IndexTest, testHybridVector) {
   VecSimIndex_Free(index);
 }
 
+TEST_F(IndexTest, testHybridVectorAdhocBatches) {
+  // More child results than a single batch of ad-hoc BF distances
+  size_t n = 1000;
+  size_t d = 4;
+  size_t k = 10;
+  VecSimType t = VecSimType_FLOAT32;
+  InvertedIndex *w = createIndex(n, 1);
+
+  VecSimParams params{.algo = VecSimAlgo_BF,
+                      .algoParams = {.bfParams = BFParams{.type = t,
+                                                          .dim = d,
+                                                          .metric = VecSimMetric_L2,
+                                                          .initialCapacity = n}}};
+  VecSimIndex *index = VecSimIndex_New(&params);
+  // Every other id has a vector, and the closest ones to the query are in the middle
+  for (size_t i = 1; i <= n; i += 2) {
+    float f[d];
+    for (size_t j = 0; j < d; j++) {
+      f[j] = (float)i;
+    }
+    VecSimIndex_AddVector(index, (const void *)f, (int)i);
+  }
+
+  float query[] = {(float)(n / 2), (float)(n / 2), (float)(n / 2), (float)(n / 2)};
+  KNNVectorQuery top_k_query = {.vector = query, .vecLen = d, .k = k, .order = BY_SCORE};
+  VecSimQueryParams queryParams = {0};
+
+  for (bool ignoreDocScore : {true, false}) {
+    IndexReader *r = NewTermIndexReader(w, NULL, RS_FIELDMASK_ALL, NULL, 1);
+    HybridIteratorParams hParams = {.index = index,
+                                    .dim = d,
+                                    .elementType = t,
+                                    .spaceMetric = VecSimMetric_L2,
+                                    .query = top_k_query,
+                                    .qParams = queryParams,
+                                    .vectorScoreField = (char *)"__v_score",
+                                    .ignoreDocScore = ignoreDocScore,
+                                    .childIt = NewReadIterator(r)};
+    QueryError err = {QUERY_OK};
+    IndexIterator *hybridIt = NewHybridVectorIterator(hParams, &err);
+    ASSERT_FALSE(QueryError_HasError(&err)) << QueryError_GetError(&err);
+    HybridIterator *hr = (HybridIterator *)hybridIt->ctx;
+    hr->searchMode = VECSIM_HYBRID_ADHOC_BF;
+
+    // 499 and 501 are the closest, then 497 and 503, and so on
+    std::set<t_docId> expected;
+    for (size_t i = 0; i < k / 2; i++) {
+      expected.insert(n / 2 - 1 - 2 * i);
+      expected.insert(n / 2 + 1 + 2 * i);
+    }
+    std::set<t_docId> found;
+    RSIndexResult *h = NULL;
+    double prev = -1;
+    while (hybridIt->Read(hybridIt->ctx, &h) != INDEXREAD_EOF) {
+      if (ignoreDocScore) {
+        ASSERT_EQ(h->type, RSResultType_Metric);
+      } else {
+        ASSERT_EQ(h->type, RSResultType_HybridMetric);
+        ASSERT_EQ(h->agg.numChildren, 2);
+        // The child result is the one of the same document
+        ASSERT_EQ(h->agg.children[1]->docId, h->docId);
+      }
+      double score = (h->type == RSResultType_Metric ? h : h->agg.children[0])->num.value;
+      ASSERT_LE(prev, score);
+      prev = score;
+      found.insert(h->docId);
+    }
+    ASSERT_EQ(found, expected);
+    hybridIt->Free(hybridIt);
+  }
+
+  InvertedIndex_Free(w);
+  VecSimIndex_Free(index);
+}
+
 TEST_F(IndexTest, testInvalidHybridVector) {
 
   size_t n = 1;
@@ -1014,6 +1090,42 @@ TEST_F(IndexTest, testMetric_SkipTo) {
   metric_it->Free(metric_it);
 }
 
+TEST_F(IndexTest, testMetric_SkipToFar) {
+  // Skip over many results at once, to ids which are and are not in the results
+  size_t results_num = 1000;
+  t_docId *ids_arr = array_new(t_docId, results_num);
+  double *metrics_arr = array_new(double, results_num);
+  for (size_t i = 0; i < results_num; i++) {
+    ids_arr = array_append(ids_arr, 3 * i + 3);
+    metrics_arr = array_append(metrics_arr, (double)i);
+  }
+
+  IndexIterator *metric_it = NewMetricIterator(ids_arr, metrics_arr, VECTOR_DISTANCE, false);
+  RSIndexResult *h = NULL;
+  t_docId targets[] = {1, 4, 9, 31, 34, 100, 500, 502, 1024, 2990};
+  for (t_docId target : targets) {
+    t_docId expected = (target + 2) / 3 * 3;
+    ASSERT_EQ(metric_it->SkipTo(metric_it->ctx, target, &h),
+              expected == target ? INDEXREAD_OK : INDEXREAD_NOTFOUND);
+    ASSERT_EQ(h->docId, expected);
+    ASSERT_EQ(h->num.value, (double)(expected / 3 - 1));
+  }
+  // The next read continues after the last skip
+  ASSERT_EQ(metric_it->Read(metric_it->ctx, &h), INDEXREAD_OK);
+  ASSERT_EQ(h->docId, 2994);
+
+  ASSERT_EQ(metric_it->SkipTo(metric_it->ctx, 2998, &h), INDEXREAD_NOTFOUND);
+  ASSERT_EQ(h->docId, 3000);
+  ASSERT_FALSE(metric_it->HasNext(metric_it->ctx));
+
+  metric_it->Rewind(metric_it->ctx);
+  ASSERT_EQ(metric_it->SkipTo(metric_it->ctx, 3001, &h), INDEXREAD_EOF);
+  ASSERT_EQ(metric_it->LastDocId(metric_it->ctx), 3000);
+  ASSERT_FALSE(metric_it->HasNext(metric_it->ctx));
+
+  metric_it->Free(metric_it);
+}
+
 TEST_F(IndexTest, testBuffer) {
   // TEST_START();
   Buffer b = {0};
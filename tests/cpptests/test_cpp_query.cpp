@@ -916,3 +916,37 @@ TEST_F(QueryTest, testWildcard) {
 
   StrongRef_Release(ref);
 }
+
+TEST_F(QueryTest, testCloneWithParams) {
+  static const char *args[] = {"SCHEMA", "title", "text", "bar", "numeric"};
+  QueryError err = {QueryErrorCode(0)};
+  StrongRef ref = IndexSpec_Parse("idx", args, sizeof(args) / sizeof(const char *), &err);
+  RedisSearchCtx ctx = SEARCH_CTX_STATIC(NULL, (IndexSpec *)StrongRef_Get(ref));
+  QASTCXX ast;
+  ast.setContext(&ctx);
+
+  ASSERT_TRUE(ast.parse("@bar:[$min $max] @title:$w", 2)) << ast.getError();
+  QueryNode *clone = QueryNode_Clone(ast.root);
+  // the clone must not refer to the parsed query
+  QAST_Destroy(&ast);
+
+  dict *params = Param_DictCreate();
+  Param_DictAdd(params, "min", "1", 1, &err);
+  Param_DictAdd(params, "max", "5", 1, &err);
+  Param_DictAdd(params, "w", "hello", 5, &err);
+  ASSERT_EQ(REDISMODULE_OK, QueryNode_EvalParams(params, clone, &err)) << QueryError_GetError(&err);
+
+  ASSERT_EQ(clone->type, QN_PHRASE);
+  ASSERT_EQ(QueryNode_NumChildren(clone), 2);
+  QueryNode *nn = clone->children[0];
+  ASSERT_EQ(nn->type, QN_NUMERIC);
+  ASSERT_EQ(nn->nn.nf->min, 1);
+  ASSERT_EQ(nn->nn.nf->max, 5);
+  QueryNode *tn = clone->children[1];
+  ASSERT_EQ(tn->type, QN_TOKEN);
+  ASSERT_STREQ(tn->tn.str, "hello");
+
+  Param_DictFree(params);
+  QueryNode_Free(clone);
+  StrongRef_Release(ref);
+}
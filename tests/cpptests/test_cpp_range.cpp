@@ -8,6 +8,9 @@
 #include <stdio.h>
 
 extern "C" {
+#include "rs_geo.h"
+#include "geo_index.h"
+
 // declaration for an internal function implemented in numeric_index.c
 IndexIterator *createNumericIterator(const IndexSpec* sp, NumericRangeTree *t, const NumericFilter *f, IteratorsConfig *config);
 }
@@ -213,6 +216,106 @@ TEST_F(RangeTest, testRangeIteratorMulti) {
   testRangeIteratorHelper(true);
 }
 
+TEST_F(RangeTest, testSplitAndMergeLeaves) {
+  // a high split cardinality, so only the size of the leaf can make it split
+  NumericRangeNode *n = NewLeafNode(2, 2500);
+  NRN_AddRv rv = {0};
+  for (size_t i = 0; i < NR_MAXRANGE_SIZE; i++) {
+    rv = NumericRangeNode_Add(n, i + 1, (double)(i % 2));
+    ASSERT_EQ(0, rv.changed);
+  }
+  ASSERT_TRUE(NumericRangeNode_IsLeaf(n));
+
+  rv = NumericRangeNode_Add(n, NR_MAXRANGE_SIZE + 1, 0);
+  ASSERT_EQ(1, rv.changed);
+  // two leaves were added and the range of the split node was dropped
+  ASSERT_EQ(1, rv.numRanges);
+  ASSERT_FALSE(NumericRangeNode_IsLeaf(n));
+  ASSERT_EQ(NR_MAXRANGE_SIZE / 2 + 1, n->left->range->entries->numDocs);
+  ASSERT_EQ(NR_MAXRANGE_SIZE / 2, n->right->range->entries->numDocs);
+
+  // a leaf has no children to merge
+  ASSERT_EQ(0, NumericRangeNode_MergeLeaves(n->left, &rv));
+
+  rv = {0};
+  ASSERT_EQ(1, NumericRangeNode_MergeLeaves(n, &rv));
+  ASSERT_EQ(1, rv.changed);
+  ASSERT_EQ(-1, rv.numRanges);
+  ASSERT_EQ(0, rv.emptyLeaves);
+  ASSERT_TRUE(NumericRangeNode_IsLeaf(n));
+  ASSERT_EQ(0, NumericRangeNode_UpdateDepth(n, &rv));
+  ASSERT_EQ(NR_MAXRANGE_SIZE + 1, n->range->entries->numDocs);
+
+  // the merged leaf keeps its entries ordered by docId
+  RSIndexResult *res = NULL;
+  IndexReader *ir = NewNumericReader(NULL, n->range->entries, NULL, 0, 0, false);
+  t_docId expected = 1;
+  while (INDEXREAD_OK == IR_Read(ir, &res)) {
+    ASSERT_EQ(expected, res->docId);
+    ASSERT_EQ((double)((expected - 1) % 2), res->num.value);
+    expected++;
+  }
+  ASSERT_EQ(NR_MAXRANGE_SIZE + 2, expected);
+  IR_Free(ir);
+  NumericRangeNode_Free(n);
+
+  // merging two empty leaves leaves a single empty leaf behind
+  n = NewLeafNode(2, 16);
+  for (size_t i = 0; i < 2; i++) {
+    NumericRangeNode_Add(n, i + 1, (double)i);
+  }
+  ASSERT_FALSE(NumericRangeNode_IsLeaf(n));
+  NumericRangeNode *left = n->left, *right = n->right;
+  InvertedIndex_Free(left->range->entries);
+  left->range->entries = NewInvertedIndex(Index_StoreNumeric, 1);
+  InvertedIndex_Free(right->range->entries);
+  right->range->entries = NewInvertedIndex(Index_StoreNumeric, 1);
+
+  rv = {0};
+  ASSERT_EQ(1, NumericRangeNode_MergeLeaves(n, &rv));
+  ASSERT_EQ(-1, rv.emptyLeaves);
+  ASSERT_EQ(0, n->range->entries->numDocs);
+  NumericRangeNode_Free(n);
+}
+
+TEST_F(RangeTest, testSplitLeafAt) {
+  // The cardinality of a leaf is sampled every NR_CARD_CHECK entries. Every sampled entry has the
+  // same value, so the leaf grows past NR_MAXRANGE_SIZE without ever being split on insertion.
+  NumericRangeNode *n = NewLeafNode(2, 16);
+  size_t n_entries = NR_MAXRANGE_SIZE + NR_MAXRANGE_SIZE / 2, n_low = 0;
+  NRN_AddRv rv = {0};
+  for (size_t i = 1; i <= n_entries; i++) {
+    double value = i % NR_CARD_CHECK ? (double)(i % 7 + 1) : 0;
+    n_low += value < 4;
+    rv = NumericRangeNode_Add(n, i, value);
+    ASSERT_EQ(0, rv.changed);
+  }
+  ASSERT_TRUE(NumericRangeNode_IsLeaf(n));
+  ASSERT_EQ(n_entries, n->range->entries->numDocs);
+
+  rv = {0};
+  // both sides of the split must keep values
+  ASSERT_EQ(0, NumericRangeNode_SplitAt(n, 0, &rv));
+  ASSERT_EQ(0, NumericRangeNode_SplitAt(n, 8, &rv));
+  ASSERT_EQ(0, rv.changed);
+
+  ASSERT_EQ(1, NumericRangeNode_SplitAt(n, 4, &rv));
+  ASSERT_EQ(1, rv.changed);
+  // two leaves were added and the range of the split node was dropped
+  ASSERT_EQ(1, rv.numRanges);
+  ASSERT_FALSE(NumericRangeNode_IsLeaf(n));
+  ASSERT_EQ(4, n->value);
+  ASSERT_EQ(n_low, n->left->range->entries->numDocs);
+  ASSERT_EQ(n_entries - n_low, n->right->range->entries->numDocs);
+  ASSERT_EQ(3, n->left->range->maxVal);
+  ASSERT_EQ(4, n->right->range->minVal);
+  ASSERT_EQ(1, NumericRangeNode_UpdateDepth(n, &rv));
+  // only leaves can be split
+  ASSERT_EQ(0, NumericRangeNode_SplitAt(n, 2, &rv));
+
+  NumericRangeNode_Free(n);
+}
+
 // int benchmarkNumericRangeTree() {
 //   NumericRangeTree *t = NewNumericRangeTree();
 //   int count = 1;
@@ -245,3 +348,67 @@ TEST_F(RangeTest, testRangeIteratorMulti) {
 //   NumericFilter_Free(flt);
 //   return 0;
 // }
+
+TEST_F(RangeTest, testGeoCoverRanges) {
+  double lon = 2.35, lat = 48.85, radius = 5000;
+  GeoCoverRange ranges[GEO_MAX_RANGES];
+  size_t n = calcCoverRanges(lon, lat, radius, ranges);
+  ASSERT_GT(n, 0);
+  ASSERT_LE(n, GEO_MAX_RANGES);
+
+  size_t numInside = 0;
+  for (size_t i = 0; i < 20000; i++) {
+    // points around the box of the circle
+    double plon = lon + ((double)prng() / PRNG_MOD - 0.5) * 0.3;
+    double plat = lat + ((double)prng() / PRNG_MOD - 0.5) * 0.2;
+    double bits, xy[2];
+    encodeGeo(plon, plat, &bits);
+    decodeGeo(bits, xy);
+    bool within = isWithinRadiusLonLat(lon, lat, xy[0], xy[1], radius, NULL);
+
+    const GeoCoverRange *cover = NULL;
+    for (size_t j = 0; j < n; j++) {
+      if (bits >= ranges[j].range.min && bits < ranges[j].range.max) {
+        cover = &ranges[j];
+      }
+    }
+    // every point of the circle is covered, and the points of the inside ranges are in the circle
+    if (within) {
+      ASSERT_TRUE(cover != NULL) << plon << "," << plat;
+    }
+    if (cover && cover->inside) {
+      ASSERT_TRUE(within) << plon << "," << plat;
+      numInside++;
+    }
+  }
+  ASSERT_GT(numInside, 0);
+}
+
+TEST_F(RangeTest, testGeoRangeKeepsScore) {
+  GeoFilter gf = {.property = "loc", .lat = 48.85, .lon = 2.35, .radius = 5, .unitType = GEO_DISTANCE_KM};
+  // points close to the center, all of them within the radius
+  InvertedIndex *idx = NewInvertedIndex(Index_StoreNumeric, 1);
+  double scores[100];
+  for (size_t i = 0; i < 100; i++) {
+    encodeGeo(gf.lon + i * 0.0001, gf.lat + i * 0.0001, &scores[i]);
+    InvertedIndex_WriteNumericEntry(idx, i + 1, scores[i]);
+  }
+
+  // whether the range is within the radius or crosses it, the results keep their geohash score
+  for (bool inside : {true, false}) {
+    NumericFilter *flt = NewNumericFilter(NF_NEGATIVE_INFINITY, NF_INFINITY, 1, 1, true);
+    flt->geoFilter = &gf;
+    flt->geoInside = inside;
+    IndexReader *ir = NewNumericReader(NULL, idx, flt, 0, 0, false);
+    RSIndexResult *res = NULL;
+    size_t n = 0;
+    while (INDEXREAD_OK == IR_Read(ir, &res)) {
+      ASSERT_EQ(scores[res->docId - 1], res->num.value) << (inside ? "inside" : "crossing");
+      n++;
+    }
+    ASSERT_EQ(100, n);
+    IR_Free(ir);
+    NumericFilter_Free(flt);
+  }
+  InvertedIndex_Free(idx);
+}
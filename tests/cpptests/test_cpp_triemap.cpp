@@ -69,6 +69,26 @@ TEST_F(TrieMapTest, testContains) {
   TrieMap_Free(t, freeCb);
 }
 
+TEST_F(TrieMapTest, testLongestPrefix) {
+  TrieMap *t = loadTrieMap();
+
+  ASSERT_STREQ((char *)TrieMap_FindLongestPrefix(t, "helpers", 7), "helper");
+  ASSERT_STREQ((char *)TrieMap_FindLongestPrefix(t, "hello there", 11), "hello");
+  ASSERT_STREQ((char *)TrieMap_FindLongestPrefix(t, "help", 4), "help");
+  ASSERT_STREQ((char *)TrieMap_FindLongestPrefix(t, "hex", 3), "he");
+  ASSERT_EQ(TrieMap_FindLongestPrefix(t, "h", 1), TRIEMAP_NOTFOUND);
+  ASSERT_EQ(TrieMap_FindLongestPrefix(t, "towe", 4), TRIEMAP_NOTFOUND);
+
+  TrieMap_Delete(t, (char *)"hello", 5, freeCb);
+  ASSERT_STREQ((char *)TrieMap_FindLongestPrefix(t, "hello there", 11), "hell");
+
+  TrieMap_Add(t, (char *)"", 0, (void *)"", NULL);
+  ASSERT_STREQ((char *)TrieMap_FindLongestPrefix(t, "towe", 4), "");
+  ASSERT_STREQ((char *)TrieMap_FindLongestPrefix(t, "", 0), "");
+
+  TrieMap_Free(t, freeCb);
+}
+
 void checkNext(TrieMapIterator *iter, const char *str) {
   char *outstr;
   tm_len_t len;
@@ -0,0 +1,110 @@
+/*
+ * Copyright Redis Ltd. 2016 - present
+ * Licensed under your choice of the Redis Source Available License 2.0 (RSALv2) or
+ * the Server Side Public License v1 (SSPLv1).
+ */
+
+#include "src/hll/hll.h"
+#include "rmutil/alloc.h"
+#include "test_util.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+static void addRange(struct HLL *hll, uint64_t from, uint64_t to) {
+  for (uint64_t ii = from; ii < to; ++ii) {
+    hll_add(hll, &ii, sizeof(ii));
+  }
+}
+
+static int testEstimate() {
+  for (uint8_t bits = HLL_MIN_BITS; bits <= 16; bits += 4) {
+    // 4 standard errors
+    double maxErr = 4 * 1.04 / sqrt((double)(1 << bits));
+    for (uint64_t card = 1; card < 1000000; card *= 7) {
+      struct HLL hll;
+      ASSERT_EQUAL(0, hll_init(&hll, bits));
+      addRange(&hll, 0, card);
+      ASSERT(fabs(hll_count(&hll) - card) <= maxErr * card);
+      hll_destroy(&hll);
+    }
+  }
+
+  struct HLL hll;
+  ASSERT(hll_init(&hll, HLL_MIN_BITS - 1) == -1);
+  ASSERT(hll_init(&hll, HLL_MAX_BITS + 1) == -1);
+  ASSERT_EQUAL(0, hll_init(&hll, 10));
+  ASSERT_EQUAL(0, hll_count(&hll));
+  hll_destroy(&hll);
+  return 0;
+}
+
+static int testSparse() {
+  struct HLL sparse, dense;
+  hll_init(&sparse, 14);
+  hll_init(&dense, 14);
+  addRange(&sparse, 0, 100);
+  // few elements don't allocate the registers
+  ASSERT(sparse.registers == NULL);
+  ASSERT(sparse.sparse_len <= 100);
+  ASSERT_EQUAL(100, round(hll_count(&sparse)));
+
+  addRange(&dense, 0, 100000);
+  ASSERT(dense.registers != NULL);
+
+  // a sparse HLL counts the same as its dense registers
+  uint8_t *regs = rm_malloc(sparse.size);
+  hll_copy_registers(&sparse, regs);
+  struct HLL loaded;
+  ASSERT_EQUAL(0, hll_load(&loaded, regs, sparse.size));
+  ASSERT_EQUAL(hll_count(&sparse), hll_count(&loaded));
+  hll_destroy(&loaded);
+  rm_free(regs);
+
+  hll_destroy(&sparse);
+  hll_destroy(&dense);
+  return 0;
+}
+
+static int testMerge() {
+  struct HLL all, parts[4];
+  hll_init(&all, 12);
+  for (int ii = 0; ii < 4; ++ii) {
+    hll_init(&parts[ii], 12);
+  }
+  // parts 0 and 1 are dense, 2 and 3 stay sparse
+  addRange(&parts[0], 0, 50000);
+  addRange(&parts[1], 25000, 75000);
+  addRange(&parts[2], 100000, 100100);
+  addRange(&parts[3], 200000, 200010);
+  addRange(&all, 0, 75000);
+  addRange(&all, 100000, 100100);
+  addRange(&all, 200000, 200010);
+
+  struct HLL merged;
+  hll_init(&merged, 12);
+  for (int ii = 3; ii >= 0; --ii) {
+    ASSERT_EQUAL(0, hll_merge(&merged, &parts[ii]));
+  }
+  ASSERT_EQUAL(hll_count(&all), hll_count(&merged));
+
+  struct HLL other;
+  hll_init(&other, 10);
+  ASSERT(hll_merge(&merged, &other) == -1);
+  hll_destroy(&other);
+
+  hll_destroy(&merged);
+  hll_destroy(&all);
+  for (int ii = 0; ii < 4; ++ii) {
+    hll_destroy(&parts[ii]);
+  }
+  return 0;
+}
+
+TEST_MAIN({
+  RMUTil_InitAlloc();
+
+  TESTFUNC(testEstimate);
+  TESTFUNC(testSparse);
+  TESTFUNC(testMerge);
+})
@@ -36,6 +36,38 @@ static int testBasic() {
   return 0;
 }
 
+// Whether `v` is within `err` ranks of the `q` quantile of the input
+static int isRankWithin(double v, double q, double err) {
+  size_t below = 0, equal = 0;
+  for (size_t ii = 0; ii < numInput; ++ii) {
+    below += input[ii] < v;
+    equal += input[ii] == v;
+  }
+  double rank = q * numInput;
+  return rank >= below - err * numInput && rank <= below + equal + err * numInput;
+}
+
+static int testMerge() {
+  double quantiles[] = {0.50, 0.90, 0.99};
+  QuantStream *streams[3];
+  for (size_t ii = 0; ii < 3; ++ii) {
+    streams[ii] = NewQuantileStream(quantiles, 3, 500);
+  }
+  for (size_t ii = 0; ii < numInput; ++ii) {
+    QS_Insert(streams[ii % 3], input[ii]);
+  }
+  QS_Merge(streams[0], streams[1]);
+  QS_Merge(streams[0], streams[2]);
+  ASSERT_EQUAL(numInput, QS_GetCount(streams[0]));
+  for (size_t ii = 0; ii < 3; ++ii) {
+    ASSERT(isRankWithin(QS_Query(streams[0], quantiles[ii]), quantiles[ii], 0.05));
+  }
+  for (size_t ii = 0; ii < 3; ++ii) {
+    QS_Free(streams[ii]);
+  }
+  return 0;
+}
+
 TEST_MAIN({
   RMUTil_InitAlloc();
 
@@ -54,6 +86,7 @@ TEST_MAIN({
   input = (double *)buf.data;
 
   TESTFUNC(testBasic);
+  TESTFUNC(testMerge);
 
   Buffer_Free(&buf);
 })
\ No newline at end of file
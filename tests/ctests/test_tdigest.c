@@ -0,0 +1,121 @@
+/*
+ * Copyright Redis Ltd. 2016 - present
+ * Licensed under your choice of the Redis Source Available License 2.0 (RSALv2) or
+ * the Server Side Public License v1 (SSPLv1).
+ */
+
+#include "src/util/tdigest.h"
+#include "rmutil/alloc.h"
+#include "test_util.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define NUM_VALUES 100000
+
+static double values[NUM_VALUES];
+
+static int cmpDouble(const void *a, const void *b) {
+  double da = *(const double *)a, db = *(const double *)b;
+  return da < db ? -1 : da > db ? 1 : 0;
+}
+
+// Whether `v` is within `err` ranks of the `q` quantile of the sorted values
+static int isRankWithin(double v, double q, double err) {
+  size_t below = 0;
+  while (below < NUM_VALUES && values[below] < v) {
+    below++;
+  }
+  return fabs((double)below - q * NUM_VALUES) <= err * NUM_VALUES;
+}
+
+static int testQuantiles() {
+  TDigest *td = TDigest_New(TDIGEST_DEFAULT_COMPRESSION);
+  for (size_t ii = 0; ii < NUM_VALUES; ++ii) {
+    TDigest_Add(td, values[ii], 1);
+  }
+  ASSERT_EQUAL(NUM_VALUES, TDigest_Count(td));
+  // the memory is bounded by the compression
+  ASSERT(td->numMerged + td->numBuffered <= td->allocated);
+  ASSERT_EQUAL(td->capacity, td->allocated);
+
+  qsort(values, NUM_VALUES, sizeof(*values), cmpDouble);
+  ASSERT_EQUAL(values[0], TDigest_Quantile(td, 0));
+  ASSERT_EQUAL(values[NUM_VALUES - 1], TDigest_Quantile(td, 1));
+  double quantiles[] = {0.001, 0.01, 0.5, 0.9, 0.99, 0.999};
+  for (size_t ii = 0; ii < sizeof(quantiles) / sizeof(*quantiles); ++ii) {
+    ASSERT(isRankWithin(TDigest_Quantile(td, quantiles[ii]), quantiles[ii], 0.005));
+  }
+  TDigest_Free(td);
+  return 0;
+}
+
+static int testMergeSerialized() {
+  TDigest *td = TDigest_New(TDIGEST_DEFAULT_COMPRESSION);
+  TDigest *parts[4];
+  for (size_t ii = 0; ii < 4; ++ii) {
+    parts[ii] = TDigest_New(TDIGEST_DEFAULT_COMPRESSION);
+  }
+  for (size_t ii = 0; ii < NUM_VALUES; ++ii) {
+    TDigest_Add(parts[ii % 4], values[ii], 1);
+  }
+  for (size_t ii = 0; ii < 4; ++ii) {
+    size_t len;
+    char *buf = TDigest_Serialize(parts[ii], &len);
+    TDigest *other = TDigest_Deserialize(buf, len);
+    ASSERT(other != NULL);
+    TDigest_Merge(td, other);
+    TDigest_Free(other);
+    TDigest_Free(parts[ii]);
+    rm_free(buf);
+  }
+  ASSERT_EQUAL(NUM_VALUES, TDigest_Count(td));
+
+  qsort(values, NUM_VALUES, sizeof(*values), cmpDouble);
+  ASSERT_EQUAL(values[0], TDigest_Quantile(td, 0));
+  ASSERT_EQUAL(values[NUM_VALUES - 1], TDigest_Quantile(td, 1));
+  double quantiles[] = {0.01, 0.5, 0.99};
+  for (size_t ii = 0; ii < sizeof(quantiles) / sizeof(*quantiles); ++ii) {
+    ASSERT(isRankWithin(TDigest_Quantile(td, quantiles[ii]), quantiles[ii], 0.005));
+  }
+
+  // not a digest
+  ASSERT(TDigest_Deserialize("foo", 3) == NULL);
+  TDigest_Free(td);
+  return 0;
+}
+
+static int testGrowth() {
+  TDigest *td = TDigest_New(TDIGEST_DEFAULT_COMPRESSION);
+  // a digest holding a few values doesn't allocate all of its slots
+  for (size_t ii = 0; ii < 10; ++ii) {
+    TDigest_Add(td, ii, 1);
+  }
+  ASSERT(td->allocated < td->capacity);
+  ASSERT_EQUAL(0, td->numMerged);
+  ASSERT_EQUAL(4.5, TDigest_Quantile(td, 0.5));
+
+  // the slots grow up to the capacity, then the values are merged into the centroids
+  for (size_t ii = 10; ii < 10 * td->capacity; ++ii) {
+    TDigest_Add(td, ii, 1);
+    ASSERT(td->allocated <= td->capacity);
+  }
+  ASSERT_EQUAL(td->capacity, td->allocated);
+  ASSERT_EQUAL(10 * td->capacity, TDigest_Count(td));
+  TDigest_Free(td);
+  return 0;
+}
+
+TEST_MAIN({
+  RMUTil_InitAlloc();
+
+  srand(42);
+  for (size_t ii = 0; ii < NUM_VALUES; ++ii) {
+    // exponentially distributed
+    values[ii] = -log((rand() + 1.0) / ((double)RAND_MAX + 1)) * 100;
+  }
+
+  TESTFUNC(testQuantiles);
+  TESTFUNC(testMergeSerialized);
+  TESTFUNC(testGrowth);
+})
@@ -1,6 +1,8 @@
 from common import *
 
 import bz2
+import random
+import struct
 import json
 import unittest
 
@@ -114,7 +116,21 @@ class TestAggregate():
         res = self.env.cmd(*cmd)[1:]
         # print res
         row = to_dict(res[0])
-        self.env.assertEqual(1461, int(row['count_distinctish(title)']))
+        self.env.assertEqual(1561, int(row['count_distinctish(title)']))
+
+        # A higher precision is (here, exactly) more accurate
+        cmd = ['FT.AGGREGATE', 'games', '*',
+               'GROUPBY', '1', '@brand',
+               'REDUCE', 'COUNT_DISTINCTISH', '2', '@title', '14', 'AS', 'count_distinctish(title)',
+               'REDUCE', 'COUNT', '0'
+               ]
+        res = self.env.cmd(*cmd)[1:]
+        row = to_dict(res[0])
+        self.env.assertEqual(1484, int(row['count_distinctish(title)']))
+
+        for precision in ['3', '21', 'foo']:
+            self.env.expect('FT.AGGREGATE', 'games', '*', 'GROUPBY', '1', '@brand',
+                            'REDUCE', 'COUNT_DISTINCTISH', '2', '@title', precision).error()
 
     def testQuantile(self):
         cmd = ['FT.AGGREGATE', 'games', '*',
@@ -1055,6 +1071,193 @@ def testGroupAfterSort(env):
     env.assertEqual(res, expected)
 
 
+def testApplyFilterAfterGroup(env):
+    conn = getConnectionByEnv(env)
+    conn.execute_command('FT.CREATE', 'idx', 'SCHEMA', 'n', 'NUMERIC', 'SORTABLE')
+    for i in range(300):
+        conn.execute_command('HSET', f'doc{i}', 'n', i, 's', i)
+
+    # grouped rows are evaluated in batches. `n` is a number, while `s` is loaded as a string and
+    # is converted to a number by the expression
+    res = conn.execute_command('FT.AGGREGATE', 'idx', '*', 'LOAD', '1', '@s',
+                               'GROUPBY', '2', '@n', '@s', 'REDUCE', 'COUNT', '0', 'AS', 'c',
+                               'APPLY', '@n * 2 + @c', 'AS', 'x',
+                               'APPLY', '@s * 2 + @c', 'AS', 'y',
+                               'FILTER', '@x == @y && @x % 3 == 0',
+                               'SORTBY', '2', '@n', 'ASC', 'MAX', '300')
+    rows = [to_dict(row) for row in res[1:]]
+    env.assertEqual(len(rows), 100)
+    env.assertEqual([int(row['n']) for row in rows], list(range(1, 300, 3)))
+    env.assertEqual([row['x'] for row in rows], [str(2 * n + 1) for n in range(1, 300, 3)])
+    env.assertEqual([row['y'] for row in rows], [row['x'] for row in rows])
+
+
+@skip(cluster=True)
+def testHllSumLegacyRegisters(env):
+    conn = getConnectionByEnv(env)
+    bits = 12
+    # FNV spreads random strings well enough
+    rng = random.Random(0)
+    values = [f'{rng.getrandbits(64):016x}' for _ in range(6000)]
+
+    # registers of older versions, built from 32 bit FNV hashes
+    def legacy_hll(values):
+        registers = bytearray(1 << bits)
+        for value in values:
+            h = 0x5f61767a
+            for c in value.encode():
+                h = ((h ^ c) * 0x01000193) & 0xffffffff
+            rank = 1
+            while rank <= 32 - bits and not (h >> (rank - 1)) & 1:
+                rank += 1
+            index = h >> (32 - bits)
+            registers[index] = max(registers[index], rank)
+        return struct.pack('<IB', 0, bits) + bytes(registers)
+
+    conn.execute_command('FT.CREATE', 'vals', 'PREFIX', '1', 'v:', 'SCHEMA', 'x', 'TAG')
+    for i in range(3000, 6000):
+        conn.execute_command('HSET', f'v:{i}', 'x', values[i])
+    res = env.cmd('FT.AGGREGATE', 'vals', '*', 'LOAD', '1', '@x',
+                  'GROUPBY', '0', 'REDUCE', 'HLL', '2', '@x', bits, 'AS', 'h', **{NEVER_DECODE: []})
+    current = res[1][1]
+
+    conn.execute_command('FT.CREATE', 'hlls', 'PREFIX', '1', 'h:', 'SCHEMA', 'n', 'NUMERIC')
+    conn.execute_command('HSET', 'h:1', 'n', 1, 'h', legacy_hll(values[0:2000]))
+    conn.execute_command('HSET', 'h:2', 'n', 1, 'h', legacy_hll(values[1000:3000]))
+
+    def hll_sum():
+        res = env.cmd('FT.AGGREGATE', 'hlls', '*', 'LOAD', '1', '@h',
+                      'GROUPBY', '0', 'REDUCE', 'HLL_SUM', '1', '@h', 'AS', 'count')
+        return int(to_dict(res[1])['count'])
+
+    # legacy registers are merged with each other
+    env.assertAlmostEqual(hll_sum(), 3000, delta=3000 * 0.15)
+
+    # and counted apart from the registers of 64 bit hashes
+    conn.execute_command('HSET', 'h:3', 'n', 1, 'h', current)
+    env.assertAlmostEqual(hll_sum(), 6000, delta=6000 * 0.15)
+
+
+def testGroupByManyGroups(env):
+    conn = getConnectionByEnv(env)
+    conn.execute_command('FT.CREATE', 'idx', 'SCHEMA', 'n', 'NUMERIC', 't', 'TAG')
+    for i in range(3000):
+        conn.execute_command('HSET', f'doc{i}', 'n', i % 1000, 't', f'tag{i % 7}')
+
+    # enough groups to grow the groups table several times
+    res = conn.execute_command('FT.AGGREGATE', 'idx', '*', 'LOAD', '1', '@n',
+                               'GROUPBY', '1', '@n',
+                               'REDUCE', 'COUNT', '0', 'AS', 'c',
+                               'REDUCE', 'SUM', '1', '@n', 'AS', 's',
+                               'REDUCE', 'MIN', '1', '@n', 'AS', 'mn',
+                               'REDUCE', 'STDDEV', '1', '@n', 'AS', 'dev',
+                               'SORTBY', '2', '@n', 'ASC', 'MAX', '1000')
+    rows = [to_dict(row) for row in res[1:]]
+    env.assertEqual(len(rows), 1000)
+    env.assertEqual([int(row['n']) for row in rows], list(range(1000)))
+    env.assertTrue(all(row['c'] == '3' for row in rows))
+    env.assertEqual([int(row['s']) for row in rows], [3 * n for n in range(1000)])
+    env.assertEqual([int(row['mn']) for row in rows], list(range(1000)))
+    env.assertTrue(all(float(row['dev']) == 0 for row in rows))
+
+    # multiple keys, with a key of strings
+    res = conn.execute_command('FT.AGGREGATE', 'idx', '*', 'LOAD', '2', '@n', '@t',
+                               'GROUPBY', '2', '@n', '@t', 'REDUCE', 'COUNT', '0', 'AS', 'c',
+                               'GROUPBY', '0', 'REDUCE', 'COUNT', '0', 'AS', 'groups',
+                               'REDUCE', 'SUM', '1', '@c', 'AS', 'total')
+    env.assertEqual(to_dict(res[1]), {'groups': '3000', 'total': '3000'})
+
+
+def testGroupByParallel():
+    env = Env(moduleArgs='GROUPBY_THREADS 4')
+    env.skipOnCluster()
+    conn = getConnectionByEnv(env)
+    conn.execute_command('FT.CREATE', 'idx', 'SCHEMA', 'n', 'NUMERIC', 't', 'TAG')
+    for i in range(10000):
+        conn.execute_command('HSET', f'doc{i}', 'n', i % 1000, 'g', i % 10, 't', f'tag{i % 13}')
+
+    def aggregate(*reducers):
+        res = env.cmd('FT.AGGREGATE', 'idx', '*', 'LOAD', '3', '@n', '@g', '@t',
+                      'GROUPBY', '1', '@g', *reducers, 'SORTBY', '2', '@g', 'ASC')
+        return [to_dict(row) for row in res[1:]]
+
+    res = aggregate('REDUCE', 'COUNT', '0', 'AS', 'count',
+                    'REDUCE', 'SUM', '1', '@n', 'AS', 'sum',
+                    'REDUCE', 'AVG', '1', '@n', 'AS', 'avg',
+                    'REDUCE', 'MIN', '1', '@n', 'AS', 'min',
+                    'REDUCE', 'MAX', '1', '@n', 'AS', 'max',
+                    'REDUCE', 'STDDEV', '1', '@n', 'AS', 'stddev',
+                    'REDUCE', 'COUNT_DISTINCT', '1', '@t', 'AS', 'distinct',
+                    'REDUCE', 'COUNT_DISTINCTISH', '1', '@n', 'AS', 'distinctish',
+                    'REDUCE', 'TOLIST', '1', '@t', 'AS', 'list')
+    env.assertEqual(len(res), 10)
+    for row in res:
+        # the rows are aggregated by 4 threads, the merged values are those of all the rows
+        values = [i % 1000 for i in range(int(row['g']), 10000, 10)]
+        env.assertEqual(int(row['count']), len(values))
+        env.assertEqual(float(row['sum']), sum(values))
+        env.assertAlmostEqual(float(row['avg']), np.mean(values), delta=1e-6)
+        env.assertEqual(float(row['min']), min(values))
+        env.assertEqual(float(row['max']), max(values))
+        env.assertAlmostEqual(float(row['stddev']), np.std(values, ddof=1), delta=1e-6)
+        env.assertEqual(int(row['distinct']), 13)
+        env.assertEqual(int(row['distinctish']), 100)
+        env.assertEqual(sorted(row['list']), sorted(f'tag{t}' for t in range(13)))
+
+    for row in aggregate('REDUCE', 'QUANTILE', '2', '@n', '0.5', 'AS', 'median'):
+        env.assertAlmostEqual(float(row['median']), 500, delta=20)
+
+    for row in aggregate('REDUCE', 'RANDOM_SAMPLE', '2', '@n', '20', 'AS', 'sample'):
+        g = int(row['g'])
+        env.assertEqual(len(row['sample']), 20)
+        env.assertTrue(all(int(n) % 10 == g for n in row['sample']))
+
+    # FIRST_VALUE can not be merged, so the rows are aggregated by a single thread
+    res = aggregate('REDUCE', 'FIRST_VALUE', '4', '@n', 'BY', '@n', 'DESC', 'AS', 'last')
+    env.assertEqual([row['last'] for row in res], [str(990 + g) for g in range(10)])
+
+    # the rows reference the literal of APPLY, which is shared by all of them
+    res = env.cmd('FT.AGGREGATE', 'idx', '*', 'LOAD', '1', '@t', 'APPLY', '"lit"', 'AS', 'lit',
+                  'GROUPBY', '2', '@lit', '@t', 'REDUCE', 'TOLIST', '1', '@lit', 'AS', 'list',
+                  'GROUPBY', '1', '@lit', 'REDUCE', 'COUNT', '0', 'AS', 'groups')
+    env.assertEqual(to_dict(res[1]), {'lit': 'lit', 'groups': '13'})
+
+    env.expect('FT.CONFIG', 'SET', 'GROUPBY_THREADS', 0).error().contains('Not modifiable at runtime')
+
+
+def testQuantileTDigest(env):
+    conn = getConnectionByEnv(env)
+    conn.execute_command('FT.CREATE', 'idx', 'SCHEMA', 'n', 'NUMERIC', 'g', 'TAG')
+    for i in range(10000):
+        conn.execute_command('HSET', f'doc{i}', 'n', i, 'g', i % 2)
+
+    res = env.cmd('FT.AGGREGATE', 'idx', '*', 'LOAD', '2', '@n', '@g', 'GROUPBY', '1', '@g',
+                  'REDUCE', 'QUANTILE_TDIGEST', '2', '@n', '0', 'AS', 'min',
+                  'REDUCE', 'QUANTILE_TDIGEST', '2', '@n', '0.5', 'AS', 'p50',
+                  'REDUCE', 'QUANTILE_TDIGEST', '3', '@n', '0.99', '200', 'AS', 'p99',
+                  'REDUCE', 'QUANTILE_TDIGEST', '2', '@n', '1', 'AS', 'max',
+                  'SORTBY', '2', '@g', 'ASC')
+    rows = [to_dict(row) for row in res[1:]]
+    env.assertEqual(len(rows), 2)
+    for g, row in enumerate(rows):
+        # the extremes are exact, shards send their min and max values with their digests
+        env.assertEqual(float(row['min']), g)
+        env.assertEqual(float(row['max']), 9998 + g)
+        env.assertAlmostEqual(float(row['p50']), 5000, delta=50)
+        env.assertAlmostEqual(float(row['p99']), 9900, delta=20)
+
+    env.expect('FT.AGGREGATE', 'idx', '*', 'GROUPBY', '0',
+               'REDUCE', 'QUANTILE_TDIGEST', '2', '@n', '1.5').error().contains('Percentage must be between 0.0 and 1.0')
+    env.expect('FT.AGGREGATE', 'idx', '*', 'GROUPBY', '0',
+               'REDUCE', 'QUANTILE_TDIGEST', '3', '@n', '0.5', '5').error().contains('Invalid compression')
+
+    # digests can be merged by TDIGEST_QUANTILE
+    res = env.cmd('FT.AGGREGATE', 'idx', '*', 'LOAD', '2', '@n', '@g',
+                  'GROUPBY', '1', '@g', 'REDUCE', 'TDIGEST', '1', '@n', 'AS', 'digest',
+                  'GROUPBY', '0', 'REDUCE', 'TDIGEST_QUANTILE', '2', '@digest', '0.5', 'AS', 'p50')
+    env.assertAlmostEqual(float(to_dict(res[1])['p50']), 5000, delta=50)
+
+
 def testWithKNN(env):
     conn = getConnectionByEnv(env)
     dim = 4
@@ -43,6 +43,7 @@ def testGetConfigOptions(env):
     assert env.expect('ft.config', 'get', 'FORK_GC_RUN_INTERVAL').res[0][0] == 'FORK_GC_RUN_INTERVAL'
     assert env.expect('ft.config', 'get', 'FORK_GC_CLEAN_THRESHOLD').res[0][0] == 'FORK_GC_CLEAN_THRESHOLD'
     assert env.expect('ft.config', 'get', 'FORK_GC_RETRY_INTERVAL').res[0][0] == 'FORK_GC_RETRY_INTERVAL'
+    assert env.expect('ft.config', 'get', 'FORK_GC_SHM_SIZE').res[0][0] == 'FORK_GC_SHM_SIZE'
     assert env.expect('ft.config', 'get', '_MAX_RESULTS_TO_UNSORTED_MODE').res[0][0] == '_MAX_RESULTS_TO_UNSORTED_MODE'
     assert env.expect('ft.config', 'get', 'PARTIAL_INDEXED_DOCS').res[0][0] == 'PARTIAL_INDEXED_DOCS'
     assert env.expect('ft.config', 'get', 'UNION_ITERATOR_HEAP').res[0][0] == 'UNION_ITERATOR_HEAP'
@@ -53,6 +54,10 @@ def testGetConfigOptions(env):
     assert env.expect('ft.config', 'get', '_FORK_GC_CLEAN_NUMERIC_EMPTY_NODES').res[0][0] == '_FORK_GC_CLEAN_NUMERIC_EMPTY_NODES'
     assert env.expect('ft.config', 'get', '_FREE_RESOURCE_ON_THREAD').res[0][0] == '_FREE_RESOURCE_ON_THREAD'
     assert env.expect('ft.config', 'get', 'BG_INDEX_SLEEP_GAP').res[0][0] == 'BG_INDEX_SLEEP_GAP'
+    assert env.expect('ft.config', 'get', 'MAX_RESIDENT_INDEXES').res[0][0] == 'MAX_RESIDENT_INDEXES'
+    assert env.expect('ft.config', 'get', 'QUERY_CACHE_SIZE').res[0][0] == 'QUERY_CACHE_SIZE'
+    assert env.expect('ft.config', 'get', 'GROUPBY_THREADS').res[0][0] == 'GROUPBY_THREADS'
+    assert env.expect('ft.config', 'get', 'SORT_SPILL_THRESHOLD').res[0][0] == 'SORT_SPILL_THRESHOLD'
 
 '''
 
@@ -123,6 +128,7 @@ def testAllConfig(env):
     env.assertEqual(res_dict['FORK_GC_RUN_INTERVAL'][0], '30')
     env.assertEqual(res_dict['FORK_GC_CLEAN_THRESHOLD'][0], '100')
     env.assertEqual(res_dict['FORK_GC_RETRY_INTERVAL'][0], '5')
+    env.assertEqual(res_dict['FORK_GC_SHM_SIZE'][0], '16777216')
     env.assertEqual(res_dict['CURSOR_MAX_IDLE'][0], '300000')
     env.assertEqual(res_dict['NO_MEM_POOLS'][0], 'false')
     env.assertEqual(res_dict['PARTIAL_INDEXED_DOCS'][0], 'false')
@@ -132,6 +138,10 @@ def testAllConfig(env):
     env.assertEqual(res_dict['_FORK_GC_CLEAN_NUMERIC_EMPTY_NODES'][0], 'true')
     env.assertEqual(res_dict['_FREE_RESOURCE_ON_THREAD'][0], 'true')
     env.assertEqual(res_dict['BG_INDEX_SLEEP_GAP'][0], '100')
+    env.assertEqual(res_dict['MAX_RESIDENT_INDEXES'][0], '0')
+    env.assertEqual(res_dict['QUERY_CACHE_SIZE'][0], '0')
+    env.assertEqual(res_dict['GROUPBY_THREADS'][0], '0')
+    env.assertEqual(res_dict['SORT_SPILL_THRESHOLD'][0], '0')
 
 # skip ctest configured tests
     #env.assertEqual(res_dict['GC_POLICY'][0], 'fork')
@@ -167,10 +177,15 @@ def testInitConfig(env):
     test_arg_num('FORK_GC_RUN_INTERVAL', 3)
     test_arg_num('FORK_GC_CLEAN_THRESHOLD', 3)
     test_arg_num('FORK_GC_RETRY_INTERVAL', 3)
+    test_arg_num('FORK_GC_SHM_SIZE', 0)
     test_arg_num('_MAX_RESULTS_TO_UNSORTED_MODE', 3)
     test_arg_num('UNION_ITERATOR_HEAP', 20)
     test_arg_num('_NUMERIC_RANGES_PARENTS', 1)
     test_arg_num('BG_INDEX_SLEEP_GAP', 15)
+    test_arg_num('MAX_RESIDENT_INDEXES', 4)
+    test_arg_num('QUERY_CACHE_SIZE', 16)
+    test_arg_num('GROUPBY_THREADS', 4)
+    test_arg_num('SORT_SPILL_THRESHOLD', 100000)
 
 # True/False arguments
     def test_arg_true_false(arg_name, res):
@@ -233,5 +248,6 @@ def testImmutable(env):
     env.expect('ft.config', 'set', 'NO_MEM_POOLS').error().contains('Not modifiable at runtime')
     env.expect('ft.config', 'set', 'PARTIAL_INDEXED_DOCS').error().contains('Not modifiable at runtime')
     env.expect('ft.config', 'set', 'UPGRADE_INDEX').error().contains('Not modifiable at runtime')
+    env.expect('ft.config', 'set', 'GROUPBY_THREADS', 4).error().contains('Not modifiable at runtime')
     env.expect('ft.config', 'set', 'RAW_DOCID_ENCODING').error().contains('Not modifiable at runtime')
     env.expect('ft.config', 'set', 'BG_INDEX_SLEEP_GAP').error().contains('Not modifiable at runtime')
@@ -681,6 +681,40 @@ def testIssue1571WithRename(env):
     env.assertEqual(toSortedFlatList(env.cmd('ft.search', 'idx1', 'foo*')), toSortedFlatList([1, 'idx1:{doc}1', ['t', 'foo1', 'index', 'yes']]))
     env.expect('ft.search', 'idx2', 'foo*').equal([0])
 
+def testFilterGroups(env):
+    conn = getConnectionByEnv(env)
+    # indexes with the same filter on the same fields, on overlapping prefixes
+    env.expect('ft.create', 'idx_a', 'PREFIX', 2, 'p:', 'p:x:', 'FILTER', '@n > 5', 'SCHEMA', 'n', 'NUMERIC').ok()
+    env.expect('ft.create', 'idx_b', 'PREFIX', 1, 'p:x:', 'FILTER', '@n > 5', 'SCHEMA', 'n', 'NUMERIC').ok()
+    # same fields with another filter
+    env.expect('ft.create', 'idx_c', 'PREFIX', 1, 'p:', 'FILTER', '@n < 5', 'SCHEMA', 'n', 'NUMERIC').ok()
+    # same filter on another field
+    env.expect('ft.create', 'idx_d', 'PREFIX', 1, 'p:', 'FILTER', '@n > 5', 'SCHEMA', 'm', 'AS', 'n', 'NUMERIC').ok()
+    env.expect('ft.create', 'idx_e', 'PREFIX', 1, 'p:', 'SCHEMA', 'n', 'NUMERIC').ok()
+
+    conn.execute_command('hset', 'p:x:1', 'n', 10, 'm', 1)
+    conn.execute_command('hset', 'p:x:2', 'n', 1, 'm', 10)
+    conn.execute_command('hset', 'p:3', 'n', 10, 'm', 10)
+
+    env.expect('ft.search', 'idx_a', '*', 'LIMIT', 0, 0).equal([2])
+    env.expect('ft.search', 'idx_b', '*', 'LIMIT', 0, 0).equal([1])
+    env.expect('ft.search', 'idx_c', '*', 'LIMIT', 0, 0).equal([1])
+    env.expect('ft.search', 'idx_d', '*', 'LIMIT', 0, 0).equal([2])
+    env.expect('ft.search', 'idx_e', '*', 'LIMIT', 0, 0).equal([3])
+
+    # the matching indexes are updated when the prefixes change
+    env.expect('ft.dropindex', 'idx_b').ok()
+    env.expect('ft.create', 'idx_f', 'PREFIX', 1, 'p:x:', 'FILTER', '@n < 5', 'SCHEMA', 'n', 'NUMERIC').ok()
+    waitForIndex(env, 'idx_f')
+    conn.execute_command('hset', 'p:x:4', 'n', 0, 'm', 0)
+    conn.execute_command('hset', 'p:x:1', 'n', 0)
+
+    env.expect('ft.search', 'idx_a', '*', 'LIMIT', 0, 0).equal([1])
+    env.expect('ft.search', 'idx_c', '*', 'LIMIT', 0, 0).equal([3])
+    env.expect('ft.search', 'idx_d', '*', 'LIMIT', 0, 0).equal([2])
+    env.expect('ft.search', 'idx_e', '*', 'LIMIT', 0, 0).equal([4])
+    env.expect('ft.search', 'idx_f', '*', 'LIMIT', 0, 0).equal([3])
+
 @no_msan
 def testIdxFieldJson(env):
     conn = getConnectionByEnv(env)
@@ -149,6 +149,30 @@ def testDeleteEntireBlock(env):
         env.assertEqual(res[0:2],[1, 'doc250'])
         env.assertEqual(set(res[2]), set(['test', 'checking', 'test2', 'checking250']))
 
+def testGCTransport(env):
+    if env.isCluster():
+        env.skip()
+    env.expect('ft.config', 'set', 'FORK_GC_CLEAN_THRESHOLD', 0).equal('OK')
+    env.expect('FT.CREATE', 'idx', 'ON', 'HASH',
+               'SCHEMA', 'title', 'TEXT', 'n', 'NUMERIC', 't', 'TAG').ok()
+    waitForIndex(env, 'idx')
+
+    # 0 sends the data over the pipe, a tiny ring forces the child to wrap around
+    # and wait for the parent to consume the data
+    for shm_size in [0, 256, 16 * 1024 * 1024]:
+        env.expect('ft.config', 'set', 'FORK_GC_SHM_SIZE', shm_size).ok()
+        for i in range(1000):
+            env.cmd('HSET', 'doc%d' % i, 'title', 'hello world%d' % (i % 10), 'n', i, 't', 'tag%d' % (i % 10))
+        for i in range(0, 1000, 2):
+            env.cmd('DEL', 'doc%d' % i)
+        forceInvokeGC(env, 'idx')
+
+        env.assertEqual(env.cmd('FT.SEARCH', 'idx', 'hello', 'LIMIT', 0, 0), [500])
+        env.assertEqual(env.cmd('FT.SEARCH', 'idx', '@n:[0 999]', 'LIMIT', 0, 0), [500])
+        env.assertEqual(env.cmd('FT.SEARCH', 'idx', '@t:{tag1}', 'LIMIT', 0, 0), [100])
+        env.assertEqual(env.cmd('FT.SEARCH', 'idx', '@t:{tag2}', 'LIMIT', 0, 0), [0])
+    env.expect('ft.config', 'set', 'FORK_GC_SHM_SIZE', 16 * 1024 * 1024).ok()
+
 def testGCIntegrationWithRedisFork(env):
     if env.env == 'existing-env':
         env.skip()
@@ -127,3 +127,21 @@ def testGeoDistanceFile(env):
               'APPLY', 'geodistance(@location,-0.15036,51.50566)', 'AS', 'distance',
               'GROUPBY', '1', '@distance',
               'SORTBY', 2, '@distance', 'ASC').equal(res)
+
+def testGeoRadiusCovering(env):
+  # compare the results of radii of various sizes with the ones of redis GEORADIUS, which uses the
+  # same geohash encoding and distance
+  conn = getConnectionByEnv(env)
+  env.expect('ft.create', 'idx', 'schema', 'location', 'geo').ok()
+
+  for i in range(40):
+    for j in range(40):
+      lon, lat = 2 + i * 0.0137, 48 + j * 0.0113
+      conn.execute_command('HSET', f'doc{i}_{j}', 'location', f'{lon},{lat}')
+      conn.execute_command('GEOADD', 'geo{key}', lon, lat, f'doc{i}_{j}')
+
+  for radius in [0.1, 0.8, 3, 7.5, 20, 45, 100]:
+    expected = conn.execute_command('GEORADIUS', 'geo{key}', 2.27, 48.21, radius, 'km')
+    res = env.cmd('ft.search', 'idx', f'@location:[2.27 48.21 {radius} km]', 'NOCONTENT', 'LIMIT', 0, 2000)
+    env.assertEqual(res[0], len(expected), message=f'radius {radius}')
+    env.assertEqual(sorted(res[1:]), sorted(expected), message=f'radius {radius}')
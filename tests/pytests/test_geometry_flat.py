@@ -294,3 +294,64 @@ def testFtInfo(env):
   else:
     # TODO: in cluster - be able to wait for cleaning of the index (would wait for freeing the geoshape index memory)
     env.assertLess(cur_usage, usage)
+
+@skip(cluster=True)
+def testRepackAfterScanAndGC(env):
+  conn = getConnectionByEnv(env)
+  # index existing documents with the background scan, which packs the tree once it is done
+  for i in range(50):
+    for j in range(50):
+      conn.execute_command('HSET', f'p{i}_{j}', 'geom', f'POINT({i} {j})')
+  env.expect('FT.CREATE', 'idx', 'SCHEMA', 'geom', 'GEOSHAPE', 'FLAT').ok()
+  waitForIndex(env, 'idx')
+  assert_index_num_docs(env, 'idx', 'geom', 2500)
+
+  query = 'POLYGON((9.5 9.5, 9.5 19.5, 19.5 19.5, 19.5 9.5, 9.5 9.5))'
+  res = env.cmd('FT.SEARCH', 'idx', '@geom:[within $poly]', 'PARAMS', 2, 'poly', query, 'NOCONTENT', 'LIMIT', 0, 0, 'DIALECT', 3)
+  env.assertEqual(res[0], 100)
+
+  # enough removals to have the GC pack the tree again
+  for i in range(0, 50, 2):
+    for j in range(50):
+      conn.execute_command('DEL', f'p{i}_{j}')
+  forceInvokeGC(env, 'idx')
+  assert_index_num_docs(env, 'idx', 'geom', 1250)
+  res = env.cmd('FT.SEARCH', 'idx', '@geom:[within $poly]', 'PARAMS', 2, 'poly', query, 'NOCONTENT', 'LIMIT', 0, 0, 'DIALECT', 3)
+  env.assertEqual(res[0], 50)
+
+def testWithinConcavePolygon(env):
+  conn = getConnectionByEnv(env)
+  env.expect('FT.CREATE', 'idx', 'SCHEMA', 'geom', 'GEOSHAPE', 'FLAT').ok()
+  # an L shaped polygon with a hole, so that parts of its bounding box are outside of it
+  query = 'POLYGON((0 0, 40 0, 40 20, 20 20, 20 40, 0 40, 0 0), (5 5, 5 10, 10 10, 10 5, 5 5))'
+  def inside(x, y):
+    in_l = 0 < x < 40 and 0 < y < 40 and not (x > 20 and y > 20)
+    return in_l and not (5 < x < 10 and 5 < y < 10)
+
+  expected = set()
+  for i in range(45):
+    for j in range(45):
+      x, y = i + 0.5, j + 0.5
+      conn.execute_command('HSET', f'p{i}_{j}', 'geom', f'POINT({x} {y})')
+      if inside(x, y):
+        expected.add(f'p{i}_{j}')
+      # squares crossing the edges of the query
+      if i % 3 == 0 and j % 3 == 0:
+        conn.execute_command('HSET', f's{i}_{j}', 'geom',
+                             f'POLYGON(({i} {j}, {i} {j + 2}, {i + 2} {j + 2}, {i + 2} {j}, {i} {j}))')
+        if all(inside(x, y) for x in (i + 0.1, i + 1.9) for y in (j + 0.1, j + 1.9)) and \
+           not (i < 10 and j < 10 and i + 2 > 5 and j + 2 > 5):
+          expected.add(f's{i}_{j}')
+
+  def search(poly):
+    res = env.cmd('FT.SEARCH', 'idx', '@geom:[within $poly]', 'PARAMS', 2, 'poly', poly,
+                  'NOCONTENT', 'LIMIT', 0, 10000, 'DIALECT', 3)
+    return res[0], set(res[1:])
+
+  # the query geometry is reused by repeated queries, also after the index changes
+  env.assertEqual(search(query), (len(expected), expected))
+  env.assertEqual(search('POLYGON((0 0, 0 1, 1 1, 1 0, 0 0))'), (1, {'p0_0'}))
+  env.assertEqual(search(query), (len(expected), expected))
+  conn.execute_command('DEL', 'p1_1')
+  expected.discard('p1_1')
+  env.assertEqual(search(query), (len(expected), expected))
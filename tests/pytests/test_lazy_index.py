@@ -0,0 +1,103 @@
+# -*- coding: utf-8 -*-
+
+from includes import *
+from common import *
+from RLTest import Env
+
+
+def createIndexes(env, conn, num_indexes, num_docs):
+    for i in range(num_indexes):
+        env.expect('FT.CREATE', f'idx{i}', 'ON', 'HASH', 'PREFIX', 1, f't{i}:',
+                   'SCHEMA', 'n', 'NUMERIC').ok()
+        for j in range(num_docs):
+            conn.execute_command('HSET', f't{i}:{j}', 'n', j)
+        waitForIndex(env, f'idx{i}')
+
+def countDocs(env, idx):
+    waitForIndex(env, idx)
+    return env.cmd('FT.SEARCH', idx, '@n:[-inf +inf]', 'LIMIT', 0, 0)[0]
+
+def testEvictAndRehydrate(env):
+    env.skipOnCluster()
+    conn = getConnectionByEnv(env)
+    env.expect('FT.CONFIG', 'SET', 'MAX_RESIDENT_INDEXES', 2).ok()
+
+    # creating the third index evicts idx0, the least recently used one
+    createIndexes(env, conn, 3, 10)
+
+    # writes to an evicted index are picked up when it is loaded again
+    conn.execute_command('HSET', 't0:10', 'n', 10)
+    conn.execute_command('DEL', 't0:0')
+    env.assertEqual(countDocs(env, 'idx0'), 10)
+    env.assertEqual(to_dict(env.cmd('FT.INFO', 'idx0'))['num_docs'], '10')
+
+    env.assertEqual(countDocs(env, 'idx1'), 10)
+    env.assertEqual(countDocs(env, 'idx2'), 10)
+
+    env.expect('FT.CONFIG', 'SET', 'MAX_RESIDENT_INDEXES', 0).ok()
+
+def testFirstQueryOnEvictedIndex(env):
+    env.skipOnCluster()
+    conn = getConnectionByEnv(env)
+    env.expect('FT.CONFIG', 'SET', 'MAX_RESIDENT_INDEXES', 1).ok()
+
+    # idx0 is evicted once idx1 is created
+    createIndexes(env, conn, 2, 10)
+    conn.execute_command('HSET', 't0:10', 'n', 10)
+
+    # the first query rebuilds the evicted index and sees all of its documents
+    res = env.cmd('FT.SEARCH', 'idx0', '@n:[-inf +inf]', 'SORTBY', 'n', 'LIMIT', 0, 20, 'NOCONTENT')
+    env.assertEqual(res, [11] + [f't0:{j}' for j in range(11)])
+
+    env.expect('FT.CONFIG', 'SET', 'MAX_RESIDENT_INDEXES', 0).ok()
+
+def testDropEvictedIndex(env):
+    env.skipOnCluster()
+    conn = getConnectionByEnv(env)
+    env.expect('FT.CONFIG', 'SET', 'MAX_RESIDENT_INDEXES', 1).ok()
+
+    # idx0 is evicted once idx1 is created
+    createIndexes(env, conn, 2, 10)
+
+    env.expect('FT.DROPINDEX', 'idx0', 'DD').ok()
+    # the keys of an evicted index are deleted in the background
+    with TimeLimit(10):
+        while conn.execute_command('KEYS', 't0:*'):
+            time.sleep(0.1)
+    env.assertEqual(len(conn.execute_command('KEYS', 't1:*')), 10)
+    env.assertEqual(countDocs(env, 'idx1'), 10)
+
+    env.expect('FT.CONFIG', 'SET', 'MAX_RESIDENT_INDEXES', 0).ok()
+
+def testLoadEvictedAfterReload(env):
+    env.skipOnCluster()
+    conn = getConnectionByEnv(env)
+    createIndexes(env, conn, 3, 10)
+    env.expect('FT.CONFIG', 'SET', 'MAX_RESIDENT_INDEXES', 2).ok()
+
+    for _ in env.reloadingIterator():
+        # indexes are loaded on first use after the RDB is loaded
+        for i in range(3):
+            env.assertEqual(countDocs(env, f'idx{i}'), 10)
+
+    env.expect('FT.CONFIG', 'SET', 'MAX_RESIDENT_INDEXES', 0).ok()
+
+def testSkipInitialScanAfterReload(env):
+    env.skipOnCluster()
+    conn = getConnectionByEnv(env)
+    env.expect('FT.CREATE', 'skip_idx', 'ON', 'HASH', 'PREFIX', 1, 'skip:', 'SKIPINITIALSCAN',
+               'SCHEMA', 'n', 'NUMERIC').ok()
+    for j in range(10):
+        conn.execute_command('HSET', f'skip:{j}', 'n', j)
+    createIndexes(env, conn, 2, 10)
+    env.expect('FT.CONFIG', 'SET', 'MAX_RESIDENT_INDEXES', 1).ok()
+
+    for n, _ in enumerate(env.reloadingIterator()):
+        # an index created with SKIPINITIALSCAN can't be rebuilt from the keyspace, so it is not
+        # left cold when loaded from the RDB
+        conn.execute_command('HSET', f'skip:{10 + n}', 'n', 10 + n)
+        env.assertEqual(countDocs(env, 'skip_idx'), 11 + n)
+        for i in range(2):
+            env.assertEqual(countDocs(env, f'idx{i}'), 10)
+
+    env.expect('FT.CONFIG', 'SET', 'MAX_RESIDENT_INDEXES', 0).ok()
@@ -56,6 +56,30 @@ def testSimpleBuffer():
 def testMultipleBlocksBuffer():
     CreateAndSearchSortBy(docs_count = 2500)
 
+# The safe loader loads the buffered results in chunks, fetching hash fields with Redis locked and
+# converting them after it is unlocked.
+def testLoadChunks():
+    env = initEnv()
+    env.cmd('FT.CREATE', 'idx', 'SCHEMA', 'n', 'NUMERIC', 'SORTABLE', 't', 'TEXT')
+    conn = getConnectionByEnv(env)
+
+    docs_count = 1000
+    for n in range(docs_count):
+        if n % 3:
+            conn.execute_command('HSET', f'doc{n}', 'n', n, 't', f'text{n}', 'x', n * 2)
+        else:
+            # no `x` field
+            conn.execute_command('HSET', f'doc{n}', 'n', n, 't', f'text{n}')
+
+    res = conn.execute_command('FT.AGGREGATE', 'idx', '*', 'LOAD', 4, '@__key', '@t', '@x', '@n',
+                               'SORTBY', 2, '@n', 'ASC', 'LIMIT', 0, docs_count)
+    env.assertEqual(len(res) - 1, docs_count)
+    for n, row in enumerate(res[1:]):
+        expected = {'__key': f'doc{n}', 't': f'text{n}', 'n': str(n)}
+        if n % 3:
+            expected['x'] = str(n * 2)
+        env.assertEqual(to_dict(row), expected)
+
 def test_invalid_MT_MODE_FULL_config():
     try:
         env = initEnv(moduleArgs='WORKER_THREADS 0 MT_MODE MT_MODE_FULL')
@@ -272,3 +296,30 @@ def test_async_updates_sanity():
         # After overwriting 1, there may be another one zombie.
         env.assertLessEqual(marked_deleted_vectors_new, marked_deleted_vectors + 1)
         marked_deleted_vectors = marked_deleted_vectors_new
+
+
+def test_background_scan_with_full_buffer():
+    buffer_limit = 100
+    env = initEnv(moduleArgs=f'WORKER_THREADS 2 TIERED_HNSW_BUFFER_LIMIT {buffer_limit}'
+                             ' MT_MODE MT_MODE_FULL DEFAULT_DIALECT 2')
+    conn = getConnectionByEnv(env)
+    n_shards = env.shardsCount
+    n_vectors = 5000 * n_shards if not SANITIZER and not CODE_COVERAGE else 500 * n_shards
+    dim = 16
+
+    # Load the vectors before creating the index, so that they are indexed by the background scan,
+    # which waits for the workers rather than overflowing the flat buffer.
+    query_vec = load_vectors_to_redis(env, n_vectors, n_vectors - 1, dim)
+    env.expect('FT.CREATE', 'idx', 'SCHEMA', 'vector', 'VECTOR', 'HNSW', '6', 'TYPE', 'FLOAT32',
+               'DIM', dim, 'DISTANCE_METRIC', 'L2').ok()
+    waitForIndex(env, 'idx')
+    assertInfoField(env, 'idx', 'num_docs', str(n_vectors))
+
+    debug_info = get_vecsim_debug_dict(env, 'idx', 'vector')
+    env.assertLessEqual(to_dict(debug_info['FRONTEND_INDEX'])['INDEX_SIZE'], buffer_limit)
+
+    res = conn.execute_command('FT.SEARCH', 'idx', '*=>[KNN $K @vector $vec_param]', 'SORTBY',
+                               '__vector_score', 'RETURN', 1, '__vector_score', 'LIMIT', 0, 1,
+                               'PARAMS', 4, 'K', 1, 'vec_param', query_vec.tobytes())
+    env.assertEqual(res[1], str(n_vectors - 1))
+    env.assertAlmostEqual(float(res[2][1]), 0, 1e-5)
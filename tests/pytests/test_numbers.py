@@ -197,3 +197,79 @@ def testCardinalityCrash(env):
 
     for i in range(count):
         conn.execute_command('HSET', 'doc{}'.format(i), 'n', format(i))
+
+def testRebalanceNumericTreeInGC(env):
+    # most of the documents are deleted but no leaf becomes empty.
+    # the GC should merge the sibling leaves that shrank instead of keeping the old splits
+    env.skipOnCluster()
+    conn = getConnectionByEnv(env)
+    docs = 1000
+
+    conn.execute_command('FT.CREATE', 'idx', 'SCHEMA', 'n', 'NUMERIC')
+    for i in range(docs):
+        conn.execute_command('HSET', 'doc{}'.format(i), 'n', format(i))
+
+    for i in range(docs):
+        if i % 50 != 0:
+            conn.execute_command('DEL', 'doc{}'.format(i))
+
+    num_summery_before = to_dict(env.cmd('FT.DEBUG', 'NUMIDX_SUMMARY', 'idx', 'n'))
+    forceInvokeGC(env, 'idx')
+    num_summery_after = to_dict(env.cmd('FT.DEBUG', 'NUMIDX_SUMMARY', 'idx', 'n'))
+    env.assertGreater(num_summery_before['numRanges'], num_summery_after['numRanges'])
+    env.assertGreater(num_summery_after['revisionId'], num_summery_before['revisionId'])
+
+    res = env.cmd('FT.SEARCH', 'idx', '@n:[-inf +inf]', 'NOCONTENT')
+    env.assertEqual(res[0], docs / 50)
+    res = env.cmd('FT.SEARCH', 'idx', '@n:[100 500]', 'NOCONTENT', 'LIMIT', 0, 0)
+    env.assertEqual(res[0], 9)
+
+    # the merged leaf keeps accepting (and splitting on) new values
+    for i in range(docs):
+        if i % 50 != 0:
+            conn.execute_command('HSET', 'doc{}'.format(i), 'n', format(i))
+    res = env.cmd('FT.SEARCH', 'idx', '@n:[-inf +inf]', 'NOCONTENT', 'LIMIT', 0, 0)
+    env.assertEqual(res[0], docs)
+    res = env.cmd('FT.SEARCH', 'idx', '@n:[100 499]', 'NOCONTENT', 'LIMIT', 0, 0)
+    env.assertEqual(res[0], 400)
+
+    # leaves emptied by the deletion are merged as well, and the tree stays searchable
+    for i in range(docs):
+        conn.execute_command('DEL', 'doc{}'.format(i))
+    num_summery_before = to_dict(env.cmd('FT.DEBUG', 'NUMIDX_SUMMARY', 'idx', 'n'))
+    forceInvokeGC(env, 'idx')
+    num_summery_after = to_dict(env.cmd('FT.DEBUG', 'NUMIDX_SUMMARY', 'idx', 'n'))
+    env.assertGreater(num_summery_before['numRanges'], num_summery_after['numRanges'])
+    res = env.cmd('FT.SEARCH', 'idx', '@n:[-inf +inf]', 'NOCONTENT', 'LIMIT', 0, 0)
+    env.assertEqual(res[0], 0)
+
+def testSplitLargeLeafInGC(env):
+    # the cardinality of a leaf is sampled every 10 entries. Every sampled entry has the same value,
+    # so the leaf grows past its maximal size without being split on insertion. The GC splits it
+    # at the median of the remaining values.
+    env.skipOnCluster()
+    conn = getConnectionByEnv(env)
+    docs = 15000
+
+    conn.execute_command('FT.CREATE', 'idx', 'SCHEMA', 'n', 'NUMERIC')
+    with conn.pipeline(transaction=False) as pl:
+        for i in range(1, docs + 1):
+            pl.execute_command('HSET', 'doc{}'.format(i), 'n', i % 7 + 1 if i % 10 else 0)
+        pl.execute()
+    # some documents are deleted, so the GC has something to collect
+    for i in range(1, docs + 1, 100):
+        conn.execute_command('DEL', 'doc{}'.format(i))
+    remaining = [(i % 7 + 1 if i % 10 else 0) for i in range(1, docs + 1) if i % 100 != 1]
+
+    num_summery_before = to_dict(env.cmd('FT.DEBUG', 'NUMIDX_SUMMARY', 'idx', 'n'))
+    env.assertEqual(num_summery_before['numRanges'], 1)
+    forceInvokeGC(env, 'idx')
+    num_summery_after = to_dict(env.cmd('FT.DEBUG', 'NUMIDX_SUMMARY', 'idx', 'n'))
+    env.assertGreater(num_summery_after['numRanges'], num_summery_before['numRanges'])
+    env.assertGreater(num_summery_after['revisionId'], num_summery_before['revisionId'])
+
+    res = env.cmd('FT.SEARCH', 'idx', '@n:[-inf +inf]', 'NOCONTENT', 'LIMIT', 0, 0)
+    env.assertEqual(res[0], len(remaining))
+    for lo, hi in [(0, 0), (0, 3), (4, 8), (2, 5)]:
+        res = env.cmd('FT.SEARCH', 'idx', '@n:[{} {}]'.format(lo, hi), 'NOCONTENT', 'LIMIT', 0, 0)
+        env.assertEqual(res[0], len([v for v in remaining if lo <= v <= hi]))
@@ -157,6 +157,48 @@ def testProfileAggregate(env):
   actual_res = env.cmd('ft.profile', 'idx', 'aggregate', 'query', '*', 'sortby', 2, '@t', 'asc', 'limit', 0, 10, 'LOAD', 2, '@__key', '@t')
   env.assertEqual(actual_res[1][4], expected_res)
 
+def testProfileAggregateLateLoad(env):
+  env.skipOnCluster()
+  conn = getConnectionByEnv(env)
+  env.cmd('FT.CONFIG', 'SET', '_PRINT_PROFILE_CLOCK', 'false')
+
+  env.cmd('ft.create', 'idx', 'SCHEMA', 't', 'text', 'n', 'numeric', 'sortable')
+  for i in range(10):
+    conn.execute_command('hset', i, 't', 'hello' if i % 2 else 'world', 'n', i, 'x', 'x%d' % i)
+
+  # The loaded fields are not needed to sort, so only the rows which pass the limit are loaded
+  expected_res = ['Result processors profile',
+                  ['Type', 'Index', 'Counter', 10],
+                  ['Type', 'Sorter', 'Counter', 2],
+                  ['Type', 'Loader', 'Counter', 2]]
+  actual_res = env.cmd('ft.profile', 'idx', 'aggregate', 'query', '*', 'LOAD', 2, '@t', '@x',
+                       'sortby', 2, '@n', 'desc', 'limit', 0, 2)
+  env.assertEqual(actual_res[1][4], expected_res)
+  env.assertEqual([to_dict(r) for r in actual_res[0][1:]],
+                  [{'n': '9', 't': 'hello', 'x': 'x9'}, {'n': '8', 't': 'world', 'x': 'x8'}])
+
+  # The filtered field is loaded for every row, and the rest after the limit
+  expected_res = ['Result processors profile',
+                  ['Type', 'Index', 'Counter', 10],
+                  ['Type', 'Loader', 'Counter', 10],
+                  ['Type', 'Filter - Function startswith', 'Counter', 5],
+                  ['Type', 'Sorter', 'Counter', 2],
+                  ['Type', 'Loader', 'Counter', 2]]
+  actual_res = env.cmd('ft.profile', 'idx', 'aggregate', 'query', '*', 'LOAD', 2, '@t', '@x',
+                       'filter', 'startswith(@t, "hel")', 'sortby', 2, '@n', 'desc', 'limit', 0, 2)
+  env.assertEqual(actual_res[1][4], expected_res)
+  env.assertEqual([to_dict(r) for r in actual_res[0][1:]],
+                  [{'n': '9', 't': 'hello', 'x': 'x9'}, {'n': '7', 't': 'hello', 'x': 'x7'}])
+
+  # LOAD * is deferred as well
+  expected_res = ['Result processors profile',
+                  ['Type', 'Index', 'Counter', 10],
+                  ['Type', 'Sorter', 'Counter', 1],
+                  ['Type', 'Loader', 'Counter', 1]]
+  actual_res = env.cmd('ft.profile', 'idx', 'aggregate', 'query', '*', 'LOAD', '*',
+                       'sortby', 2, '@n', 'asc', 'limit', 0, 1)
+  env.assertEqual(actual_res[1][4], expected_res)
+
 def testProfileCursor(env):
   conn = getConnectionByEnv(env)
   env.cmd('ft.create', 'idx', 'SCHEMA', 't', 'text')
@@ -244,13 +286,15 @@ def testProfileVector(env):
   env.assertEqual(to_dict(env.cmd("FT.DEBUG", "VECSIM_INFO", "idx", "v"))['LAST_SEARCH_MODE'], 'RANGE_QUERY')
 
 # Test with hybrid query variations
-  # Expect ad-hoc BF to take place - going over child iterator exactly once (reading 2 results)
+  # Expect ad-hoc BF to take place - going over child iterator twice (reading 2 results each time):
+  # once to compute the distances, and once more after a rewind, skipping to each of the top results
+  # to attach its child result
   actual_res = conn.execute_command('ft.profile', 'idx', 'search', 'query', '(@t:hello world)=>[KNN 3 @v $vec]',
                                     'SORTBY', '__v_score', 'PARAMS', '2', 'vec', 'aaaaaaaa', 'nocontent')
   expected_iterators_res = ['Iterators profile', ['Type', 'VECTOR', 'Counter', 2, 'Child iterator',
-                                                 ['Type', 'INTERSECT', 'Counter', 2, 'Child iterators',
-                                                 ['Type', 'TEXT', 'Term', 'world', 'Counter', 2, 'Size', 2],
-                                                 ['Type', 'TEXT', 'Term', 'hello', 'Counter', 2, 'Size', 5]]]]
+                                                 ['Type', 'INTERSECT', 'Counter', 4, 'Child iterators',
+                                                 ['Type', 'TEXT', 'Term', 'world', 'Counter', 4, 'Size', 2],
+                                                 ['Type', 'TEXT', 'Term', 'hello', 'Counter', 4, 'Size', 5]]]]
   expected_vecsim_rp_res = ['Type', 'Metrics Applier', 'Counter', 2]
   env.assertEqual(actual_res[0], [2, '4', '5'])
   env.assertEqual(actual_res[1][3], expected_iterators_res)
@@ -1170,6 +1170,8 @@ def test_ft_info():
           'average_cycle_time_ms': nan,
           'bytes_collected': 0.0,
           'gc_blocks_denied': 0.0,
+          'gc_blocks_merged': 0.0,
+          'gc_bytes_merged': 0.0,
           'gc_numeric_trees_missed': 0.0,
           'last_run_time_ms': 0.0,
           'total_cycles': 0.0,
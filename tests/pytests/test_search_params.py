@@ -582,3 +582,44 @@ def test_sortable_unf(env):
 
 def test_sortable_NOunf(env):
     unf(env, is_sortable_unf=False)
+
+def test_query_cache(env):
+    env = Env(moduleArgs = 'DEFAULT_DIALECT 2')
+    env.skipOnCluster()
+    conn = getConnectionByEnv(env)
+    env.expect('FT.CONFIG', 'SET', 'QUERY_CACHE_SIZE', 2).ok()
+
+    env.expect('FT.CREATE', 'idx', 'SCHEMA', 't', 'TEXT', 'n', 'NUMERIC', 'tag', 'TAG').ok()
+    for i in range(10):
+        conn.execute_command('HSET', f'doc{i}', 't', f'hello{i}', 'n', i, 'tag', f'tag{i % 2}')
+    waitForIndex(env, 'idx')
+
+    def cache_stats():
+        return to_dict(to_dict(env.cmd('FT.INFO', 'idx'))['query_cache_stats'])
+
+    # queries differing only by their parameters share the cached query
+    q = '@n:[$min $max] @tag:{$tag}'
+    res = env.cmd('FT.SEARCH', 'idx', q, 'NOCONTENT', 'SORTBY', 'n', 'PARAMS', 6, 'min', 2, 'max', 7, 'tag', 'tag0')
+    env.assertEqual(res, [3, 'doc2', 'doc4', 'doc6'])
+    res = env.cmd('FT.SEARCH', 'idx', q, 'NOCONTENT', 'SORTBY', 'n', 'PARAMS', 6, 'min', 0, 'max', 3, 'tag', 'tag1')
+    env.assertEqual(res, [2, 'doc1', 'doc3'])
+    env.assertEqual(cache_stats(), {'entries': 1, 'hits': 1, 'misses': 1})
+
+    env.expect('FT.SEARCH', 'idx', '@t:$w', 'NOCONTENT', 'PARAMS', 2, 'w', 'hello3').equal([1, 'doc3'])
+    # the least recently used query is evicted
+    env.expect('FT.SEARCH', 'idx', '@n:[8 +inf]', 'NOCONTENT', 'SORTBY', 'n').equal([2, 'doc8', 'doc9'])
+    res = env.cmd('FT.SEARCH', 'idx', q, 'NOCONTENT', 'SORTBY', 'n', 'PARAMS', 6, 'min', 5, 'max', 9, 'tag', 'tag1')
+    env.assertEqual(res, [3, 'doc5', 'doc7', 'doc9'])
+    env.assertEqual(cache_stats(), {'entries': 2, 'hits': 1, 'misses': 4})
+
+    # parameters of query attributes are inlined by the parser, such queries are not cached
+    env.expect('FT.SEARCH', 'idx', '(@t:hello1) => { $weight: $w; }', 'NOCONTENT', 'PARAMS', 2, 'w', 2).equal([1, 'doc1'])
+    env.assertEqual(cache_stats(), {'entries': 2, 'hits': 1, 'misses': 5})
+
+    # altering the schema clears the cache
+    env.expect('FT.ALTER', 'idx', 'SCHEMA', 'ADD', 't2', 'TEXT').ok()
+    env.assertEqual(cache_stats()['entries'], 0)
+    res = env.cmd('FT.SEARCH', 'idx', q, 'NOCONTENT', 'SORTBY', 'n', 'PARAMS', 6, 'min', 2, 'max', 7, 'tag', 'tag0')
+    env.assertEqual(res, [3, 'doc2', 'doc4', 'doc6'])
+
+    env.expect('FT.CONFIG', 'SET', 'QUERY_CACHE_SIZE', 0).ok()
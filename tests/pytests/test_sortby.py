@@ -171,3 +171,63 @@ def testSortby(env):
     compare_asc_desc(env, ['ft.search', 'idx', 'foo @n:[-inf inf]', 'SORTBY', 'n'], params)
     compare_asc_desc(env, ['ft.search', 'idx', '@n:[-inf inf]', 'SORTBY', 'n'], params)
 
+
+def testSortbyMultipleFields(env):
+    # Strings sharing a long prefix are ordered by their full value, and numbers by their sign
+    conn = getConnectionByEnv(env)
+    env.expect('FT.CREATE', 'idx', 'SCHEMA', 'n', 'NUMERIC', 'SORTABLE', 't', 'TAG', 'SORTABLE').ok()
+    docs = []
+    for i in range(1000):
+        n = (i * 7919) % 11 - 5 + (0.5 if i % 3 else 0)
+        t = 'a_long_common_prefix_%04d' % ((i * 104729) % 1000) if i % 4 else 'b%d' % (i % 10)
+        conn.execute_command('HSET', 'doc%d' % i, 'n', n, 't', t)
+        docs.append((n, t))
+
+    for n_order, t_order in [('DESC', 'ASC'), ('ASC', 'DESC'), ('ASC', 'ASC')]:
+        expected = sorted(docs, key=lambda d: d[1], reverse=(t_order == 'DESC'))
+        expected = sorted(expected, key=lambda d: d[0], reverse=(n_order == 'DESC'))
+        res = env.cmd('FT.AGGREGATE', 'idx', '*', 'SORTBY', 4, '@n', n_order, '@t', t_order,
+                      'MAX', 100)
+        res = [(float(to_dict(row)['n']), to_dict(row)['t']) for row in res[1:]]
+        env.assertEqual(len(res), 100)
+        env.assertEqual([(float(n), t) for n, t in expected[:100]], res)
+
+def testSortbySpill(env):
+    # Sorters returning more than SORT_SPILL_THRESHOLD results spill sorted runs to disk and merge
+    # them, returning the same results as sorting in memory
+    env.skipOnCluster()
+    conn = getConnectionByEnv(env)
+    env.expect('FT.CREATE', 'idx', 'SCHEMA', 'n', 'NUMERIC', 'SORTABLE', 't', 'TEXT').ok()
+    for i in range(2000):
+        conn.execute_command('HSET', 'doc%d' % i, 'n', (i * 7919) % 2000, 't', 'hello %d' % i,
+                             'arr', '[%d]' % i)
+
+    def aggregate():
+        return env.cmd('FT.AGGREGATE', 'idx', '*', 'LOAD', 2, '@t', '@arr',
+                       'APPLY', '@n * 2', 'AS', 'n2', 'SORTBY', 2, '@n', 'DESC', 'MAX', 1500)
+
+    def search():
+        return env.cmd('FT.SEARCH', 'idx', 'hello', 'SORTBY', 'n', 'ASC', 'LIMIT', 100, 1000)
+
+    def cursor():
+        res, cid = env.cmd('FT.AGGREGATE', 'idx', '*', 'LOAD', 1, '@t',
+                           'SORTBY', 2, '@n', 'ASC', 'MAX', 2000, 'WITHCURSOR', 'COUNT', 300)
+        rows = res[1:]
+        while cid:
+            res, cid = env.cmd('FT.CURSOR', 'READ', 'idx', cid)
+            rows += res[1:]
+        return rows
+
+    expected = [aggregate(), search(), cursor()]
+    env.assertEqual(len(expected[0]), 1501)
+    env.assertEqual(len(expected[2]), 2000)
+
+    env.expect('FT.CONFIG', 'SET', 'SORT_SPILL_THRESHOLD', 128).ok()
+    env.assertEqual(aggregate(), expected[0])
+    env.assertEqual(search(), expected[1])
+    env.assertEqual(cursor(), expected[2])
+
+    # Queries returning fewer results than the threshold are sorted in memory
+    env.assertEqual(env.cmd('FT.SEARCH', 'idx', '*', 'SORTBY', 'n', 'LIMIT', 0, 10, 'NOCONTENT'),
+                    [2000] + ['doc%d' % i for i in sorted(range(2000), key=lambda i: (i * 7919) % 2000)[:10]])
+    env.expect('FT.CONFIG', 'SET', 'SORT_SPILL_THRESHOLD', 0).ok()
@@ -407,6 +407,7 @@ def test_create_errors():
     env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'FLAT', '6').error().contains('Expected 6 parameters but got 0')
     env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'FLAT', '1').error().contains('Bad number of arguments for vector similarity index: got 1 but expected even number')
     env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'FLAT', '2', 'SIZE').error().contains('Bad arguments for algorithm FLAT: SIZE')
+    env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'FLAT', '8', 'TYPE', 'FLOAT32', 'DIM', '1024', 'DISTANCE_METRIC', 'IP', 'QUANTIZATION', 'SQ8').error().contains('Bad arguments for algorithm FLAT: QUANTIZATION is not supported by the vector similarity library')
     env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'FLAT', '2', 'TYPE').error().contains('Bad arguments for vector similarity FLAT index type')
     env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'FLAT', '4', 'TYPE', 'FLOAT32', 'DIM').error().contains('Bad arguments for vector similarity FLAT index dim')
     env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'FLAT', '4', 'DIM', '1024', 'DISTANCE_METRIC', 'IP').error().contains('Missing mandatory parameter: cannot create FLAT index without specifying TYPE argument')
@@ -417,6 +418,7 @@ def test_create_errors():
     env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'HNSW', '6').error().contains('Expected 6 parameters but got 0')
     env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'HNSW', '1').error().contains('Bad number of arguments for vector similarity index: got 1 but expected even number')
     env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'HNSW', '2', 'SIZE').error().contains('Bad arguments for algorithm HNSW: SIZE')
+    env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'HNSW', '8', 'TYPE', 'FLOAT32', 'DIM', '1024', 'DISTANCE_METRIC', 'IP', 'QUANTIZATION', 'SQ8').error().contains('Bad arguments for algorithm HNSW: QUANTIZATION is not supported by the vector similarity library')
     env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'HNSW', '2', 'TYPE').error().contains('Bad arguments for vector similarity HNSW index type')
     env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'HNSW', '4', 'TYPE', 'FLOAT32', 'DIM').error().contains('Bad arguments for vector similarity HNSW index dim')
     env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'HNSW', '4', 'DIM', '1024', 'DISTANCE_METRIC', 'IP').error().contains('Missing mandatory parameter: cannot create HNSW index without specifying TYPE argument')
@@ -1093,6 +1095,93 @@ def test_hybrid_query_adhoc_bf_mode():
         conn.execute_command('FT.DROPINDEX', 'idx', 'DD')
 
 
+def test_hybrid_query_filtered_mode():
+    env = Env(moduleArgs='DEFAULT_DIALECT 2')
+    conn = getConnectionByEnv(env)
+    dimension = 128
+    qty = 100
+
+    for data_type in VECSIM_DATA_TYPES:
+        env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'HNSW', '8', 'TYPE', data_type,
+                   'DIM', dimension, 'DISTANCE_METRIC', 'L2', 'EF_RUNTIME', 100, 't', 'TEXT').ok()
+        load_vectors_with_texts_into_redis(conn, 'v', dimension, qty, data_type)
+
+        # Change the text value to 'other' for 10 vectors (with id 10, 20, ..., 100)
+        for i in range(1, 11):
+            vector = create_np_array_typed([10*i]*dimension, data_type)
+            conn.execute_command('HSET', 10*i, 'v', vector.tobytes(), 't', 'other')
+
+        query_data = create_np_array_typed([100]*dimension, data_type)
+        expected_res = [5,
+                        '100', ['__v_score', '0', 't', 'other'],
+                        '90', ['__v_score', '12800', 't', 'other'],
+                        '80', ['__v_score', '51200', 't', 'other'],
+                        '70', ['__v_score', '115200', 't', 'other'],
+                        '60', ['__v_score', '204800', 't', 'other']]
+
+        for _ in env.retry_with_rdb_reload():
+            waitForIndex(env, 'idx')
+            # The results are the same as with the other policies, with and without the document scores
+            for policy in ['FILTERED', 'ADHOC_BF', 'BATCHES']:
+                env.expect('FT.SEARCH', 'idx', f'(other)=>[KNN 5 @v $vec_param HYBRID_POLICY {policy}]',
+                           'SORTBY', '__v_score', 'PARAMS', 2, 'vec_param', query_data.tobytes(),
+                           'RETURN', 2, '__v_score', 't').equal(expected_res)
+            env.expect('FT.SEARCH', 'idx', '(other)=>[KNN 5 @v $vec_param HYBRID_POLICY FILTERED BATCH_SIZE 3]',
+                       'SORTBY', '__v_score', 'PARAMS', 2, 'vec_param', query_data.tobytes(),
+                       'RETURN', 2, '__v_score', 't').equal(expected_res)
+            res = conn.execute_command('FT.SEARCH', 'idx', '(other)=>[KNN 5 @v $vec_param HYBRID_POLICY FILTERED]',
+                                       'WITHSCORES', 'PARAMS', 2, 'vec_param', query_data.tobytes(), 'RETURN', 1, 't')
+            env.assertEqual(res[0], 5)
+            env.assertEqual(sorted(res[1::3]), sorted(expected_res[1::2]))
+
+        # The policy is for hybrid queries only, and can't be given with another one
+        env.expect('FT.SEARCH', 'idx', '*=>[KNN 5 @v $vec_param HYBRID_POLICY FILTERED]',
+                   'PARAMS', 2, 'vec_param', query_data.tobytes()).error().contains(
+                   'hybrid query attributes were sent for a non-hybrid query')
+        env.expect('FT.SEARCH', 'idx', '(other)=>[KNN 5 @v $vec_param HYBRID_POLICY FILTERED HYBRID_POLICY BATCHES]',
+                   'PARAMS', 2, 'vec_param', query_data.tobytes()).error().contains('Parameter was specified twice')
+        conn.execute_command('FT.DROPINDEX', 'idx', 'DD')
+
+
+@skip(cluster=True)
+def test_msearch():
+    env = Env(moduleArgs='DEFAULT_DIALECT 2')
+    conn = getConnectionByEnv(env)
+    dimension = 4
+    qty = 100
+
+    env.expect('FT.CREATE', 'idx', 'SCHEMA', 'v', 'VECTOR', 'FLAT', '6', 'TYPE', 'FLOAT32',
+               'DIM', dimension, 'DISTANCE_METRIC', 'L2', 't', 'TEXT').ok()
+    load_vectors_with_texts_into_redis(conn, 'v', dimension, qty)
+
+    queries = [create_np_array_typed([i] * dimension).tobytes() for i in [10, 50, 90]]
+    query = '(text)=>[KNN 3 @v $vec]'
+    args = ['SORTBY', '__v_score', 'RETURN', 1, '__v_score', 'LIMIT', 0, 3]
+
+    # Each reply is the reply of FT.SEARCH with the same vector
+    expected = [conn.execute_command('FT.SEARCH', 'idx', query, 'PARAMS', 2, 'vec', q, *args) for q in queries]
+    env.expect('FT.MSEARCH', 'idx', query, 'VECTORS', 'vec', len(queries), *queries, *args).equal(expected)
+
+    # Other parameters are given as usual
+    expected = [conn.execute_command('FT.SEARCH', 'idx', '(@t:$t)=>[KNN 3 @v $vec]', 'PARAMS', 4, 'vec', q, 't', 'text', *args)
+                for q in queries]
+    env.expect('FT.MSEARCH', 'idx', '(@t:$t)=>[KNN 3 @v $vec]', 'VECTORS', 'vec', len(queries), *queries,
+               'PARAMS', 2, 't', 'text', *args).equal(expected)
+
+    # An error of a single vector is its reply
+    res = conn.execute_command('FT.MSEARCH', 'idx', query, 'VECTORS', 'vec', 2, queries[0], b'short', *args)
+    env.assertEqual(res[0], expected[0])
+    env.assertContains('query vector blob size', str(res[1]))
+
+    # A query which fails to parse fails as a whole
+    env.expect('FT.MSEARCH', 'idx', '(text', 'VECTORS', 'vec', 1, queries[0]).error().contains('Syntax error')
+    env.expect('FT.MSEARCH', 'idx', query, 'VECTORS', 'vec', 1, queries[0], 'PARAMS', 2, 'vec', queries[1]).error().contains('Duplicate parameter `vec`')
+    env.expect('FT.MSEARCH', 'idx', query, 'VECTORS', 'vec', 1, queries[0], 'WITHCURSOR').error().contains('FT.MSEARCH does not support cursor')
+    env.expect('FT.MSEARCH', 'idx', query, 'VECTOR', 'vec', 1, queries[0]).error().contains('VECTORS is expected after the query')
+    env.expect('FT.MSEARCH', 'idx', query, 'VECTORS', 'vec', 0, 'LIMIT', 0).error().contains('VECTORS requires at least one vector')
+    env.expect('FT.MSEARCH', 'no_idx', query, 'VECTORS', 'vec', 1, queries[0]).error().contains('no_idx: no such index')
+
+
 def test_wrong_vector_size():
     env = Env(moduleArgs='DEFAULT_DIALECT 2')
     conn = getConnectionByEnv(env)